@@ -16,5 +16,466 @@
   #define gnd_lssmap_maker_API
 #endif
 
+#include <stdio.h>
+#include <errno.h>
+#include <float.h>
+#include <sys/stat.h>
+
+#include "gnd/gnd-multi-math.h"
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+#include "gnd/gnd-matrix-base.hpp"
+#include "gnd/gnd-vector-base.hpp"
+#include "gnd/gnd-matrix-coordinate.hpp"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_transform.hpp"
+#include "gnd/gnd_lssmap_maker_cmap_binary.hpp"
+#include "gnd/gnd_lssmap_maker_tiled_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_point_log.hpp"
+#include "gnd/gnd_lssmap_maker_stats.hpp"
+#include "gnd/gnd_lssmap_maker_tile_build.hpp"
+#include "gnd/gnd_lssmap_maker_image_export.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct pose2d;
+		typedef struct pose2d pose2d_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief stamped robot pose on global coordinate
+		 */
+		struct pose2d {
+			uint32_t seq;		///< sequence id
+			double stamp;		///< time stamp (sec)
+			double x;			///< x (m)
+			double y;			///< y (m)
+			double theta;		///< orientation (rad)
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief initialize previous collected pose
+		 * @details set the pose far enough away that the first associated scan always meets the collect condition
+		 * @param [out] p     : previous collected pose
+		 * @param [in]  conf  : node configuration
+		 * @param [in]  stamp : time of start
+		 */
+		inline
+		int init_prevcollect_pose( pose2d_t *p, const node_config *conf, double stamp ) {
+			gnd_assert(!p, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			p->seq = 0;
+			p->stamp = stamp - conf->collect_condition_time.value;
+			p->x = ::sqrt(DBL_MAX) / 2;
+			p->y = ::sqrt(DBL_MAX) / 2;
+			p->theta = 0;
+			return 0;
+		}
+
+		/**
+		 * @brief check data collect condition
+		 * @param [in] conf         : node configuration
+		 * @param [in] pose         : pose associated with the point-cloud
+		 * @param [in] prev         : pose at previous collection
+		 * @return true if the point-cloud should be collected
+		 * @note the pose is interpolated at the time stamp of the point-cloud (see interpolate_pose()),
+		 *       so the time difference between them is not checked
+		 */
+		inline
+		bool is_collect_condition( const node_config *conf, const pose2d_t *pose, const pose2d_t *prev ) {
+			bool flg_collect = false;
+			double time = pose->stamp - prev->stamp;
+			double sqdist = (pose->x - prev->x) * (pose->x - prev->x)
+					+ (pose->y - prev->y) * (pose->y - prev->y);
+			double angle = ::fabs( gnd_rad_normalize( pose->theta - prev->theta ) );
+
+			flg_collect = flg_collect
+					|| (  conf->collect_condition_time.value > 0
+							&& time >= conf->collect_condition_time.value);
+			flg_collect = flg_collect
+					|| (  conf->collect_condition_moving_distance.value > 0
+							&& sqdist > conf->collect_condition_moving_distance.value * conf->collect_condition_moving_distance.value);
+			flg_collect = flg_collect
+					|| (  conf->collect_condition_moving_angle.value > 0
+							&& angle > conf->collect_condition_moving_angle.value);
+			return flg_collect;
+		}
+
+
+		/**
+		 * @brief coordinate transform and counting of a point-cloud
+		 * @details range gate and transform run in a batch over the whole scan (simd),
+		 *          then culling, grid decimation and counting run in order on the accepted points.
+		 *          the grid decimation counts the first point in each global grid cell of the scan,
+		 *          so neighbours that are not adjacent in the array (multi-echo, multi-layer) are also removed
+		 * @param [out] cmap   : counting map (plain or tiled)
+		 * @param [in]  conf   : node configuration
+		 * @param [in]  pose   : pose associated with the point-cloud
+		 * @param [in]  points : points on robot coordinate (require member x, y)
+		 * @param [in]  n      : number of points
+		 * @param [in]  log    : point logger (null: no log)
+		 * @param [in]  ws     : workspace reused between scans (null: allocate temporary),
+		 *                       the stage latencies of the scan are left in it
+		 * @return number of counted points
+		 */
+		template< typename map_t, typename point_t >
+		inline
+		int counting_points( map_t *cmap, const node_config *conf, const pose2d_t *pose, const point_t *points, size_t n,
+				point_logger *log = 0, scan_workspace_t *ws = 0 ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!pose, -1, "invalid null pointer argument\n" );
+			gnd_assert(n > 0 && !points, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				scan_workspace_t ws_tmp;
+				size_t i;
+				int cnt = 0;
+				double x_src_prev, y_src_prev;
+				double time_stage[4];
+				const double sq_culling = conf->collect_condition_culling_distance.value * conf->collect_condition_culling_distance.value;
+				const double grid_size = conf->collect_condition_grid_size.value;
+
+				if( !ws ) ws = &ws_tmp;
+				ws->latency_transform = 0;
+				ws->latency_counting = 0;
+				ws->latency_log = 0;
+				if( n == 0 ) return 0;
+
+				{ // ---> initialize previous counted point
+					x_src_prev = 10000;
+					y_src_prev = 10000;
+				} // ---> initialize previous counted point
+
+				time_stage[0] = clock_sec();
+				// ---> ignore and coordinate transform
+				load_scan(ws, points, n);
+				transform_scan( &ws->x[0], &ws->y[0], n,
+						pose->x, pose->y, pose->theta,
+						conf->collect_condition_ignore_range_lower.value, conf->collect_condition_ignore_range_upper.value,
+						&ws->gx[0], &ws->gy[0], &ws->mask[0] );
+				// <--- ignore and coordinate transform
+				time_stage[1] = clock_sec();
+
+				if( grid_size > 0 ) grid_hash_reset(&ws->grid, n);
+
+				// ---> scanning loop (point cloud data)
+				for( i = 0; i < n; i++ ) {
+					double sq_dist;
+
+					// ignore
+					if( !ws->mask[i] ) continue;
+
+					{ // ---> culling
+						sq_dist = ( ws->x[i] - x_src_prev ) * ( ws->x[i] - x_src_prev )
+								+ ( ws->y[i] - y_src_prev ) * ( ws->y[i] - y_src_prev );
+
+						if( sq_dist < sq_culling ) {
+							continue;
+						}
+
+						x_src_prev = ws->x[i];
+						y_src_prev = ws->y[i];
+					} // <--- culling
+
+					// grid decimation
+					if( grid_size > 0 && !grid_hash_insert(&ws->grid, ws->gx[i], ws->gy[i], grid_size) ) {
+						continue;
+					}
+
+					// counting
+					gnd::lssmap_maker::counting_map(cmap, ws->gx[i], ws->gy[i]);
+
+					// pack counted points for log (cnt <= i)
+					ws->gx[cnt] = ws->gx[i];
+					ws->gy[cnt] = ws->gy[i];
+					cnt++;
+				} // <--- scanning loop (point cloud data)
+				time_stage[2] = clock_sec();
+
+				if( log && cnt > 0 ) {
+					log->write(pose->seq, pose->stamp, pose->x, pose->y, pose->theta, &ws->gx[0], &ws->gy[0], cnt);
+				}
+				time_stage[3] = clock_sec();
+
+				ws->latency_transform = time_stage[1] - time_stage[0];
+				ws->latency_counting = time_stage[2] - time_stage[1];
+				ws->latency_log = time_stage[3] - time_stage[2];
+
+				return cnt;
+			} // <--- operation
+		}
+
+
+		/**
+		 * @brief file out counting map data
+		 * @param [in] cmap : counting map
+		 * @param [in] conf : node configuration
+		 * @param [in] dir  : output directory
+		 */
+		inline
+		int fwrite_counting_map( gnd::lssmap::cmap_t *cmap, const node_config *conf, const char *dir ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+
+			if( conf->counting_map_binary.value || conf->counting_map_compact.value ) {
+				char fname[512];
+				::snprintf(fname, sizeof(fname), "%s/%s", dir, CMapBinary_default_fname);
+				if( write_counting_map_binary(cmap, fname, conf->counting_map_compact.value) < 0 ) {
+					::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to write \"\x1b[4m%s\x1b[0m\"\n", fname);
+					return -1;
+				}
+				return 0;
+			}
+			return gnd::lssmap::write_counting_map(cmap, dir);
+		}
+
+		/**
+		 * @brief file out statistics map image and its origin
+		 * @note images are written into "<name>.tmp" and renamed, so a viewer never sees a partial file
+		 * @param [in] lssmap : statistics map
+		 * @param [in] conf   : node configuration
+		 * @param [in] dir    : output directory
+		 */
+		inline
+		int fwrite_map_image( gnd::lssmap::lssmap_t *lssmap, const node_config *conf, const char *dir ) {
+			gnd_assert(!lssmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+
+			if( conf->image_map_band_rows.value > 0 ) {
+				// rasterize and write band by band (opt-in, the image differs from the whole image)
+				if( fwrite_map_image_banded(lssmap, conf, dir) < 0 ) {
+					::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to write map image in \"\x1b[4m%s\x1b[0m\"\n", dir);
+					return -1;
+				}
+				return 0;
+			}
+
+			{ // ---> build bmp image (to visualize for human)
+				gnd::bmp8_t bmp;
+				gnd::bmp32_t bmp32;
+				char fname[512];
+				char fname_tmp[512];
+				int ret = 0;
+
+				// make bmp image: it show the likelihood field
+				gnd::lssmap::build_bmp(&bmp, lssmap, conf->image_map_pixel_size.value);
+				// make bmp image: it show the likelihood field
+				gnd::lssmap::build_bmp(&bmp32, lssmap, conf->image_map_pixel_size.value);
+				// file out
+				::snprintf(fname, sizeof(fname), "%s/%s", dir, "map-image8.bmp");
+				::snprintf(fname_tmp, sizeof(fname_tmp), "%s.tmp", fname);
+				if( gnd::bmp::write8(fname_tmp, &bmp) < 0 || ::rename(fname_tmp, fname) < 0 ) {
+					::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to write \"\x1b[4m%s\x1b[0m\"\n", fname);
+					ret = -1;
+				}
+				// file out
+				::snprintf(fname, sizeof(fname), "%s/%s", dir, "map-image32.bmp");
+				::snprintf(fname_tmp, sizeof(fname_tmp), "%s.tmp", fname);
+				if( gnd::bmp::write32(fname_tmp, &bmp32) < 0 || ::rename(fname_tmp, fname) < 0 ) {
+					::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to write \"\x1b[4m%s\x1b[0m\"\n", fname);
+					ret = -1;
+				}
+
+				{ // ---> origin
+					FILE *fp = 0;
+					double x, y;
+
+					if( ::snprintf(fname, sizeof(fname), "%s/%s", dir, "origin.txt" ) >= (int)sizeof(fname) ){
+						::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to open. file name is too long\n");
+						ret = -1;
+					}
+					else if( !(fp = ::fopen(fname, "w")) ) {
+						::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to open \"\x1b[4m%s\x1b[0m\"\n", fname);
+						ret = -1;
+					}
+					else {
+						bmp.pget_origin(&x, &y);
+						::fprintf(fp, "%lf %lf\n", x, y);
+						if( ::fclose(fp) != 0 ) ret = -1;
+					}
+				} // --->  origin
+
+				bmp.deallocate();
+				bmp32.deallocate();
+				return ret;
+			} // <--- build bmp image (to visualize for human)
+		}
+
+		/**
+		 * @brief file out counting map, statistics map image and its origin
+		 * @param [in] cmap : counting map
+		 * @param [in] conf : node configuration
+		 * @param [in] dir  : output directory
+		 */
+		inline
+		int fwrite_map( gnd::lssmap::cmap_t *cmap, const node_config *conf, const char *dir ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+
+			// counting data file out
+			if( fwrite_counting_map(cmap, conf, dir) < 0 ) return -1;
+
+			{ // ---> build map and image
+				gnd::lssmap::lssmap_t lssmap;
+				int ret;
+				::fprintf(stdout, "  => create laser scan statistics map\n");
+
+				// build environmental map
+				if( gnd::lssmap::build_map(&lssmap, cmap, conf->sensor_range.value, conf->additional_smoothing_parameter.value ) < 0 ) return -1;
+				ret = fwrite_map_image(&lssmap, conf, dir);
+				gnd::lssmap::destroy_map(&lssmap);
+				if( ret < 0 ) return -1;
+
+				::fprintf(stdout, "   ... make map image %s\n", "map-image.bmp");
+			} // <--- build map and image
+
+			return 0;
+		}
+
+		/**
+		 * @brief file out tiled counting map data
+		 * @details the binary formats are written tile row by tile row (see write_counting_map_binary()),
+		 *          a single tile counting map is written in place.
+		 *          the text format of tiles is gathered into a plain counting map, the writer of gndlib takes a plain counting map
+		 * @param [in] cmap : tiled counting map
+		 * @param [in] conf : node configuration
+		 * @param [in] dir  : output directory
+		 */
+		inline
+		int fwrite_counting_map( tiled_cmap_t *cmap, const node_config *conf, const char *dir ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+
+			if( conf->counting_map_binary.value || conf->counting_map_compact.value ) {
+				char fname[512];
+				::snprintf(fname, sizeof(fname), "%s/%s", dir, CMapBinary_default_fname);
+				if( write_counting_map_binary(cmap, fname, conf->counting_map_compact.value) < 0 ) {
+					::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to write \"\x1b[4m%s\x1b[0m\"\n", fname);
+					return -1;
+				}
+				return 0;
+			}
+
+			if( cmap->tile_size <= 0 ) {
+				gnd::lssmap::cmap_t *p;
+
+				if( !(p = single_tile_map(cmap)) ) return -1;
+				return fwrite_counting_map(p, conf, dir);
+			}
+
+			{ // ---> gather text format
+				gnd::lssmap::cmap_t ws;
+				int ret;
+
+				if( to_counting_map(&ws, cmap) < 0 ) return -1;
+				ret = fwrite_counting_map(&ws, conf, dir);
+				gnd::lssmap::destroy_counting_map(&ws);
+				return ret;
+			} // <--- gather text format
+		}
+
+		/**
+		 * @brief file out tiled counting map, statistics map image and its origin
+		 * @note the counting map is written and built tile by tile (see build_map()),
+		 *       the statistics map is whole to make the image
+		 * @param [in] cmap : tiled counting map
+		 * @param [in] conf : node configuration
+		 * @param [in] dir  : output directory
+		 */
+		inline
+		int fwrite_map( tiled_cmap_t *cmap, const node_config *conf, const char *dir ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				gnd::lssmap::lssmap_t lssmap;
+				int ret;
+
+				// counting data file out
+				if( fwrite_counting_map(cmap, conf, dir) < 0 ) return -1;
+
+				if( conf->map_build_threads.value > 1 )	::fprintf(stdout, "  => create laser scan statistics map on %d threads\n", conf->map_build_threads.value);
+				else									::fprintf(stdout, "  => create laser scan statistics map\n");
+				if( build_map(&lssmap, cmap, conf) < 0 ) return -1;
+				ret = fwrite_map_image(&lssmap, conf, dir);
+				gnd::lssmap::destroy_map(&lssmap);
+				if( ret < 0 ) return -1;
+
+				::fprintf(stdout, "   ... make map image %s\n", "map-image.bmp");
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief file out coarser levels of tiled counting map
+		 * @details each level is reduced and written tile by tile (see reduce_counting_map())
+		 * @param [in] cmap : tiled counting map (level 0)
+		 * @param [in] conf : node configuration
+		 * @param [in] dir  : output directory
+		 * @return number of written levels (-1: fail to write a level)
+		 */
+		inline
+		int fwrite_counting_pyramid( tiled_cmap_t *cmap, const node_config *conf, const char *dir ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				tiled_cmap_t level[2];
+				tiled_cmap_t *fine = cmap;
+				int l;
+				int ret = 0;
+
+				for( l = 1; l <= conf->counting_map_pyramid_levels.value; l++ ) {
+					tiled_cmap_t *coarse = &level[l % 2];
+					char subdir[512];
+
+					ret = -1;
+					if( ::snprintf(subdir, sizeof(subdir), "%s/level%d", dir, l) >= (int)sizeof(subdir) ) break;
+					if( reduce_counting_map(coarse, fine) < 0 ) break;
+					if( fine != cmap ) destroy_counting_map(fine);
+					fine = coarse;
+
+					if( ::mkdir(subdir, 0755) < 0 && errno != EEXIST ) {
+						::fprintf(stderr, "    ... error: fail to create directory \"%s\"\n", subdir);
+						break;
+					}
+					if( fwrite_counting_map(coarse, conf, subdir) < 0 ) break;
+					::fprintf(stdout, "   ... write counting map level %d (cell size %.03lf[m]) in \"%s\"\n", l, counting_map_cell_size(coarse), subdir);
+					ret = 0;
+				}
+				if( fine != cmap ) destroy_counting_map(fine);
+				return ret < 0 ? -1 : l - 1;
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
 
 #endif // gnd_lssmap_maker_HPP
@@ -0,0 +1,312 @@
+/*
+ * gnd_lssmap_maker_checkpoint.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: asynchronous CHECKPOINT writer of tiled counting map
+ */
+
+#ifndef GND_LSSMAP_MAKER_CHECKPOINT_HPP_
+#define GND_LSSMAP_MAKER_CHECKPOINT_HPP_
+
+#include <stdio.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <map>
+#include <set>
+#include <vector>
+#include <utility>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_cmap_binary.hpp"
+#include "gnd/gnd_lssmap_maker_tiled_cmap.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		class checkpoint_writer;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief asynchronous checkpoint writer
+		 * @details the checkpoint is a directory of binary counting map files, one file per tile ("tile_<x>_<y>.cmap").
+		 *          snapshot() hands over only the tiles counted since the previous snapshot without copying them
+		 *          (the tiles are shared copy on write, see share_tile()), so the integration loop is not stalled.
+		 *          the writer thread writes the handed over tiles into their files and releases them, the other files
+		 *          are kept, so the checkpoint is written incrementally and no copy of the whole map is held.
+		 *          each file is written into "<file>.tmp" and renamed, so every tile file is complete.
+		 *          the files of tiles that are not in the map are removed after the first checkpoint.
+		 *          a checkpoint directory is read back through "initial-counting-map-directory".
+		 */
+		class checkpoint_writer {
+		public:
+			checkpoint_writer();
+			~checkpoint_writer();
+
+		public:
+			int start( const char *dir, bool compact = false );
+			int snapshot( tiled_cmap_t *cmap );
+			int stop();
+
+			uint32_t nwritten();
+			bool is_running() const;
+
+		private:
+			typedef std::map<tile_key_t, tile_share_t*> tile_shares_t;
+
+		private:
+			void run();
+			int write( tile_shares_t *shares );
+			int prune();
+			static void release_shares( tile_shares_t *shares );
+
+		private:
+			boost::thread _thread;				///< writer thread
+			boost::mutex _mutex;				///< mutex for pending tiles and flags
+			boost::condition_variable _cond;	///< notify pending tiles or quit
+			tile_shares_t _pending;				///< tiles handed over and not yet written
+			std::set<tile_key_t> _written;		///< tiles written since start (writer thread only)
+			uint64_t _since;					///< generation of counting map to hand over from
+			char _dir[512];						///< checkpoint directory
+			uint32_t _nwritten;					///< number of written checkpoints
+			bool _flg_compact;					///< compact layout
+			bool _flg_pruned;					///< files of other tiles are removed
+			bool _flg_running;					///< thread is running
+			bool _flg_quit;						///< quit request
+		};
+
+		inline
+		checkpoint_writer::checkpoint_writer()
+		: _since(1), _nwritten(0), _flg_compact(false), _flg_pruned(false), _flg_running(false), _flg_quit(false) {
+			_dir[0] = '\0';
+		}
+
+		inline
+		checkpoint_writer::~checkpoint_writer() {
+			stop();
+		}
+
+		/**
+		 * @brief start writer thread
+		 * @param [in] dir     : checkpoint directory (created if not exist)
+		 * @param [in] compact : compact layout
+		 */
+		inline
+		int checkpoint_writer::start( const char *dir, bool compact ) {
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+			gnd_assert(_flg_running, -1, "already started\n" );
+
+			if( ::snprintf(_dir, sizeof(_dir), "%s", dir) >= (int)sizeof(_dir) ) return -1;
+			if( ::mkdir(_dir, 0755) < 0 && errno != EEXIST ) return -1;
+			_since = 1;
+			_nwritten = 0;
+			_written.clear();
+			_flg_compact = compact;
+			_flg_pruned = false;
+			_flg_quit = false;
+			_flg_running = true;
+			_thread = boost::thread( boost::bind(&checkpoint_writer::run, this) );
+			return 0;
+		}
+
+		/**
+		 * @brief hand over the tiles counted since the previous snapshot
+		 * @note call on the thread that counts into the tiled counting map
+		 * @param [in,out] cmap : tiled counting map
+		 * @return number of handed over tiles
+		 */
+		inline
+		int checkpoint_writer::snapshot( tiled_cmap_t *cmap ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_flg_running, -1, "not started\n" );
+
+			{ // ---> operation
+				std::vector<tile_key_t> keys;
+				tile_shares_t shares;
+
+				if( modified_tiles(cmap, _since, &keys) <= 0 ) return 0;
+				_since = next_generation(cmap) + 1;
+
+				// ---> share tiles
+				for( size_t i = 0; i < keys.size(); i++ ) {
+					tile_share_t *p = share_tile(cmap, keys[i]);
+
+					if( !p ) {
+						release_shares(&shares);
+						return -1;
+					}
+					shares[keys[i]] = p;
+				} // <--- share tiles
+
+				{ // ---> hand over
+					boost::mutex::scoped_lock lock(_mutex);
+					tile_shares_t::iterator it;
+
+					for( it = shares.begin(); it != shares.end(); ++it ) {
+						tile_shares_t::iterator prev = _pending.find(it->first);
+						if( prev != _pending.end() ) {
+							// not yet written, replaced by the newer one
+							release_tile_share(prev->second);
+							prev->second = it->second;
+						}
+						else {
+							_pending.insert(*it);
+						}
+					}
+					_cond.notify_all();
+				} // <--- hand over
+				return (int) keys.size();
+			} // <--- operation
+		}
+
+		/**
+		 * @brief write pending tiles and stop writer thread
+		 */
+		inline
+		int checkpoint_writer::stop() {
+			if( !_flg_running ) return 0;
+
+			{
+				boost::mutex::scoped_lock lock(_mutex);
+				_flg_quit = true;
+				_cond.notify_all();
+			}
+			_thread.join();
+			_flg_running = false;
+
+			release_shares(&_pending);
+			_written.clear();
+			return 0;
+		}
+
+		/**
+		 * @brief number of written checkpoints
+		 */
+		inline
+		uint32_t checkpoint_writer::nwritten() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _nwritten;
+		}
+
+		/**
+		 * @brief writer thread is running
+		 */
+		inline
+		bool checkpoint_writer::is_running() const {
+			return _flg_running;
+		}
+
+		/**
+		 * @brief writer thread
+		 */
+		inline
+		void checkpoint_writer::run() {
+			for(;;) {
+				tile_shares_t shares;
+				bool flg_quit;
+
+				{ // ---> wait for snapshot
+					boost::mutex::scoped_lock lock(_mutex);
+					while( _pending.empty() && !_flg_quit ) {
+						_cond.wait(lock);
+					}
+					shares.swap(_pending);
+					flg_quit = _flg_quit;
+				} // <--- wait for snapshot
+
+				if( !shares.empty() ) {
+					int ret = write(&shares);
+
+					release_shares(&shares);
+					if( ret == 0 && !_flg_pruned ) ret = prune();
+					if( ret == 0 ) {
+						boost::mutex::scoped_lock lock(_mutex);
+						_nwritten++;
+					}
+					else {
+						::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to write checkpoint \"\x1b[4m%s\x1b[0m\"\n", _dir);
+					}
+				}
+
+				if( flg_quit ) break;
+			}
+		}
+
+		/**
+		 * @brief write handed over tiles into their files
+		 */
+		inline
+		int checkpoint_writer::write( tile_shares_t *shares ) {
+			tile_shares_t::iterator it;
+			int ret = 0;
+
+			for( it = shares->begin(); it != shares->end(); ++it ) {
+				char fname[512];
+
+				if( tile_fname(_dir, it->first, fname, sizeof(fname)) < 0
+				||  write_counting_map_binary(it->second->cmap, fname, _flg_compact) < 0 ) {
+					ret = -1;
+					continue;
+				}
+				_written.insert(it->first);
+			}
+			return ret;
+		}
+
+		/**
+		 * @brief remove the files of tiles that are not written since start (e.g. a previous run)
+		 * @note the first snapshot hands over every tile of the map
+		 */
+		inline
+		int checkpoint_writer::prune() {
+			DIR *d;
+			struct dirent *e;
+			int ret = 0;
+
+			if( !(d = ::opendir(_dir)) ) return -1;
+			while( (e = ::readdir(d)) != 0 ) {
+				tile_key_t key;
+				char fname[512];
+
+				if( parse_tile_fname(e->d_name, &key) < 0 || _written.count(key) > 0 ) continue;
+				if( ::snprintf(fname, sizeof(fname), "%s/%s", _dir, e->d_name) >= (int)sizeof(fname)
+				||  ::unlink(fname) < 0 ) ret = -1;
+			}
+			::closedir(d);
+			if( ret == 0 ) _flg_pruned = true;
+			return ret;
+		}
+
+		/**
+		 * @brief release shared tiles
+		 */
+		inline
+		void checkpoint_writer::release_shares( tile_shares_t *shares ) {
+			tile_shares_t::iterator it;
+			for( it = shares->begin(); it != shares->end(); ++it ) {
+				release_tile_share(it->second);
+			}
+			shares->clear();
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_CHECKPOINT_HPP_ */
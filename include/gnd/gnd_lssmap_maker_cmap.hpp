@@ -0,0 +1,254 @@
+/*
+ * gnd_lssmap_maker_cmap.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: Counting MAP utilities on top of gnd-lssmap-base (merge, clear)
+ */
+
+#ifndef GND_LSSMAP_MAKER_CMAP_HPP_
+#define GND_LSSMAP_MAKER_CMAP_HPP_
+
+#include <stdio.h>
+#include <math.h>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-matrix-base.hpp"
+#include "gnd/gnd-lssmap-base.hpp"
+
+/*
+ * these functions touch the counting cells of gnd::lssmap::cmap_t directly
+ *  - cmap_t is a set of gnd::lssmap::PlaneNum grid planes of gnd::lssmap::count_cell,
+ *    each plane shifted by a part of the cell size
+ *  - count_cell keeps the number of points (n), sum of position (sum) and sum of squared position (sum2),
+ *    the position is relative to the core of the cell
+ */
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		typedef gnd::lssmap::count_cell count_cell_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief get cell size of counting map
+		 * @param [in] cmap : counting map
+		 * @return cell size (m)
+		 */
+		inline
+		double counting_map_cell_size( const gnd::lssmap::cmap_t *cmap ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			return cmap->plane[0].xrsl();
+		}
+
+		/**
+		 * @brief count a point
+		 * @note same name as the tiled counting map, so that the integration code does not depend on the map type
+		 * @param [in,out] cmap : counting map
+		 * @param [in]     x    : x on global coordinate
+		 * @param [in]     y    : y on global coordinate
+		 */
+		inline
+		int counting_map( gnd::lssmap::cmap_t *cmap, double x, double y ) {
+			return gnd::lssmap::counting_map(cmap, x, y);
+		}
+
+		/**
+		 * @brief add a counting cell to another
+		 * @param [out] dest : destination cell
+		 * @param [in]  src  : source cell
+		 */
+		inline
+		void add_count_cell( count_cell_t *dest, const count_cell_t *src ) {
+			dest->n += src->n;
+			gnd::matrix::add( &dest->sum, &src->sum, &dest->sum );
+			gnd::matrix::add( &dest->sum2, &src->sum2, &dest->sum2 );
+		}
+
+		/**
+		 * @brief add all counting cells of a map to another map
+		 * @note the cells are visited in plane, row, column order, so the result is deterministic
+		 *       for the same input. both maps must have the same cell size
+		 * @param [out] dest : destination counting map
+		 * @param [in]  src  : source counting map
+		 * @return number of merged cells
+		 */
+		inline
+		int merge_counting_map( gnd::lssmap::cmap_t *dest, gnd::lssmap::cmap_t *src ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+			gnd_assert(counting_map_cell_size(dest) != counting_map_cell_size(src), -1, "cell size mismatch\n" );
+
+			{ // ---> operation
+				int cnt = 0;
+
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					for( uint32_t r = 0; r < src->plane[i].row(); r++ ) {
+						for( uint32_t c = 0; c < src->plane[i].column(); c++ ) {
+							count_cell_t *s = src->plane[i].pointer(r, c);
+							count_cell_t *d;
+							double x, y;
+
+							if( !s || s->n == 0 ) continue;
+
+							// get cell on the same position of destination (extend if out of range)
+							src->plane[i].pget_pos_core(r, c, &x, &y);
+							if( !(d = dest->plane[i].ppointer(x, y)) ) {
+								dest->plane[i].reallocate(x, y);
+								if( !(d = dest->plane[i].ppointer(x, y)) ) return -1;
+							}
+
+							add_count_cell(d, s);
+							cnt++;
+						}
+					}
+				}
+				return cnt;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief reduce a counting map into the next coarser level of pyramid (twice the cell size)
+		 * @details the planes of the coarse map are shifted by multiples of the fine cell size, so each cell of
+		 *          plane 0 of the fine map lies in one cell of every coarse plane. the moments are moved from the
+		 *          core of the fine cell to the core of the coarse cell, d = fine core - coarse core,
+		 *          sum' = sum + n d, sum2' = sum2 + d sum^T + sum d^T + n d d^T.
+		 *          the result is the same as counting the points at the coarse cell size.
+		 *          the shift is checked on each cell: the fine core must be half a fine cell off the coarse core on both axes
+		 * @param [out] dest : coarse counting map (initialized in this function)
+		 * @param [in]  src  : fine counting map
+		 * @return number of reduced cells (-1: a fine cell straddles coarse cells)
+		 */
+		inline
+		int reduce_counting_map( gnd::lssmap::cmap_t *dest, gnd::lssmap::cmap_t *src ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				const double fine = counting_map_cell_size(src);
+				const double cell = 2 * fine;
+				const double eps = fine * 1.0e-6;
+				int cnt = 0;
+
+				if( gnd::lssmap::init_counting_map(dest, cell, cell) < 0 ) return -1;
+
+				for( uint32_t r = 0; r < src->plane[0].row(); r++ ) {
+					for( uint32_t c = 0; c < src->plane[0].column(); c++ ) {
+						count_cell_t *s = src->plane[0].pointer(r, c);
+						double x, y;
+
+						if( !s || s->n == 0 ) continue;
+						src->plane[0].pget_pos_core(r, c, &x, &y);
+
+						for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+							count_cell_t *d;
+							uint32_t dr, dc;
+							double cx, cy, dx, dy, n;
+
+							// get cell on the same position of destination (extend if out of range)
+							if( !(d = dest->plane[i].ppointer(x, y)) ) {
+								dest->plane[i].reallocate(x, y);
+								if( !(d = dest->plane[i].ppointer(x, y)) ) return -1;
+							}
+							dest->plane[i].pindex(x, y, &dr, &dc);
+							dest->plane[i].pget_pos_core(dr, dc, &cx, &cy);
+							dx = x - cx;
+							dy = y - cy;
+							// plane shift is not a multiple of the fine cell size
+							if( ::fabs(::fabs(dx) - fine / 2) > eps || ::fabs(::fabs(dy) - fine / 2) > eps ) {
+								::fprintf(stderr, "    ... error: coarse plane %d is not aligned with fine cells\n", (int)i);
+								return -1;
+							}
+							n = (double) s->n;
+
+							d->n += s->n;
+							d->sum[0][0] += s->sum[0][0] + n * dx;
+							d->sum[1][0] += s->sum[1][0] + n * dy;
+							d->sum2[0][0] += s->sum2[0][0] + 2 * dx * s->sum[0][0] + n * dx * dx;
+							d->sum2[0][1] += s->sum2[0][1] + dx * s->sum[1][0] + dy * s->sum[0][0] + n * dx * dy;
+							d->sum2[1][0] += s->sum2[1][0] + dy * s->sum[0][0] + dx * s->sum[1][0] + n * dy * dx;
+							d->sum2[1][1] += s->sum2[1][1] + 2 * dy * s->sum[1][0] + n * dy * dy;
+						}
+						cnt++;
+					}
+				}
+				return cnt;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief compare counting maps cell by cell
+		 * @details a cell matches when the number of points is the same and the moments differ by no more than
+		 *          tolerance x n x cell size (sum) or tolerance x n x cell size^2 (sum2)
+		 * @param [in] a         : counting map
+		 * @param [in] b         : counting map to compare with
+		 * @param [in] tolerance : relative tolerance of moments (0: exact)
+		 * @return number of counted cells of a that differ from (or are missing in) b
+		 */
+		inline
+		int compare_counting_map( gnd::lssmap::cmap_t *a, gnd::lssmap::cmap_t *b, double tolerance ) {
+			gnd_assert(!a, -1, "invalid null pointer argument\n" );
+			gnd_assert(!b, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				const double cell = counting_map_cell_size(a);
+				int cnt = 0;
+
+				if( counting_map_cell_size(b) != cell ) return -1;
+
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					for( uint32_t r = 0; r < a->plane[i].row(); r++ ) {
+						for( uint32_t c = 0; c < a->plane[i].column(); c++ ) {
+							count_cell_t *p = a->plane[i].pointer(r, c);
+							count_cell_t *q;
+							double x, y, e1, e2;
+
+							if( !p || p->n == 0 ) continue;
+
+							a->plane[i].pget_pos_core(r, c, &x, &y);
+							if( !(q = b->plane[i].ppointer(x, y)) || q->n != p->n ) {
+								cnt++;
+								continue;
+							}
+							e1 = tolerance * p->n * cell;
+							e2 = e1 * cell;
+							if( ::fabs(p->sum[0][0] - q->sum[0][0]) > e1 || ::fabs(p->sum[1][0] - q->sum[1][0]) > e1
+									|| ::fabs(p->sum2[0][0] - q->sum2[0][0]) > e2 || ::fabs(p->sum2[0][1] - q->sum2[0][1]) > e2
+									|| ::fabs(p->sum2[1][0] - q->sum2[1][0]) > e2 || ::fabs(p->sum2[1][1] - q->sum2[1][1]) > e2 ) {
+								cnt++;
+							}
+						}
+					}
+				}
+				return cnt;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief release and re-initialize counting map with its cell size
+		 * @param [out] cmap : counting map
+		 */
+		inline
+		int clear_counting_map( gnd::lssmap::cmap_t *cmap ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				double cell = counting_map_cell_size(cmap);
+				gnd::lssmap::destroy_counting_map(cmap);
+				return gnd::lssmap::init_counting_map(cmap, cell, cell);
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_CMAP_HPP_ */
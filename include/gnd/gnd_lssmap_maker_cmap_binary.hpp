@@ -0,0 +1,634 @@
+/*
+ * gnd_lssmap_maker_cmap_binary.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: versioned BINARY file format of Counting MAP, read without text parsing
+ */
+
+#ifndef GND_LSSMAP_MAKER_CMAP_BINARY_HPP_
+#define GND_LSSMAP_MAKER_CMAP_BINARY_HPP_
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker_cmap.hpp"
+
+/*
+ * binary counting map file layout (host byte order, checked by byte order mark)
+ *  - file header       : cmap_binary_header
+ *  - plane header x N  : cmap_binary_plane (N = file header nplanes)
+ *  - cell data x N     : row-major array of cmap_binary_cell, rows x columns of each plane, in plane order
+ *
+ * compact layout (version 2), only counted cells are stored
+ *  - file header       : cmap_binary_header (cell_bytes = size of cmap_compact_cell)
+ *  - plane header x N  : cmap_compact_plane
+ *  - wide cell data x N    : nwide cmap_binary_wide_cell of each plane, in plane order
+ *  - compact cell data x N : ncompact cmap_compact_cell of each plane, in plane order
+ *
+ * a compact cell holds the count in 32 bit and the mean and the sum of squared deviations from the mean
+ * (Welford's M2) in float, both relative to the cell core. as |mean| <= cell size / 2 and M2 is centered,
+ * float rounding (relative 2^-24 = 6.0e-8) bounds the errors of the restored statistics by
+ *  - mean       : 3.0e-8 x cell size
+ *  - covariance : 1.2e-7 x (variance + (cell size / 2)^2), i.e. below 2e-8 m^2 for 80 cm cells
+ * a cell whose count does not fit in 32 bit is upgraded to a wide cell (64 bit count, double sums) without loss.
+ * the error is of one round trip, a map packed again after it is restored is rounded again. the packed tiles
+ * of tiled counting map use the same image with only wide cells (exact, counted cells only) unless compact.
+ */
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct cmap_binary_header;
+		typedef struct cmap_binary_header cmap_binary_header_t;
+
+		struct cmap_binary_plane;
+		typedef struct cmap_binary_plane cmap_binary_plane_t;
+
+		struct cmap_binary_cell;
+		typedef struct cmap_binary_cell cmap_binary_cell_t;
+
+		struct cmap_compact_plane;
+		typedef struct cmap_compact_plane cmap_compact_plane_t;
+
+		struct cmap_compact_cell;
+		typedef struct cmap_compact_cell cmap_compact_cell_t;
+
+		struct cmap_binary_wide_cell;
+		typedef struct cmap_binary_wide_cell cmap_binary_wide_cell_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// file magic
+		static const char CMapBinary_magic[8] = { 'G', 'N', 'D', 'C', 'M', 'A', 'P', '\0' };
+		/// file format version
+		static const uint32_t CMapBinary_version = 1;
+		/// file format version of compact layout
+		static const uint32_t CMapBinary_version_compact = 2;
+		/// maximum count of a compact cell
+		static const uint32_t CMapCompact_count_max = 0xffffffffU;
+		/// byte order mark
+		static const uint32_t CMapBinary_byte_order = 0x01020304;
+		/// default file name
+		static const char CMapBinary_default_fname[] = "counting-map.cmap";
+	}
+} // <--- const variables definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief binary counting map file header
+		 */
+		struct cmap_binary_header {
+			char magic[8];				///< file magic
+			uint32_t version;			///< format version
+			uint32_t byte_order;		///< byte order mark
+			uint32_t nplanes;			///< number of planes
+			uint32_t cell_bytes;		///< size of a cell record
+			double cell_size;			///< cell size (m)
+		};
+
+		/**
+		 * @brief binary counting map plane header
+		 */
+		struct cmap_binary_plane {
+			double xorg;				///< x of origin (m)
+			double yorg;				///< y of origin (m)
+			uint32_t rows;				///< number of rows
+			uint32_t columns;			///< number of columns
+		};
+
+		/**
+		 * @brief binary counting map cell
+		 */
+		struct cmap_binary_cell {
+			uint64_t n;					///< number of points
+			double sum[2];				///< sum of x, y
+			double sum2[4];				///< sum of xx, xy, yx, yy
+		};
+
+		/**
+		 * @brief compact counting map plane header
+		 */
+		struct cmap_compact_plane {
+			double xorg;				///< x of origin (m)
+			double yorg;				///< y of origin (m)
+			uint32_t rows;				///< number of rows
+			uint32_t columns;			///< number of columns
+			uint32_t ncompact;			///< number of compact cells
+			uint32_t nwide;				///< number of wide cells
+		};
+
+		/**
+		 * @brief compact counting map cell (28 bytes)
+		 */
+		struct cmap_compact_cell {
+			uint32_t index;				///< row * columns + column
+			uint32_t n;					///< number of points
+			float mean[2];				///< mean of x, y
+			float m2[3];				///< sum of squared deviations xx, xy, yy
+		};
+
+		/**
+		 * @brief wide counting map cell of compact layout, for a count that does not fit in a compact cell
+		 */
+		struct cmap_binary_wide_cell {
+			uint32_t index;				///< row * columns + column
+			uint32_t reserved;			///< padding
+			uint64_t n;					///< number of points
+			double sum[2];				///< sum of x, y
+			double sum2[3];				///< sum of xx, xy, yy
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief set binary file header
+		 * @param [out] header  : file header
+		 * @param [in]  cell    : cell size (m)
+		 * @param [in]  compact : compact layout
+		 */
+		inline
+		void binary_header( cmap_binary_header_t *header, double cell, bool compact ) {
+			::memset(header, 0, sizeof(*header));
+			::memcpy(header->magic, CMapBinary_magic, sizeof(header->magic));
+			header->version = compact ? CMapBinary_version_compact : CMapBinary_version;
+			header->byte_order = CMapBinary_byte_order;
+			header->nplanes = (uint32_t) gnd::lssmap::PlaneNum;
+			header->cell_bytes = (uint32_t) (compact ? sizeof(cmap_compact_cell_t) : sizeof(cmap_binary_cell_t));
+			header->cell_size = cell;
+		}
+
+		/**
+		 * @brief convert a counting cell into a binary cell of dense layout
+		 * @param [out] dest : binary cell
+		 * @param [in]  p    : counting cell (null: not counted)
+		 */
+		inline
+		void binary_cell( cmap_binary_cell_t *dest, const count_cell_t *p ) {
+			if( !p ) {
+				::memset(dest, 0, sizeof(*dest));
+				return;
+			}
+			dest->n = p->n;
+			dest->sum[0] = p->sum[0][0];
+			dest->sum[1] = p->sum[1][0];
+			dest->sum2[0] = p->sum2[0][0];
+			dest->sum2[1] = p->sum2[0][1];
+			dest->sum2[2] = p->sum2[1][0];
+			dest->sum2[3] = p->sum2[1][1];
+		}
+
+		/**
+		 * @brief append a counted cell in compact layout, or as a wide cell if the count does not fit
+		 * @param [in]     p       : counting cell (n > 0)
+		 * @param [in]     index   : row * columns + column
+		 * @param [in,out] compact : compact cells
+		 * @param [in,out] wide    : wide cells
+		 * @param [in]     exact   : always append as a wide cell (without rounding)
+		 */
+		inline
+		void compact_cell( const count_cell_t *p, uint32_t index, std::vector<cmap_compact_cell_t> *compact, std::vector<cmap_binary_wide_cell_t> *wide, bool exact = false ) {
+			if( !exact && (uint64_t) p->n < CMapCompact_count_max ) {
+				cmap_compact_cell_t ws;
+				double mx = p->sum[0][0] / p->n;
+				double my = p->sum[1][0] / p->n;
+				double m2[3];
+
+				// center in double before rounding to float, no cancellation is left in the float values
+				m2[0] = p->sum2[0][0] - p->n * mx * mx;
+				m2[1] = p->sum2[0][1] - p->n * mx * my;
+				m2[2] = p->sum2[1][1] - p->n * my * my;
+				ws.index = index;
+				ws.n = (uint32_t) p->n;
+				ws.mean[0] = (float) mx;
+				ws.mean[1] = (float) my;
+				ws.m2[0] = m2[0] > 0 ? (float) m2[0] : 0.0f;
+				ws.m2[1] = (float) m2[1];
+				ws.m2[2] = m2[2] > 0 ? (float) m2[2] : 0.0f;
+				compact->push_back(ws);
+			}
+			else {
+				// upgrade to wide cell
+				cmap_binary_wide_cell_t ws;
+
+				ws.index = index;
+				ws.reserved = 0;
+				ws.n = p->n;
+				ws.sum[0] = p->sum[0][0];
+				ws.sum[1] = p->sum[1][0];
+				ws.sum2[0] = p->sum2[0][0];
+				ws.sum2[1] = p->sum2[0][1];
+				ws.sum2[2] = p->sum2[1][1];
+				wide->push_back(ws);
+			}
+		}
+
+		/**
+		 * @brief pack counting map in compact layout
+		 * @details the image is the same as the compact binary file, see the file layout above
+		 * @param [in]  cmap  : counting map
+		 * @param [out] dest  : packed counting map
+		 * @param [in]  exact : store all the counted cells as wide cells, restored without error
+		 * @return number of stored cells
+		 */
+		inline
+		int pack_counting_map( gnd::lssmap::cmap_t *cmap, std::vector<uint8_t> *dest, bool exact = false ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				cmap_binary_header_t header;
+				std::vector<cmap_compact_cell_t> compact;
+				std::vector<cmap_binary_wide_cell_t> wide;
+
+				{ // ---> file header
+					binary_header(&header, counting_map_cell_size(cmap), true);
+					dest->assign( (const uint8_t*) &header, (const uint8_t*) (&header + 1) );
+					dest->resize( sizeof(header) + sizeof(cmap_compact_plane_t) * gnd::lssmap::PlaneNum, 0 );
+				} // <--- file header
+
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					cmap_compact_plane_t plane;
+
+					::memset(&plane, 0, sizeof(plane));
+					cmap->plane[i].pget_origin(&plane.xorg, &plane.yorg);
+					plane.rows = cmap->plane[i].row();
+					plane.columns = cmap->plane[i].column();
+					if( (uint64_t) plane.rows * plane.columns > 0xffffffffULL ) return -1;
+					plane.ncompact = (uint32_t) compact.size();
+					plane.nwide = (uint32_t) wide.size();
+
+					// ---> cells
+					for( uint32_t r = 0; r < plane.rows; r++ ) {
+						for( uint32_t c = 0; c < plane.columns; c++ ) {
+							count_cell_t *p = cmap->plane[i].pointer(r, c);
+
+							if( !p || p->n == 0 ) continue;
+							compact_cell(p, r * plane.columns + c, &compact, &wide, exact);
+						}
+					} // <--- cells
+
+					plane.ncompact = (uint32_t) compact.size() - plane.ncompact;
+					plane.nwide = (uint32_t) wide.size() - plane.nwide;
+					::memcpy(&(*dest)[sizeof(header) + sizeof(plane) * i], &plane, sizeof(plane));
+				}
+
+				// wide cells first, they keep 8 byte alignment
+				if( !wide.empty() ) {
+					dest->insert(dest->end(), (const uint8_t*) &wide[0], (const uint8_t*) (&wide[0] + wide.size()));
+				}
+				if( !compact.empty() ) {
+					dest->insert(dest->end(), (const uint8_t*) &compact[0], (const uint8_t*) (&compact[0] + compact.size()));
+				}
+				return (int) (compact.size() + wide.size());
+			} // <--- operation
+		}
+
+
+		/**
+		 * @brief write counting map in binary format
+		 * @note written into "<fname>.tmp" and renamed, so a reader never sees a partial file
+		 * @param [in] cmap    : counting map
+		 * @param [in] fname   : file name
+		 * @param [in] compact : compact layout (only counted cells, see the file layout above)
+		 */
+		inline
+		int write_counting_map_binary( gnd::lssmap::cmap_t *cmap, const char *fname, bool compact = false ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!fname, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				char fname_tmp[1024];
+				FILE *fp;
+				cmap_binary_header_t header;
+				std::vector<uint8_t> packed;
+
+				if( ::snprintf(fname_tmp, sizeof(fname_tmp), "%s.tmp", fname) >= (int)sizeof(fname_tmp) ) return -1;
+				if( compact && pack_counting_map(cmap, &packed) < 0 ) return -1;
+				if( !(fp = ::fopen(fname_tmp, "wb")) ) return -1;
+
+				if( compact ) {
+					if( ::fwrite(&packed[0], packed.size(), 1, fp) != 1 ) goto error;
+					goto done;
+				}
+
+				{ // ---> file header
+					binary_header(&header, counting_map_cell_size(cmap), false);
+					if( ::fwrite(&header, sizeof(header), 1, fp) != 1 ) goto error;
+				} // <--- file header
+
+				// ---> plane header
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					cmap_binary_plane_t plane;
+					::memset(&plane, 0, sizeof(plane));
+					cmap->plane[i].pget_origin(&plane.xorg, &plane.yorg);
+					plane.rows = cmap->plane[i].row();
+					plane.columns = cmap->plane[i].column();
+					if( ::fwrite(&plane, sizeof(plane), 1, fp) != 1 ) goto error;
+				} // <--- plane header
+
+				// ---> cell data
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					for( uint32_t r = 0; r < cmap->plane[i].row(); r++ ) {
+						for( uint32_t c = 0; c < cmap->plane[i].column(); c++ ) {
+							cmap_binary_cell_t ws;
+
+							binary_cell(&ws, cmap->plane[i].pointer(r, c));
+							if( ::fwrite(&ws, sizeof(ws), 1, fp) != 1 ) goto error;
+						}
+					}
+				} // <--- cell data
+
+			done:
+				if( ::fclose(fp) != 0 ) {
+					::unlink(fname_tmp);
+					return -1;
+				}
+				return ::rename(fname_tmp, fname) == 0 ? 0 : -1;
+
+			error:
+				::fclose(fp);
+				::unlink(fname_tmp);
+				return -1;
+			} // <--- operation
+		}
+
+
+		/**
+		 * @brief get counting cell of a position, allocate if needed
+		 */
+		inline
+		count_cell_t* binary_cell_pointer( gnd::lssmap::cmap_t *cmap, size_t i, double x, double y ) {
+			count_cell_t *p;
+
+			if( !(p = cmap->plane[i].ppointer(x, y)) ) {
+				cmap->plane[i].reallocate(x, y);
+				p = cmap->plane[i].ppointer(x, y);
+			}
+			return p;
+		}
+
+		/**
+		 * @brief allocate the extent of a plane of file image and get the index of its first cell
+		 * @details the extent is allocated at the cores of the corner cells and the index offset is checked
+		 *          at both corners, so the rows of the file are mapped on the rows of the plane by index
+		 *          without converting each cell into a position
+		 * @param [in,out] cmap    : counting map
+		 * @param [in]     i       : plane index
+		 * @param [in]     xorg    : plane origin of file image
+		 * @param [in]     yorg    : plane origin of file image
+		 * @param [in]     rows    : number of rows of file image
+		 * @param [in]     columns : number of columns of file image
+		 * @param [out]    r0      : row of the first cell in the plane
+		 * @param [out]    c0      : column of the first cell in the plane
+		 */
+		inline
+		int binary_plane_offset( gnd::lssmap::cmap_t *cmap, size_t i, double xorg, double yorg,
+				uint32_t rows, uint32_t columns, uint32_t *r0, uint32_t *c0 ) {
+			const double cell = counting_map_cell_size(cmap);
+			const double x0 = xorg + 0.5 * cell;
+			const double y0 = yorg + 0.5 * cell;
+			const double x1 = xorg + (columns - 0.5) * cell;
+			const double y1 = yorg + (rows - 0.5) * cell;
+			uint32_t r1, c1;
+
+			*r0 = *c0 = 0;
+			if( rows == 0 || columns == 0 ) return 0;
+			if( !binary_cell_pointer(cmap, i, x0, y0) || !binary_cell_pointer(cmap, i, x1, y1) ) return -1;
+
+			// the first corner moves on reallocation for the other corner, get the indices after both
+			if( cmap->plane[i].pindex(x0, y0, r0, c0) < 0 || cmap->plane[i].pindex(x1, y1, &r1, &c1) < 0 ) return -1;
+			return r1 - *r0 == rows - 1 && c1 - *c0 == columns - 1 ? 0 : -1;
+		}
+
+
+		/**
+		 * @brief unpack counting map in binary format, dense (version 1) or compact (version 2) layout
+		 * @param [out] cmap : counting map (initialized in this function)
+		 * @param [in]  addr : file image
+		 * @param [in]  size : size of file image
+		 */
+		inline
+		int unpack_counting_map( gnd::lssmap::cmap_t *cmap, const void *addr, size_t size ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!addr, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				const cmap_binary_header_t *header = (const cmap_binary_header_t*) addr;
+				size_t ncells = 0;
+
+				{ // ---> validate header
+					if( size < sizeof(cmap_binary_header_t) )											return -1;
+					if( ::memcmp(header->magic, CMapBinary_magic, sizeof(header->magic)) != 0 )	return -1;
+					if( header->byte_order != CMapBinary_byte_order )							return -1;
+					if( header->nplanes != gnd::lssmap::PlaneNum )								return -1;
+				} // <--- validate header
+
+				if( header->version == CMapBinary_version ) {
+					const cmap_binary_plane_t *planes = (const cmap_binary_plane_t*) (header + 1);
+					const cmap_binary_cell_t *cells = (const cmap_binary_cell_t*) (planes + gnd::lssmap::PlaneNum);
+
+					{ // ---> validate
+						if( header->cell_bytes != sizeof(cmap_binary_cell_t) )						return -1;
+						if( size < sizeof(*header) + sizeof(*planes) * gnd::lssmap::PlaneNum )	return -1;
+						for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+							ncells += (size_t) planes[i].rows * planes[i].columns;
+						}
+						if( size != sizeof(*header) + sizeof(*planes) * gnd::lssmap::PlaneNum + sizeof(*cells) * ncells )	return -1;
+					} // <--- validate
+
+					if( gnd::lssmap::init_counting_map(cmap, header->cell_size, header->cell_size) < 0 ) return -1;
+
+					// ---> cell data
+					for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+						uint32_t r0, c0;
+
+						if( binary_plane_offset(cmap, i, planes[i].xorg, planes[i].yorg, planes[i].rows, planes[i].columns, &r0, &c0) < 0 ) {
+							gnd::lssmap::destroy_counting_map(cmap);
+							return -1;
+						}
+
+						for( uint32_t r = 0; r < planes[i].rows; r++ ) {
+							for( uint32_t c = 0; c < planes[i].columns; c++, cells++ ) {
+								count_cell_t *p;
+
+								if( cells->n == 0 ) continue;
+								if( !(p = cmap->plane[i].pointer(r0 + r, c0 + c)) ) {
+									gnd::lssmap::destroy_counting_map(cmap);
+									return -1;
+								}
+
+								p->n = cells->n;
+								p->sum[0][0] = cells->sum[0];
+								p->sum[1][0] = cells->sum[1];
+								p->sum2[0][0] = cells->sum2[0];
+								p->sum2[0][1] = cells->sum2[1];
+								p->sum2[1][0] = cells->sum2[2];
+								p->sum2[1][1] = cells->sum2[3];
+							}
+						}
+					} // <--- cell data
+					return 0;
+				}
+				else if( header->version == CMapBinary_version_compact ) {
+					const cmap_compact_plane_t *planes = (const cmap_compact_plane_t*) (header + 1);
+					const cmap_binary_wide_cell_t *wide = (const cmap_binary_wide_cell_t*) (planes + gnd::lssmap::PlaneNum);
+					const cmap_compact_cell_t *cells;
+					size_t nwide = 0;
+
+					{ // ---> validate
+						if( header->cell_bytes != sizeof(cmap_compact_cell_t) )					return -1;
+						if( size < sizeof(*header) + sizeof(*planes) * gnd::lssmap::PlaneNum )	return -1;
+						for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+							ncells += planes[i].ncompact;
+							nwide += planes[i].nwide;
+						}
+						if( size != sizeof(*header) + sizeof(*planes) * gnd::lssmap::PlaneNum + sizeof(*wide) * nwide + sizeof(*cells) * ncells )	return -1;
+					} // <--- validate
+					cells = (const cmap_compact_cell_t*) (wide + nwide);
+
+					if( gnd::lssmap::init_counting_map(cmap, header->cell_size, header->cell_size) < 0 ) return -1;
+
+					// ---> cell data
+					for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+						uint64_t ncolumns = planes[i].columns;
+						uint64_t nindex = (uint64_t) planes[i].rows * planes[i].columns;
+						uint32_t r0, c0;
+
+						if( (uint64_t) planes[i].ncompact + planes[i].nwide > 0
+								&& binary_plane_offset(cmap, i, planes[i].xorg, planes[i].yorg, planes[i].rows, planes[i].columns, &r0, &c0) < 0 ) {
+							gnd::lssmap::destroy_counting_map(cmap);
+							return -1;
+						}
+
+						for( uint64_t k = 0; k < (uint64_t) planes[i].ncompact + planes[i].nwide; k++ ) {
+							uint32_t index = k < planes[i].ncompact ? cells[k].index : wide[k - planes[i].ncompact].index;
+							count_cell_t *p;
+
+							if( index >= nindex
+									|| !(p = cmap->plane[i].pointer(r0 + (uint32_t)(index / ncolumns), c0 + (uint32_t)(index % ncolumns))) ) {
+								gnd::lssmap::destroy_counting_map(cmap);
+								return -1;
+							}
+
+							if( k < planes[i].ncompact ) {
+								// restore sums, sum2 = M2 + n mean mean^T
+								const cmap_compact_cell_t *q = cells + k;
+								double n = q->n;
+
+								p->n = q->n;
+								p->sum[0][0] = n * q->mean[0];
+								p->sum[1][0] = n * q->mean[1];
+								p->sum2[0][0] = q->m2[0] + n * q->mean[0] * q->mean[0];
+								p->sum2[0][1] = q->m2[1] + n * q->mean[0] * q->mean[1];
+								p->sum2[1][0] = p->sum2[0][1];
+								p->sum2[1][1] = q->m2[2] + n * q->mean[1] * q->mean[1];
+							}
+							else {
+								const cmap_binary_wide_cell_t *q = wide + (k - planes[i].ncompact);
+
+								p->n = q->n;
+								p->sum[0][0] = q->sum[0];
+								p->sum[1][0] = q->sum[1];
+								p->sum2[0][0] = q->sum2[0];
+								p->sum2[0][1] = q->sum2[1];
+								p->sum2[1][0] = q->sum2[1];
+								p->sum2[1][1] = q->sum2[2];
+							}
+						}
+						cells += planes[i].ncompact;
+						wide += planes[i].nwide;
+					} // <--- cell data
+					return 0;
+				}
+				return -1;
+			} // <--- operation
+		}
+
+
+		/**
+		 * @brief read counting map in binary format
+		 * @details the cells are copied from the file image into the planes allocated by gndlib
+		 *          (the file image is not used as the storage of the counting map).
+		 *          against the text format it gains a single file, no number parsing and exact doubles,
+		 *          and the compact layout stores only the counted cells
+		 * @param [out] cmap  : counting map (initialized in this function)
+		 * @param [in]  fname : file name
+		 */
+		inline
+		int read_counting_map_binary( gnd::lssmap::cmap_t *cmap, const char *fname ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!fname, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				int fd;
+				struct stat st;
+				void *addr;
+				int ret;
+
+				if( (fd = ::open(fname, O_RDONLY)) < 0 ) return -1;
+				if( ::fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(cmap_binary_header_t) ) {
+					::close(fd);
+					return -1;
+				}
+				addr = ::mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				::close(fd);
+				if( addr == MAP_FAILED ) return -1;
+				::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+				ret = unpack_counting_map(cmap, addr, st.st_size);
+				::munmap(addr, st.st_size);
+				return ret;
+			} // <--- operation
+		}
+
+
+		/**
+		 * @brief read counting map in binary (regular file) or text (directory) format
+		 * @param [out] cmap : counting map
+		 * @param [in]  path : binary file name or text file directory
+		 */
+		inline
+		int read_counting_map_any( gnd::lssmap::cmap_t *cmap, const char *path ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!path, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				struct stat st;
+				if( ::stat(path, &st) == 0 && S_ISREG(st.st_mode) ) {
+					return read_counting_map_binary(cmap, path);
+				}
+				return gnd::lssmap::read_counting_map(cmap, path);
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_CMAP_BINARY_HPP_ */
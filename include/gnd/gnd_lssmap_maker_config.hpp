@@ -9,6 +9,7 @@
 #ifndef GND_LSSMAP_MAKER_CONFIG_HPP_
 #define GND_LSSMAP_MAKER_CONFIG_HPP_
 
+#include <stdio.h>
 #include <string.h>
 
 #include "gnd/gnd-multi-math.h"
@@ -24,7 +25,11 @@ namespace gnd {
 		struct node_config;
 		typedef struct node_config node_config;
 
+		struct pointcloud_source_config;
+		typedef struct pointcloud_source_config pointcloud_source_config;
+
 		typedef gnd::conf::parameter_array<char, 256> param_string_t;
+		typedef gnd::conf::parameter_array<double, 3> param_pose_t;
 		typedef gnd::conf::param_int param_int_t;
 		typedef gnd::conf::param_long param_long_t;
 		typedef gnd::conf::param_double param_double_t;
@@ -54,11 +59,69 @@ namespace gnd {
 		static const param_string_t Default_topic_name_pointcloud = {
 				"topic-laserscan-point",
 				"foo_pointcloud",
-				"laser scan point topic, type PointCloud on robot coordinate (subscribe)"
+				"laser scan point topic, on sensor coordinate (see \"sensor-pose\") (subscribe)"
+		};
+
+		static const param_string_t Default_topic_type_pointcloud = {
+				"topic-laserscan-point-type",
+				"PointCloud",
+				"message type of laser scan point topic, \"PointCloud\" or \"PointCloud2\" (x, y and z fields of float32 or float64)"
+		};
+
+		static const param_pose_t Default_sensor_pose = {
+				"sensor-pose",
+				{ 0, 0, 0 },
+				"mounting pose of the laser scan point sensor on robot coordinate, x(m), y(m) and theta(deg)"
 		};
 		// <--- ros communication
 
 
+		// ---> additional point-cloud source
+		/// maximum number of point-cloud sources (source 0 is "topic-laserscan-point", sources 1 to 3 are "source<i>-...").
+		/// all the sources are associated in turn on the one main loop thread, only the counting runs on the integration threads
+		static const int PointCloud_sources_max = 4;
+
+		/// item name prefix of additional point-cloud source i (1, 2, ...)
+		static const char PointCloud_source_item_format[] = "source%d-%s";
+
+		static const param_string_t Default_source_topic_name_pointcloud = {
+				"topic-laserscan-point",
+				"",
+				"additional laser scan point topic, on sensor coordinate (subscribe). [note] if this parameter is null, the source is not used. up to 3 additional sources (source1 to source3), associated on the main loop thread"
+		};
+
+		static const param_string_t Default_source_topic_type_pointcloud = {
+				"topic-laserscan-point-type",
+				"PointCloud",
+				"message type of additional laser scan point topic, \"PointCloud\" or \"PointCloud2\""
+		};
+
+		static const param_pose_t Default_source_sensor_pose = {
+				"sensor-pose",
+				{ 0, 0, 0 },
+				"mounting pose of additional laser scan point sensor on robot coordinate, x(m), y(m) and theta(deg)"
+		};
+
+		static const param_double_t Default_source_ignore_range_lower = {
+				"collect-condition-ignore-range-lower",
+				gnd_cm2m(20),
+				"ignore laser scan data of additional source (m)"
+		};
+
+		static const param_double_t Default_source_ignore_range_upper = {
+				"collect-condition-ignore-range-upper",
+				-1,
+				"ignore laser scan data of additional source (m)"
+		};
+
+		static const param_double_t Default_source_culling_distance = {
+				"collect-condition-culling-distance",
+				gnd_cm2m(5),
+				"distance condition to ignore data in laser scan data counting of additional source (m)"
+		};
+		// <--- additional point-cloud source
+
+
 		// ---> map option
 		static const param_string_t Default_initial_counting_map = {
 				"initial-counting-map-directory",
@@ -67,18 +130,60 @@ namespace gnd {
 		};
 
 
+		static const param_bool_t Default_counting_map_binary = {
+				"counting-map-binary",
+				false,
+				"file out counting map in binary format (counting-map.cmap) instead of text files. [note] \"initial-counting-map-directory\" accepts both, a binary file or a text file directory"
+		};
+
+		static const param_bool_t Default_counting_map_compact = {
+				"counting-map-compact",
+				false,
+				"compact cell layout (32 bit count, float mean and M2, counted cells only) for binary counting map, checkpoint and evicted tiles. tiles in memory keep exact cells. [note] implies \"counting-map-binary\""
+		};
+
+		static const param_double_t Default_counting_map_tile_size = {
+				"counting-map-tile-size",
+				0,
+				"tile size of sparse counting map (m). tiles are allocated where points are counted, so the memory is proportional to the observed area. [note] if this value is less than or equal 0, the counting map is a single tile"
+		};
+
+		static const param_int_t Default_counting_map_tile_cache = {
+				"counting-map-tile-cache",
+				0,
+				"maximum number of counting map tiles in memory. least recently used tiles are evicted to \"counting-map-tile-swap-directory\", or packed in memory if it is null. [note] if this value is less than or equal 0, tiles are not evicted"
+		};
+
+		static const param_string_t Default_counting_map_tile_swap_directory = {
+				"counting-map-tile-swap-directory",
+				"/tmp",
+				"directory to evict counting map tiles"
+		};
+
 		static const param_double_t Default_counting_map_cell_size = {
 				"counting-map-cell-size",
 				gnd_cm2m(80),
 				"cell size for counting to calculate variance and means (m)"
 		};
 
+		static const param_int_t Default_counting_map_pyramid_levels = {
+				"counting-map-pyramid-levels",
+				0,
+				"number of coarser counting map levels. level l has cell size x 2^l, is reduced from level l-1 (not counted again) and written in \"level<l>\" directory. [note] if this value is less than or equal 0, no level is written"
+		};
+
 		static const param_double_t Default_image_map_pixel_size = {
 				"image-map-pixel-size",
 				gnd_cm2m(10),
 				"image map pixel size (m)"
 		};
 
+		static const param_int_t Default_image_map_band_rows = {
+				"image-map-band-rows",
+				0,
+				"pixel rows of a band to rasterize and write the image map band by band (memory is bounded by band x \"map-build-threads\"), same scale as the whole image. [note] if this value is less than or equal 0, the whole image is built"
+		};
+
 		static const param_double_t Default_additional_smoothing_parameter = {
 				"additional-smoothing-parameter",
 				100,
@@ -113,6 +218,12 @@ namespace gnd {
 				"distance condition to ignore data in laser scan data counting (m)"
 		};
 
+		static const param_double_t Default_collect_condition_grid_size = {
+				"collect-condition-grid-size",
+				0,
+				"grid size to count at most one point per grid cell in a laser scan (m), applied after the culling distance. [note] if this value is less than or equal 0, not decimate on the grid"
+		};
+
 		static const param_double_t Default_collect_condition_moving_distance = {
 				"collect-condition-moving-distance",
 				gnd_cm2m(5),
@@ -130,10 +241,140 @@ namespace gnd {
 				0,
 				"data collect condition (sec), [note] if this parameter is <=0, not collect data under the time condition"
 		};
+
+		static const param_double_t Default_pose_interpolation_max_gap = {
+				"pose-interpolation-max-gap",
+				0.5,
+				"maximum time between the poses before and after a point-cloud to interpolate the pose at the point-cloud time (sec)"
+		};
+
+		static const param_double_t Default_pose_extrapolation_limit = {
+				"pose-extrapolation-limit",
+				0,
+				"maximum time to extrapolate the pose after the latest pose (sec). a point-cloud waits for the next pose this time at most. [note] if this value is less than or equal 0, wait for the next pose"
+		};
 		// <--- data collect option
 
 
 
+		// ---> operation option
+		static const param_int_t Default_integration_threads = {
+				"integration-threads",
+				1,
+				"number of threads to integrate point-cloud into counting map. [note] default 1 integrates on the main loop thread. pose association of all the sources always runs serially on the main loop thread"
+		};
+
+		static const param_double_t Default_shard_merge_cycle = {
+				"shard-merge-cycle",
+				10,
+				"cycle to merge counting map shards of integration threads into counting map (sec)"
+		};
+
+		static const param_int_t Default_map_build_threads = {
+				"map-build-threads",
+				1,
+				"number of threads to build the statistics map from the counting map tiles. [note] if this value is less than or equal 1, build on one thread"
+		};
+
+		static const param_int_t Default_pose_queue_depth = {
+				"pose-queue-depth",
+				1000,
+				"pose subscriber queue depth and pose buffer size"
+		};
+
+		static const param_int_t Default_pointcloud_queue_depth = {
+				"pointcloud-queue-depth",
+				200,
+				"point-cloud subscriber queue depth and point-cloud ring buffer size. [note] a point-cloud received on a full buffer is dropped and counted"
+		};
+
+		static const param_int_t Default_pointcloud_points_reserve = {
+				"pointcloud-points-reserve",
+				32768,
+				"number of points reserved per point-cloud ring buffer slot for the copy on \"downsample\" overload policy (not reserved on other policies). [note] a larger point-cloud is shed on overload, 0: the storage grows on demand"
+		};
+
+		static const param_int_t Default_worker_queue_depth = {
+				"worker-queue-depth",
+				16,
+				"maximum number of queued point-clouds per integration thread. the main loop blocks on a full queue"
+		};
+
+		static const param_string_t Default_overload_policy = {
+				"overload-policy",
+				"none",
+				"policy to shed load on overload, \"none\", \"drop-oldest\" (drop the oldest point-clouds until the overload is resolved), \"decimate\" (integrate one of \"overload-ratio\" point-clouds) or \"downsample\" (integrate one of \"overload-ratio\" points per point-cloud)"
+		};
+
+		static const param_int_t Default_overload_backlog = {
+				"overload-backlog",
+				0,
+				"number of waiting point-clouds (ring buffer and integration queues) to detect overload. [note] if this value is less than or equal 0, the backlog is not checked"
+		};
+
+		static const param_double_t Default_overload_age = {
+				"overload-age",
+				0,
+				"point-cloud age (now - time stamp) to detect overload (sec). [note] if this value is less than or equal 0, the age is not checked"
+		};
+
+		static const param_int_t Default_overload_ratio = {
+				"overload-ratio",
+				2,
+				"decimation ratio of \"decimate\" and \"downsample\" overload policy"
+		};
+
+		static const param_double_t Default_live_map_cycle = {
+				"live-map-cycle",
+				0,
+				"cycle to rebuild the statistics map on the tiles counted since the last rebuild and file out it into \"live-map-directory\" (sec). [note] if this value is less than or equal 0, the map is built only at the end"
+		};
+
+		static const param_string_t Default_live_map_directory = {
+				"live-map-directory",
+				"./live",
+				"output directory of live map"
+		};
+
+		static const param_double_t Default_live_map_publish_cycle = {
+				"live-map-publish-cycle",
+				0,
+				"cycle to publish live map (sec). the first message is the whole map, then only the changed cells are sent. [note] requires \"live-map-cycle\" and a positive \"counting-map-tile-size\". if this value is less than or equal 0, the map is not published"
+		};
+
+		static const param_string_t Default_topic_name_live_map = {
+				"topic-live-map",
+				"lssmap",
+				"live map topic (nav_msgs/OccupancyGrid), the changed cells are on \"<topic>_updates\" (map_msgs/OccupancyGridUpdate) (publish)"
+		};
+
+		static const param_string_t Default_live_map_frame_id = {
+				"live-map-frame-id",
+				"map",
+				"frame id of live map topic"
+		};
+
+		static const param_double_t Default_checkpoint_cycle = {
+				"checkpoint-cycle",
+				0,
+				"cycle to write checkpoint of counting map in background (sec). [note] if this value is less than or equal 0, don't write checkpoint"
+		};
+
+		static const param_string_t Default_checkpoint_file = {
+				"checkpoint-file",
+				"checkpoint",
+				"checkpoint directory, a binary counting map file per tile. only the tiles counted since the previous checkpoint are written"
+		};
+
+		static const param_bool_t Default_checkpoint_resume = {
+				"checkpoint-resume",
+				false,
+				"resume from checkpoint. if \"checkpoint-file\" exists, it is read as the initial counting map instead of \"initial-counting-map-directory\" (it already includes the initial counting map of the previous run)"
+		};
+		// <--- operation option
+
+
+
 		// ---> debug condition
 		static const param_double_t Default_cycle_status_display = {
 				"cycle-cui-status-display",
@@ -146,6 +387,24 @@ namespace gnd {
 				"",
 				"text log file name. this file collect point cloud data. [note] if this parameter is null, the file is not created."
 		};
+
+		static const param_bool_t Default_text_log_binary = {
+				"text-log-binary",
+				false,
+				"write \"text-log\" in binary records (scan sequence id, pose and counted points) instead of text lines"
+		};
+
+		static const param_string_t Default_stats_file = {
+				"stats-file",
+				"",
+				"statistics file name. per-stage latency histograms, scan age, drop counters and throughput are written in json. [note] if this parameter is null, the file is not created."
+		};
+
+		static const param_double_t Default_stats_cycle = {
+				"stats-cycle",
+				1.0,
+				"cycle to write \"stats-file\" [sec]"
+		};
 		// <--- debug condition
 	}
 }
@@ -190,6 +449,14 @@ namespace gnd {
 		 * @param [in]   src : parameter
 		 */
 		int set_node_config( gnd::conf::configuration *dest, node_config *src );
+
+		/**
+		 * @brief parameters of a point-cloud source
+		 * @param [in]  conf  : configuration parameter
+		 * @param [in]  i     : source index (0: "topic-laserscan-point")
+		 * @param [out] dest  : source parameters
+		 */
+		int get_pointcloud_source( const node_config *conf, int i, pointcloud_source_config *dest );
 	}
 }
 // ---> function declaration
@@ -199,6 +466,18 @@ namespace gnd {
 // ---> type definition
 namespace gnd {
 	namespace lssmap_maker {
+		/**
+		 * @brief configuration parameter of a point-cloud source
+		 */
+		struct pointcloud_source_config {
+			param_string_t topic_name_pointcloud;				///< pointcloud topic name (null: not used)
+			param_string_t topic_type_pointcloud;				///< pointcloud topic message type
+			param_pose_t sensor_pose;							///< sensor mounting pose on robot coordinate (x, y, theta)
+			param_double_t ignore_range_lower;					///< ignore range
+			param_double_t ignore_range_upper;					///< ignore upper
+			param_double_t culling_distance;					///< culling distance
+		};
+
 		/**
 		 * @brief configuration parameter for gnd_urg_proxy node
 		 */
@@ -209,22 +488,58 @@ namespace gnd {
 			param_string_t node_name;							///< node name for ros communication
 			param_string_t topic_name_pose;						///< pose topic name for ros communication
 			param_string_t topic_name_pointcloud;				///< pointcloud topic name for ros communication
+			param_string_t topic_type_pointcloud;				///< pointcloud topic message type
+			param_pose_t sensor_pose;							///< sensor mounting pose on robot coordinate (x, y, theta)
+			pointcloud_source_config pointcloud_source[PointCloud_sources_max - 1];	///< additional point-cloud sources
 			// map make option
 			param_string_t initial_counting_map;				///< initial counting map
+			param_bool_t counting_map_binary;					///< counting map binary format
+			param_bool_t counting_map_compact;					///< counting map compact cell layout
+			param_double_t counting_map_tile_size;				///< counting map tile size
+			param_int_t counting_map_tile_cache;				///< number of counting map tiles in memory
+			param_string_t counting_map_tile_swap_directory;	///< directory to evict counting map tiles
 			param_double_t counting_map_cell_size;				///< counting cell size
+			param_int_t counting_map_pyramid_levels;			///< number of coarser counting map levels
 			param_double_t image_map_pixel_size;				///< image map pixel size
+			param_int_t image_map_band_rows;					///< image map band rows
 			param_double_t additional_smoothing_parameter;		///< additional smoothing parameter
 			param_double_t sensor_range;						///< sensor range
 			// data collect option
 			param_double_t collect_condition_ignore_range_lower;///< ignore range
 			param_double_t collect_condition_ignore_range_upper;///< ignore upper
 			param_double_t collect_condition_culling_distance;	///< culling distance
+			param_double_t collect_condition_grid_size;			///< grid decimation size
 			param_double_t collect_condition_moving_distance;	///< data collect condition (moving distance)
 			param_double_t collect_condition_moving_angle;		///< data collect condition (moving angle)
 			param_double_t collect_condition_time;				///< data collect condition (time)
+			param_double_t pose_interpolation_max_gap;			///< maximum time between poses to interpolate
+			param_double_t pose_extrapolation_limit;			///< maximum time to extrapolate pose
+			// operation option
+			param_int_t integration_threads;					///< number of integration threads
+			param_double_t shard_merge_cycle;					///< cycle to merge counting map shards
+			param_int_t map_build_threads;						///< number of map build threads
+			param_int_t pose_queue_depth;						///< pose queue depth
+			param_int_t pointcloud_queue_depth;					///< point-cloud queue depth
+			param_int_t pointcloud_points_reserve;				///< number of points reserved per point-cloud slot
+			param_int_t worker_queue_depth;						///< integration thread queue depth
+			param_string_t overload_policy;						///< overload policy
+			param_int_t overload_backlog;						///< backlog to detect overload
+			param_double_t overload_age;						///< point-cloud age to detect overload
+			param_int_t overload_ratio;							///< overload decimation ratio
+			param_double_t live_map_cycle;						///< cycle to rebuild live map
+			param_string_t live_map_directory;					///< live map output directory
+			param_double_t live_map_publish_cycle;				///< cycle to publish live map
+			param_string_t topic_name_live_map;					///< live map topic name
+			param_string_t live_map_frame_id;					///< live map frame id
+			param_double_t checkpoint_cycle;					///< cycle to write checkpoint
+			param_string_t checkpoint_file;						///< checkpoint directory
+			param_bool_t checkpoint_resume;						///< resume from checkpoint
 			// debug option
 			param_double_t cycle_cui_status_display;			///< cui status display mode
 			param_string_t text_log;							///< text log file name
+			param_bool_t text_log_binary;						///< text log binary format
+			param_string_t stats_file;							///< statistics file name
+			param_double_t stats_cycle;							///< statistics file cycle
 		};
 
 
@@ -253,21 +568,73 @@ namespace gnd {
 			memcpy( &p->node_name,								&Default_node_name,								sizeof(Default_node_name) );
 			memcpy( &p->topic_name_pose,						&Default_topic_name_pose,						sizeof(Default_topic_name_pose) );
 			memcpy( &p->topic_name_pointcloud,					&Default_topic_name_pointcloud,					sizeof(Default_topic_name_pointcloud) );
+			memcpy( &p->topic_type_pointcloud,					&Default_topic_type_pointcloud,					sizeof(Default_topic_type_pointcloud) );
+			memcpy( &p->sensor_pose,							&Default_sensor_pose,							sizeof(Default_sensor_pose) );
+			for( int i = 0; i < PointCloud_sources_max - 1; i++ ) {
+				pointcloud_source_config *src = &p->pointcloud_source[i];
+
+				memcpy( &src->topic_name_pointcloud,			&Default_source_topic_name_pointcloud,			sizeof(Default_source_topic_name_pointcloud) );
+				memcpy( &src->topic_type_pointcloud,			&Default_source_topic_type_pointcloud,			sizeof(Default_source_topic_type_pointcloud) );
+				memcpy( &src->sensor_pose,						&Default_source_sensor_pose,					sizeof(Default_source_sensor_pose) );
+				memcpy( &src->ignore_range_lower,				&Default_source_ignore_range_lower,				sizeof(Default_source_ignore_range_lower) );
+				memcpy( &src->ignore_range_upper,				&Default_source_ignore_range_upper,				sizeof(Default_source_ignore_range_upper) );
+				memcpy( &src->culling_distance,					&Default_source_culling_distance,				sizeof(Default_source_culling_distance) );
+				// item name "source<i + 1>-..."
+				::snprintf( src->topic_name_pointcloud.item, sizeof(src->topic_name_pointcloud.item), PointCloud_source_item_format, i + 1, Default_source_topic_name_pointcloud.item );
+				::snprintf( src->topic_type_pointcloud.item, sizeof(src->topic_type_pointcloud.item), PointCloud_source_item_format, i + 1, Default_source_topic_type_pointcloud.item );
+				::snprintf( src->sensor_pose.item, sizeof(src->sensor_pose.item), PointCloud_source_item_format, i + 1, Default_source_sensor_pose.item );
+				::snprintf( src->ignore_range_lower.item, sizeof(src->ignore_range_lower.item), PointCloud_source_item_format, i + 1, Default_source_ignore_range_lower.item );
+				::snprintf( src->ignore_range_upper.item, sizeof(src->ignore_range_upper.item), PointCloud_source_item_format, i + 1, Default_source_ignore_range_upper.item );
+				::snprintf( src->culling_distance.item, sizeof(src->culling_distance.item), PointCloud_source_item_format, i + 1, Default_source_culling_distance.item );
+			}
 			// map make option
 			memcpy( &p->initial_counting_map,					&Default_initial_counting_map,					sizeof(Default_initial_counting_map) );
+			memcpy( &p->counting_map_binary,					&Default_counting_map_binary,					sizeof(Default_counting_map_binary) );
+			memcpy( &p->counting_map_compact,					&Default_counting_map_compact,					sizeof(Default_counting_map_compact) );
+			memcpy( &p->counting_map_tile_size,					&Default_counting_map_tile_size,				sizeof(Default_counting_map_tile_size) );
+			memcpy( &p->counting_map_tile_cache,				&Default_counting_map_tile_cache,				sizeof(Default_counting_map_tile_cache) );
+			memcpy( &p->counting_map_tile_swap_directory,		&Default_counting_map_tile_swap_directory,		sizeof(Default_counting_map_tile_swap_directory) );
 			memcpy( &p->counting_map_cell_size,					&Default_counting_map_cell_size,				sizeof(Default_counting_map_cell_size) );
+			memcpy( &p->counting_map_pyramid_levels,			&Default_counting_map_pyramid_levels,			sizeof(Default_counting_map_pyramid_levels) );
 			memcpy( &p->image_map_pixel_size,					&Default_image_map_pixel_size,					sizeof(Default_image_map_pixel_size) );
+			memcpy( &p->image_map_band_rows,					&Default_image_map_band_rows,					sizeof(Default_image_map_band_rows) );
 			memcpy( &p->additional_smoothing_parameter,			&Default_additional_smoothing_parameter,		sizeof(Default_additional_smoothing_parameter) );
 			memcpy( &p->sensor_range,							&Default_sensor_range,							sizeof(Default_sensor_range) );
 			memcpy( &p->collect_condition_ignore_range_lower,	&Default_collect_condition_ignore_range_lower,	sizeof(Default_collect_condition_ignore_range_lower) );
 			memcpy( &p->collect_condition_ignore_range_upper,	&Default_collect_condition_ignore_range_upper,	sizeof(Default_collect_condition_ignore_range_upper) );
 			memcpy( &p->collect_condition_culling_distance,		&Default_collect_condition_culling_distance,	sizeof(Default_collect_condition_culling_distance) );
+			memcpy( &p->collect_condition_grid_size,			&Default_collect_condition_grid_size,			sizeof(Default_collect_condition_grid_size) );
 			memcpy( &p->collect_condition_moving_distance,		&Default_collect_condition_moving_distance,		sizeof(Default_collect_condition_moving_distance) );
 			memcpy( &p->collect_condition_moving_angle,			&Default_collect_condition_moving_angle,		sizeof(Default_collect_condition_moving_angle) );
 			memcpy( &p->collect_condition_time,					&Default_collect_condition_time,				sizeof(Default_collect_condition_time) );
+			memcpy( &p->pose_interpolation_max_gap,				&Default_pose_interpolation_max_gap,			sizeof(Default_pose_interpolation_max_gap) );
+			memcpy( &p->pose_extrapolation_limit,				&Default_pose_extrapolation_limit,				sizeof(Default_pose_extrapolation_limit) );
+			// operation option
+			memcpy( &p->integration_threads,					&Default_integration_threads,					sizeof(Default_integration_threads) );
+			memcpy( &p->shard_merge_cycle,						&Default_shard_merge_cycle,						sizeof(Default_shard_merge_cycle) );
+			memcpy( &p->map_build_threads,						&Default_map_build_threads,						sizeof(Default_map_build_threads) );
+			memcpy( &p->pose_queue_depth,						&Default_pose_queue_depth,						sizeof(Default_pose_queue_depth) );
+			memcpy( &p->pointcloud_queue_depth,					&Default_pointcloud_queue_depth,				sizeof(Default_pointcloud_queue_depth) );
+			memcpy( &p->pointcloud_points_reserve,				&Default_pointcloud_points_reserve,				sizeof(Default_pointcloud_points_reserve) );
+			memcpy( &p->worker_queue_depth,						&Default_worker_queue_depth,					sizeof(Default_worker_queue_depth) );
+			memcpy( &p->overload_policy,						&Default_overload_policy,						sizeof(Default_overload_policy) );
+			memcpy( &p->overload_backlog,						&Default_overload_backlog,						sizeof(Default_overload_backlog) );
+			memcpy( &p->overload_age,							&Default_overload_age,							sizeof(Default_overload_age) );
+			memcpy( &p->overload_ratio,							&Default_overload_ratio,						sizeof(Default_overload_ratio) );
+			memcpy( &p->live_map_cycle,							&Default_live_map_cycle,						sizeof(Default_live_map_cycle) );
+			memcpy( &p->live_map_directory,						&Default_live_map_directory,					sizeof(Default_live_map_directory) );
+			memcpy( &p->live_map_publish_cycle,					&Default_live_map_publish_cycle,				sizeof(Default_live_map_publish_cycle) );
+			memcpy( &p->topic_name_live_map,					&Default_topic_name_live_map,					sizeof(Default_topic_name_live_map) );
+			memcpy( &p->live_map_frame_id,						&Default_live_map_frame_id,						sizeof(Default_live_map_frame_id) );
+			memcpy( &p->checkpoint_cycle,						&Default_checkpoint_cycle,						sizeof(Default_checkpoint_cycle) );
+			memcpy( &p->checkpoint_file,						&Default_checkpoint_file,						sizeof(Default_checkpoint_file) );
+			memcpy( &p->checkpoint_resume,						&Default_checkpoint_resume,						sizeof(Default_checkpoint_resume) );
 			// debug option
 			memcpy( &p->cycle_cui_status_display,				&Default_cycle_status_display,					sizeof(Default_cycle_status_display) );
 			memcpy( &p->text_log,								&Default_text_log,								sizeof(Default_text_log) );
+			memcpy( &p->text_log_binary,						&Default_text_log_binary,						sizeof(Default_text_log_binary) );
+			memcpy( &p->stats_file,								&Default_stats_file,							sizeof(Default_stats_file) );
+			memcpy( &p->stats_cycle,							&Default_stats_cycle,							sizeof(Default_stats_cycle) );
 
 			return 0;
 		}
@@ -305,24 +672,73 @@ namespace gnd {
 			gnd::conf::get_parameter( src, &dest->node_name );
 			gnd::conf::get_parameter( src, &dest->topic_name_pose );
 			gnd::conf::get_parameter( src, &dest->topic_name_pointcloud );
+			gnd::conf::get_parameter( src, &dest->topic_type_pointcloud );
+			if( gnd::conf::get_parameter( src, &dest->sensor_pose ) >= 0 ) {
+				dest->sensor_pose.value[2] = gnd_deg2ang(dest->sensor_pose.value[2]);
+			}
+			for( int i = 0; i < PointCloud_sources_max - 1; i++ ) {
+				pointcloud_source_config *p = &dest->pointcloud_source[i];
+
+				gnd::conf::get_parameter( src, &p->topic_name_pointcloud );
+				gnd::conf::get_parameter( src, &p->topic_type_pointcloud );
+				if( gnd::conf::get_parameter( src, &p->sensor_pose ) >= 0 ) {
+					p->sensor_pose.value[2] = gnd_deg2ang(p->sensor_pose.value[2]);
+				}
+				gnd::conf::get_parameter( src, &p->ignore_range_lower );
+				gnd::conf::get_parameter( src, &p->ignore_range_upper );
+				gnd::conf::get_parameter( src, &p->culling_distance );
+			}
 			// map maker option
 			gnd::conf::get_parameter( src, &dest->initial_counting_map );
+			gnd::conf::get_parameter( src, &dest->counting_map_binary );
+			gnd::conf::get_parameter( src, &dest->counting_map_compact );
+			gnd::conf::get_parameter( src, &dest->counting_map_tile_size );
+			gnd::conf::get_parameter( src, &dest->counting_map_tile_cache );
+			gnd::conf::get_parameter( src, &dest->counting_map_tile_swap_directory );
 			gnd::conf::get_parameter( src, &dest->counting_map_cell_size );
+			gnd::conf::get_parameter( src, &dest->counting_map_pyramid_levels );
 			gnd::conf::get_parameter( src, &dest->image_map_pixel_size );
+			gnd::conf::get_parameter( src, &dest->image_map_band_rows );
 			gnd::conf::get_parameter( src, &dest->additional_smoothing_parameter );
 			gnd::conf::get_parameter( src, &dest->sensor_range );
 			// data collect option
 			gnd::conf::get_parameter( src, &dest->collect_condition_ignore_range_lower );
 			gnd::conf::get_parameter( src, &dest->collect_condition_ignore_range_upper );
 			gnd::conf::get_parameter( src, &dest->collect_condition_culling_distance );
+			gnd::conf::get_parameter( src, &dest->collect_condition_grid_size );
 			gnd::conf::get_parameter( src, &dest->collect_condition_moving_distance );
 			if( gnd::conf::get_parameter( src, &dest->collect_condition_moving_angle ) >= 0) {
 				dest->collect_condition_moving_angle.value = gnd_deg2ang(dest->collect_condition_moving_angle.value);
 			}
 			gnd::conf::get_parameter( src, &dest->collect_condition_time );
+			gnd::conf::get_parameter( src, &dest->pose_interpolation_max_gap );
+			gnd::conf::get_parameter( src, &dest->pose_extrapolation_limit );
+			// operation option
+			gnd::conf::get_parameter( src, &dest->integration_threads );
+			gnd::conf::get_parameter( src, &dest->shard_merge_cycle );
+			gnd::conf::get_parameter( src, &dest->map_build_threads );
+			gnd::conf::get_parameter( src, &dest->pose_queue_depth );
+			gnd::conf::get_parameter( src, &dest->pointcloud_queue_depth );
+			gnd::conf::get_parameter( src, &dest->pointcloud_points_reserve );
+			gnd::conf::get_parameter( src, &dest->worker_queue_depth );
+			gnd::conf::get_parameter( src, &dest->overload_policy );
+			gnd::conf::get_parameter( src, &dest->overload_backlog );
+			gnd::conf::get_parameter( src, &dest->overload_age );
+			gnd::conf::get_parameter( src, &dest->overload_ratio );
+			gnd::conf::get_parameter( src, &dest->live_map_cycle );
+			gnd::conf::get_parameter( src, &dest->live_map_directory );
+			gnd::conf::get_parameter( src, &dest->live_map_publish_cycle );
+			gnd::conf::get_parameter( src, &dest->topic_name_live_map );
+			gnd::conf::get_parameter( src, &dest->live_map_frame_id );
+			gnd::conf::get_parameter( src, &dest->checkpoint_cycle );
+			gnd::conf::get_parameter( src, &dest->checkpoint_file );
+			gnd::conf::get_parameter( src, &dest->checkpoint_resume );
 			// debug option
 			gnd::conf::get_parameter( src, &dest->cycle_cui_status_display );
 			gnd::conf::get_parameter( src, &dest->text_log );
+			gnd::conf::get_parameter( src, &dest->text_log_binary );
+			gnd::conf::get_parameter( src, &dest->stats_file );
+			gnd::conf::get_parameter( src, &dest->stats_cycle );
 
 			return 0;
 		}
@@ -362,16 +778,46 @@ namespace gnd {
 			gnd::conf::set_parameter( dest, &src->node_name );
 			gnd::conf::set_parameter( dest, &src->topic_name_pose );
 			gnd::conf::set_parameter( dest, &src->topic_name_pointcloud );
+			gnd::conf::set_parameter( dest, &src->topic_type_pointcloud );
+			{
+				param_pose_t ws;
+				memcpy(&ws, &src->sensor_pose, sizeof(ws));
+				ws.value[2] = gnd_ang2deg(ws.value[2]);
+				gnd::conf::set_parameter( dest, &ws );
+			}
+			for( int i = 0; i < PointCloud_sources_max - 1; i++ ) {
+				pointcloud_source_config *p = &src->pointcloud_source[i];
+
+				gnd::conf::set_parameter( dest, &p->topic_name_pointcloud );
+				gnd::conf::set_parameter( dest, &p->topic_type_pointcloud );
+				{
+					param_pose_t ws;
+					memcpy(&ws, &p->sensor_pose, sizeof(ws));
+					ws.value[2] = gnd_ang2deg(ws.value[2]);
+					gnd::conf::set_parameter( dest, &ws );
+				}
+				gnd::conf::set_parameter( dest, &p->ignore_range_lower );
+				gnd::conf::set_parameter( dest, &p->ignore_range_upper );
+				gnd::conf::set_parameter( dest, &p->culling_distance );
+			}
 			// map maker option
 			gnd::conf::set_parameter( dest, &src->initial_counting_map );
+			gnd::conf::set_parameter( dest, &src->counting_map_binary );
+			gnd::conf::set_parameter( dest, &src->counting_map_compact );
+			gnd::conf::set_parameter( dest, &src->counting_map_tile_size );
+			gnd::conf::set_parameter( dest, &src->counting_map_tile_cache );
+			gnd::conf::set_parameter( dest, &src->counting_map_tile_swap_directory );
 			gnd::conf::set_parameter( dest, &src->counting_map_cell_size );
+			gnd::conf::set_parameter( dest, &src->counting_map_pyramid_levels );
 			gnd::conf::set_parameter( dest, &src->image_map_pixel_size );
+			gnd::conf::set_parameter( dest, &src->image_map_band_rows );
 			gnd::conf::set_parameter( dest, &src->additional_smoothing_parameter );
 			gnd::conf::set_parameter( dest, &src->sensor_range );
 			// data collect option
 			gnd::conf::set_parameter( dest, &src->collect_condition_ignore_range_lower );
 			gnd::conf::set_parameter( dest, &src->collect_condition_ignore_range_upper );
 			gnd::conf::set_parameter( dest, &src->collect_condition_culling_distance );
+			gnd::conf::set_parameter( dest, &src->collect_condition_grid_size );
 			gnd::conf::set_parameter( dest, &src->collect_condition_moving_distance );
 			{
 				param_double_t ws;
@@ -380,10 +826,60 @@ namespace gnd {
 				gnd::conf::set_parameter( dest, &ws );
 			}
 			gnd::conf::set_parameter( dest, &src->collect_condition_time );
+			gnd::conf::set_parameter( dest, &src->pose_interpolation_max_gap );
+			gnd::conf::set_parameter( dest, &src->pose_extrapolation_limit );
+			// operation option
+			gnd::conf::set_parameter( dest, &src->integration_threads );
+			gnd::conf::set_parameter( dest, &src->shard_merge_cycle );
+			gnd::conf::set_parameter( dest, &src->map_build_threads );
+			gnd::conf::set_parameter( dest, &src->pose_queue_depth );
+			gnd::conf::set_parameter( dest, &src->pointcloud_queue_depth );
+			gnd::conf::set_parameter( dest, &src->pointcloud_points_reserve );
+			gnd::conf::set_parameter( dest, &src->worker_queue_depth );
+			gnd::conf::set_parameter( dest, &src->overload_policy );
+			gnd::conf::set_parameter( dest, &src->overload_backlog );
+			gnd::conf::set_parameter( dest, &src->overload_age );
+			gnd::conf::set_parameter( dest, &src->overload_ratio );
+			gnd::conf::set_parameter( dest, &src->live_map_cycle );
+			gnd::conf::set_parameter( dest, &src->live_map_directory );
+			gnd::conf::set_parameter( dest, &src->live_map_publish_cycle );
+			gnd::conf::set_parameter( dest, &src->topic_name_live_map );
+			gnd::conf::set_parameter( dest, &src->live_map_frame_id );
+			gnd::conf::set_parameter( dest, &src->checkpoint_cycle );
+			gnd::conf::set_parameter( dest, &src->checkpoint_file );
+			gnd::conf::set_parameter( dest, &src->checkpoint_resume );
 			// debug option
 			gnd::conf::set_parameter( dest, &src->cycle_cui_status_display );
 			gnd::conf::set_parameter( dest, &src->text_log );
+			gnd::conf::set_parameter( dest, &src->text_log_binary );
+			gnd::conf::set_parameter( dest, &src->stats_file );
+			gnd::conf::set_parameter( dest, &src->stats_cycle );
+
+			return 0;
+		}
+
+		/*
+		 * @brief parameters of a point-cloud source
+		 * @param [in]  conf : configuration parameter
+		 * @param [in]  i    : source index (0: "topic-laserscan-point" and "collect-condition-..." items)
+		 * @param [out] dest : source parameters
+		 */
+		inline
+		int get_pointcloud_source( const node_config *conf, int i, pointcloud_source_config *dest ) {
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(i < 0 || i >= PointCloud_sources_max, -1, "out of range\n" );
 
+			if( i > 0 ) {
+				memcpy( dest, &conf->pointcloud_source[i - 1], sizeof(*dest) );
+				return 0;
+			}
+			memcpy( &dest->topic_name_pointcloud,	&conf->topic_name_pointcloud,					sizeof(dest->topic_name_pointcloud) );
+			memcpy( &dest->topic_type_pointcloud,	&conf->topic_type_pointcloud,					sizeof(dest->topic_type_pointcloud) );
+			memcpy( &dest->sensor_pose,				&conf->sensor_pose,								sizeof(dest->sensor_pose) );
+			memcpy( &dest->ignore_range_lower,		&conf->collect_condition_ignore_range_lower,	sizeof(dest->ignore_range_lower) );
+			memcpy( &dest->ignore_range_upper,		&conf->collect_condition_ignore_range_upper,	sizeof(dest->ignore_range_upper) );
+			memcpy( &dest->culling_distance,		&conf->collect_condition_culling_distance,		sizeof(dest->culling_distance) );
 			return 0;
 		}
 
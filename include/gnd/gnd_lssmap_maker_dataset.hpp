@@ -0,0 +1,241 @@
+/*
+ * gnd_lssmap_maker_dataset.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: recorded pose / point-cloud DATASET (text dump) for offline map making
+ */
+
+#ifndef GND_LSSMAP_MAKER_DATASET_HPP_
+#define GND_LSSMAP_MAKER_DATASET_HPP_
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+
+/*
+ * dataset text dump format
+ *  - one record per line, '#' starts a comment line
+ *  - pose record        : "p <seq> <stamp> <x> <y> <theta>"
+ *  - point-cloud record : "s <seq> <stamp> <n>" followed by n lines of "<x> <y> <z>" on robot coordinate
+ *  - stamp is in seconds, theta is in radian
+ */
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct point3d;
+		typedef struct point3d point3d_t;
+
+		struct scan_header;
+		typedef struct scan_header scan_header_t;
+
+		class dataset_reader;
+
+		inline bool pose_stamp_less( const pose2d_t &a, const pose2d_t &b );
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief point on robot coordinate
+		 */
+		struct point3d {
+			float x;	///< x (m)
+			float y;	///< y (m)
+			float z;	///< z (m)
+		};
+
+		/**
+		 * @brief point-cloud header
+		 */
+		struct scan_header {
+			uint32_t seq;		///< sequence id
+			double stamp;		///< time stamp (sec)
+			uint32_t n;			///< number of points
+		};
+
+
+		/**
+		 * @brief compare poses on time stamp
+		 */
+		inline
+		bool pose_stamp_less( const pose2d_t &a, const pose2d_t &b ) {
+			return a.stamp < b.stamp;
+		}
+
+
+		/**
+		 * @brief dataset text dump reader
+		 */
+		class dataset_reader {
+		public:
+			dataset_reader();
+			~dataset_reader();
+
+		public:
+			int open( const char *fname );
+			int close();
+			int read_poses( std::vector<pose2d_t> *dest );
+			int read_next_scan( scan_header_t *header, std::vector<point3d_t> *points );
+			int read_next_header( scan_header_t *header );
+			int read_points( const scan_header_t *header, std::vector<point3d_t> *points );
+			int skip_points( const scan_header_t *header );
+			int rewind();
+
+		private:
+			FILE *_fp;		///< file stream
+			char _buf[512];	///< line buffer
+		};
+
+		inline
+		dataset_reader::dataset_reader() : _fp(0) {
+		}
+
+		inline
+		dataset_reader::~dataset_reader() {
+			close();
+		}
+
+		/**
+		 * @brief open dataset file
+		 * @param [in] fname : file name
+		 */
+		inline
+		int dataset_reader::open( const char *fname ) {
+			gnd_assert(!fname, -1, "invalid null pointer argument\n" );
+			close();
+			if( !(_fp = ::fopen(fname, "r")) ) return -1;
+			return 0;
+		}
+
+		/**
+		 * @brief close dataset file
+		 */
+		inline
+		int dataset_reader::close() {
+			if( _fp ) ::fclose(_fp);
+			_fp = 0;
+			return 0;
+		}
+
+		/**
+		 * @brief seek to the head of dataset
+		 */
+		inline
+		int dataset_reader::rewind() {
+			gnd_assert(!_fp, -1, "file is not opened\n" );
+			::rewind(_fp);
+			return 0;
+		}
+
+		/**
+		 * @brief read all pose records, sorted by time stamp
+		 * @param [out] dest : poses
+		 * @return number of poses
+		 */
+		inline
+		int dataset_reader::read_poses( std::vector<pose2d_t> *dest ) {
+			gnd_assert(!_fp, -1, "file is not opened\n" );
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+
+			dest->clear();
+			while( ::fgets(_buf, sizeof(_buf), _fp) ) {
+				pose2d_t ws;
+				if( _buf[0] != 'p' ) continue;
+				if( ::sscanf(_buf + 1, "%u %lf %lf %lf %lf", &ws.seq, &ws.stamp, &ws.x, &ws.y, &ws.theta) != 5 ) return -1;
+				dest->push_back(ws);
+			}
+
+			// sort by time stamp (keep recorded order on the same stamp)
+			std::stable_sort(dest->begin(), dest->end(), pose_stamp_less);
+			return (int)dest->size();
+		}
+
+		/**
+		 * @brief read next point-cloud record
+		 * @param [out] header : point-cloud header
+		 * @param [out] points : points
+		 * @return 1: read, 0: end of file, <0: format error
+		 */
+		inline
+		int dataset_reader::read_next_scan( scan_header_t *header, std::vector<point3d_t> *points ) {
+			gnd_assert(!_fp, -1, "file is not opened\n" );
+			gnd_assert(!header, -1, "invalid null pointer argument\n" );
+			gnd_assert(!points, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				int ret;
+				if( (ret = read_next_header(header)) <= 0 )	return ret;
+				if( read_points(header, points) < 0 )			return -1;
+				return 1;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief read next point-cloud header, the points have to be read or skipped next
+		 * @param [out] header : point-cloud header
+		 * @return 1: read, 0: end of file, <0: format error
+		 */
+		inline
+		int dataset_reader::read_next_header( scan_header_t *header ) {
+			gnd_assert(!_fp, -1, "file is not opened\n" );
+			gnd_assert(!header, -1, "invalid null pointer argument\n" );
+
+			while( ::fgets(_buf, sizeof(_buf), _fp) ) {
+				if( _buf[0] != 's' ) continue;
+				if( ::sscanf(_buf + 1, "%u %lf %u", &header->seq, &header->stamp, &header->n) != 3 ) return -1;
+				return 1;
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief read points following a point-cloud header
+		 * @param [in]  header : point-cloud header
+		 * @param [out] points : points
+		 */
+		inline
+		int dataset_reader::read_points( const scan_header_t *header, std::vector<point3d_t> *points ) {
+			gnd_assert(!_fp, -1, "file is not opened\n" );
+			gnd_assert(!header, -1, "invalid null pointer argument\n" );
+			gnd_assert(!points, -1, "invalid null pointer argument\n" );
+
+			points->resize(header->n);
+			for( uint32_t i = 0; i < header->n; i++ ) {
+				if( !::fgets(_buf, sizeof(_buf), _fp) ) return -1;
+				if( ::sscanf(_buf, "%f %f %f", &(*points)[i].x, &(*points)[i].y, &(*points)[i].z) != 3 ) return -1;
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief skip points following a point-cloud header without parsing
+		 * @param [in] header : point-cloud header
+		 */
+		inline
+		int dataset_reader::skip_points( const scan_header_t *header ) {
+			gnd_assert(!_fp, -1, "file is not opened\n" );
+			gnd_assert(!header, -1, "invalid null pointer argument\n" );
+
+			for( uint32_t i = 0; i < header->n; i++ ) {
+				if( !::fgets(_buf, sizeof(_buf), _fp) ) return -1;
+			}
+			return 0;
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_DATASET_HPP_ */
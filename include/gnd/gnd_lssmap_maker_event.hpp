@@ -0,0 +1,136 @@
+/*
+ * gnd_lssmap_maker_event.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: message arrival EVENT notification to wake the integration loop
+ */
+
+#ifndef GND_LSSMAP_MAKER_EVENT_HPP_
+#define GND_LSSMAP_MAKER_EVENT_HPP_
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "gnd/gnd-util.h"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		class event_signal;
+
+		template< typename reader_t, typename msg_t >
+		class notifying_reader;
+	}
+} // <--- type declaration
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// maximum time to block the integration loop without any event (sec), to check ros::ok()
+		static const double Event_wait_timeout = 0.1;
+	}
+} // <--- const variables definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief event signal between subscriber callbacks and integration loop
+		 * @note an event notified while the loop is not waiting is kept until the next wait,
+		 *       so no wake up is lost
+		 */
+		class event_signal {
+		public:
+			event_signal();
+
+		public:
+			void notify();
+			bool wait( double timeout );
+
+		private:
+			boost::mutex _mutex;				///< mutex
+			boost::condition_variable _cond;	///< condition variable
+			bool _flg_event;					///< event flag (notified and not waited yet)
+		};
+
+		inline
+		event_signal::event_signal() : _flg_event(false) {
+		}
+
+		/**
+		 * @brief notify event and wake up waiting thread
+		 */
+		inline
+		void event_signal::notify() {
+			{
+				boost::mutex::scoped_lock lock(_mutex);
+				_flg_event = true;
+			}
+			_cond.notify_one();
+		}
+
+		/**
+		 * @brief wait for event
+		 * @param [in] timeout : time out (sec)
+		 * @return true: notified, false: time out
+		 */
+		inline
+		bool event_signal::wait( double timeout ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			boost::system_time deadline = boost::get_system_time()
+					+ boost::posix_time::microseconds( timeout > 0 ? (int64_t)(timeout * 1.0e+6) : 0 );
+
+			while( !_flg_event ) {
+				if( !_cond.timed_wait(lock, deadline) ) break;
+			}
+			if( !_flg_event ) return false;
+
+			_flg_event = false;
+			return true;
+		}
+
+
+
+		/**
+		 * @brief message reader callback wrapper, notify event after the message is stored
+		 */
+		template< typename reader_t, typename msg_t >
+		class notifying_reader {
+		public:
+			notifying_reader( reader_t *reader, event_signal *signal );
+
+		public:
+			void rosmsg_read( const typename msg_t::ConstPtr& msg );
+
+		private:
+			reader_t *_reader;			///< message reader and storage
+			event_signal *_signal;		///< event signal
+		};
+
+		template< typename reader_t, typename msg_t >
+		inline
+		notifying_reader<reader_t, msg_t>::notifying_reader( reader_t *reader, event_signal *signal )
+		: _reader(reader), _signal(signal) {
+		}
+
+		/**
+		 * @brief subscriber callback
+		 */
+		template< typename reader_t, typename msg_t >
+		inline
+		void notifying_reader<reader_t, msg_t>::rosmsg_read( const typename msg_t::ConstPtr& msg ) {
+			_reader->rosmsg_read(msg);
+			_signal->notify();
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_EVENT_HPP_ */
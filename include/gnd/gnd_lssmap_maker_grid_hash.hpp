@@ -0,0 +1,108 @@
+/*
+ * gnd_lssmap_maker_grid_hash.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: reusable open addressing GRID HASH set for per-scan point decimation
+ */
+
+#ifndef GND_LSSMAP_MAKER_GRID_HASH_HPP_
+#define GND_LSSMAP_MAKER_GRID_HASH_HPP_
+
+#include <math.h>
+#include <vector>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct grid_hash;
+		typedef struct grid_hash grid_hash_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief set of grid cells occupied in a scan
+		 * @details linear probing on a power of two table with at most half load.
+		 *          a slot is used in the current scan when its generation equals the current one,
+		 *          so a reset does not clear the table. the table only grows, a hash reused for every scan
+		 *          does not allocate in steady state
+		 */
+		struct grid_hash {
+			std::vector<uint64_t> key;			///< cell key
+			std::vector<uint32_t> generation;	///< generation of slot
+			uint32_t current;					///< current generation
+			size_t mask;						///< table size - 1
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief start a new scan
+		 * @param [in,out] h : grid hash
+		 * @param [in]     n : maximum number of cells to insert
+		 */
+		inline
+		int grid_hash_reset( grid_hash_t *h, size_t n ) {
+			gnd_assert(!h, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				size_t size = 16;
+
+				while( size < 2 * n ) size <<= 1;
+				if( h->key.size() < size ) {
+					h->key.resize(size);
+					h->generation.assign(size, 0);
+					h->mask = size - 1;
+					h->current = 0;
+				}
+				if( ++h->current == 0 ) {
+					// generation wrap around
+					h->generation.assign(h->generation.size(), 0);
+					h->current = 1;
+				}
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief insert the cell of a point
+		 * @param [in,out] h    : grid hash
+		 * @param [in]     x, y : point
+		 * @param [in]     size : grid size
+		 * @return true: the cell is new in this scan
+		 */
+		inline
+		bool grid_hash_insert( grid_hash_t *h, double x, double y, double size ) {
+			const int64_t ix = (int64_t) ::floor(x / size);
+			const int64_t iy = (int64_t) ::floor(y / size);
+			const uint64_t k = ( (uint64_t)(uint32_t)ix << 32 ) | (uint64_t)(uint32_t)iy;
+			size_t i = (size_t)( (k * 0x9E3779B97F4A7C15ULL) >> 32 ) & h->mask;
+
+			while( h->generation[i] == h->current ) {
+				if( h->key[i] == k ) return false;
+				i = (i + 1) & h->mask;
+			}
+			h->generation[i] = h->current;
+			h->key[i] = k;
+			return true;
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_GRID_HASH_HPP_ */
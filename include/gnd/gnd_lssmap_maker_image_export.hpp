@@ -0,0 +1,541 @@
+/*
+ * gnd_lssmap_maker_image_export.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: streaming map IMAGE EXPORT rasterized band by band
+ */
+
+#ifndef GND_LSSMAP_MAKER_IMAGE_EXPORT_HPP_
+#define GND_LSSMAP_MAKER_IMAGE_EXPORT_HPP_
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <vector>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_tile_build.hpp"
+
+/*
+ * the image is cut into bands of "image-map-band-rows" pixel rows.
+ * the maximum likelihood of the whole image is taken first, then the likelihood at the pixel centers of
+ * each band is scaled by it as build_bmp() scales the whole image, so the bands join without seams.
+ * bands are rasterized on "map-build-threads" threads from the shared statistics map and written in order,
+ * from the lowest row (bmp is stored bottom-up), so only (threads x band) pixels are in memory.
+ * a region of the map (e.g. changed tiles of live map) is rasterized the same way into occupancy values.
+ */
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		class bmp_stream;
+
+		struct image_band;
+		typedef struct image_band image_band_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief bmp file written row by row
+		 * @note written into "<file>.tmp" and renamed at close()
+		 */
+		class bmp_stream {
+		public:
+			bmp_stream();
+			~bmp_stream();
+
+		public:
+			int open( const char *fname, uint32_t width, uint32_t height, int bpp );
+			int write_row( const void *row );
+			int close();
+
+		private:
+			static void put16( unsigned char *p, uint16_t v );
+			static void put32( unsigned char *p, uint32_t v );
+
+		private:
+			FILE *_fp;					///< file stream
+			char _fname[512];			///< file name
+			uint32_t _width;			///< width (pixel)
+			uint32_t _bytes;			///< bytes per pixel
+			uint32_t _stride;			///< bytes per row (padded to 4 bytes)
+			uint32_t _nrows;			///< number of rows to write
+			bool _flg_error;			///< write error
+			std::vector<unsigned char> _buf;	///< row buffer (padded)
+		};
+
+		inline
+		bmp_stream::bmp_stream()
+		: _fp(0), _width(0), _bytes(0), _stride(0), _nrows(0), _flg_error(false) {
+			_fname[0] = '\0';
+		}
+
+		inline
+		bmp_stream::~bmp_stream() {
+			if( _fp ) {
+				char fname_tmp[600];
+				::fclose(_fp);
+				::snprintf(fname_tmp, sizeof(fname_tmp), "%s.tmp", _fname);
+				::unlink(fname_tmp);
+			}
+		}
+
+		inline
+		void bmp_stream::put16( unsigned char *p, uint16_t v ) {
+			p[0] = (unsigned char) (v & 0xff);
+			p[1] = (unsigned char) ((v >> 8) & 0xff);
+		}
+
+		inline
+		void bmp_stream::put32( unsigned char *p, uint32_t v ) {
+			p[0] = (unsigned char) (v & 0xff);
+			p[1] = (unsigned char) ((v >> 8) & 0xff);
+			p[2] = (unsigned char) ((v >> 16) & 0xff);
+			p[3] = (unsigned char) ((v >> 24) & 0xff);
+		}
+
+		/**
+		 * @brief open bmp file and write headers
+		 * @param [in] fname  : file name
+		 * @param [in] width  : width (pixel)
+		 * @param [in] height : height (pixel)
+		 * @param [in] bpp    : bits per pixel (8: gray scale palette, 32)
+		 */
+		inline
+		int bmp_stream::open( const char *fname, uint32_t width, uint32_t height, int bpp ) {
+			gnd_assert(!fname, -1, "invalid null pointer argument\n" );
+			gnd_assert(_fp, -1, "already opened\n" );
+			gnd_assert(bpp != 8 && bpp != 32, -1, "invalid argument\n" );
+
+			{ // ---> operation
+				char fname_tmp[600];
+				unsigned char header[54];
+				const uint32_t npalette = bpp == 8 ? 256 : 0;
+				const uint32_t offset = sizeof(header) + npalette * 4;
+
+				if( ::snprintf(_fname, sizeof(_fname), "%s", fname) >= (int)sizeof(_fname) ) return -1;
+				::snprintf(fname_tmp, sizeof(fname_tmp), "%s.tmp", _fname);
+				if( !(_fp = ::fopen(fname_tmp, "wb")) ) return -1;
+
+				_width = width;
+				_bytes = bpp / 8;
+				_stride = (width * _bytes + 3) & ~3u;
+				_nrows = height;
+				_flg_error = false;
+				_buf.assign(_stride, 0);
+
+				// ---> file header and info header (bottom-up rows)
+				::memset(header, 0, sizeof(header));
+				header[0] = 'B';
+				header[1] = 'M';
+				put32(header + 2, offset + _stride * height);
+				put32(header + 10, offset);
+				put32(header + 14, 40);
+				put32(header + 18, width);
+				put32(header + 22, height);
+				put16(header + 26, 1);
+				put16(header + 28, (uint16_t) bpp);
+				put32(header + 34, _stride * height);
+				put32(header + 46, npalette);
+				if( ::fwrite(header, sizeof(header), 1, _fp) != 1 ) _flg_error = true;
+				// <--- file header and info header (bottom-up rows)
+
+				// ---> gray scale palette
+				for( uint32_t i = 0; i < npalette; i++ ) {
+					unsigned char rgbq[4] = { (unsigned char)i, (unsigned char)i, (unsigned char)i, 0 };
+					if( ::fwrite(rgbq, sizeof(rgbq), 1, _fp) != 1 ) _flg_error = true;
+				} // <--- gray scale palette
+
+				return _flg_error ? -1 : 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief write next row (from the bottom)
+		 * @param [in] row : width pixels of 8 or 32 bits
+		 */
+		inline
+		int bmp_stream::write_row( const void *row ) {
+			gnd_assert(!_fp, -1, "not opened\n" );
+			gnd_assert(!row, -1, "invalid null pointer argument\n" );
+			gnd_assert(_nrows == 0, -1, "too many rows\n" );
+
+			{ // ---> operation
+				if( _bytes == 4 ) {
+					// 32 bits pixel in little endian
+					const uint32_t *p = (const uint32_t*) row;
+					for( uint32_t i = 0; i < _width; i++ ) {
+						put32(&_buf[i * 4], p[i]);
+					}
+				}
+				else if( _width > 0 ) {
+					::memcpy(&_buf[0], row, _width);
+				}
+				if( _stride > 0 && ::fwrite(&_buf[0], _stride, 1, _fp) != 1 ) _flg_error = true;
+				_nrows--;
+				return _flg_error ? -1 : 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief close and rename bmp file
+		 * @note the file is discarded on write error or missing rows
+		 */
+		inline
+		int bmp_stream::close() {
+			if( !_fp ) return 0;
+
+			{ // ---> operation
+				char fname_tmp[600];
+				int ret = ::fclose(_fp);
+
+				_fp = 0;
+				::snprintf(fname_tmp, sizeof(fname_tmp), "%s.tmp", _fname);
+				if( ret != 0 || _flg_error || _nrows > 0 ) {
+					::unlink(fname_tmp);
+					return -1;
+				}
+				return ::rename(fname_tmp, _fname) == 0 ? 0 : -1;
+			} // <--- operation
+		}
+
+
+		/**
+		 * @brief band of image
+		 */
+		struct image_band {
+			uint32_t row;						///< first row
+			uint32_t nrows;						///< number of rows
+			std::vector<uint8_t> pixel8;		///< 8 bits pixels (nrows x width)
+			std::vector<uint32_t> pixel32;		///< 32 bits pixels (nrows x width)
+			double max;							///< maximum likelihood of the band
+			int ret;							///< result of rasterization
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// occupancy value of a pixel without likelihood
+		static const int8_t Occupancy_unknown = -1;
+		/// occupancy value of the maximum likelihood
+		static const int8_t Occupancy_max = 100;
+	}
+} // <--- const variables definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief copy statistics cells of a region
+		 * @param [out] dest   : statistics map (initialized by init_tile_build_map())
+		 * @param [in]  src    : statistics map
+		 * @param [in]  xlower, ylower, xupper, yupper : region (m), the cells whose core is in the region are copied
+		 */
+		inline
+		int copy_map_region( gnd::lssmap::lssmap_t *dest, gnd::lssmap::lssmap_t *src, double xlower, double ylower, double xupper, double yupper ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+
+			for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+				for( uint32_t r = 0; r < src->plane[i].row(); r++ ) {
+					double x, y;
+
+					src->plane[i].pget_pos_core(r, 0, &x, &y);
+					if( y < ylower || y > yupper ) continue;
+
+					for( uint32_t c = 0; c < src->plane[i].column(); c++ ) {
+						gnd::lssmap::lss_cell *d;
+
+						src->plane[i].pget_pos_core(r, c, &x, &y);
+						if( x < xlower || x > xupper ) continue;
+						if( !(d = dest->plane[i].ppointer(x, y)) ) {
+							dest->plane[i].reallocate(x, y);
+							if( !(d = dest->plane[i].ppointer(x, y)) ) return -1;
+						}
+						*d = *src->plane[i].pointer(r, c);
+					}
+				}
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief likelihood of a position
+		 * @return likelihood (0: out of the statistics map)
+		 */
+		inline
+		double pixel_likelihood( gnd::lssmap::lssmap_t *lssmap, double x, double y ) {
+			double l;
+			return gnd::lssmap::likelihood(lssmap, x, y, &l) < 0 ? 0 : l;
+		}
+
+		/**
+		 * @brief 8 bits pixel value of likelihood, same scaling as gnd::lssmap::build_bmp()
+		 * @param [in] l   : likelihood
+		 * @param [in] max : likelihood of full scale (maximum of the image)
+		 */
+		inline
+		uint8_t image_pixel8( double l, double max ) {
+			return max > 0 && l > 0 ? (uint8_t) ((l < max ? l / max : 1.0) * 0xff) : 0;
+		}
+
+		/**
+		 * @brief 32 bits pixel value of likelihood, same scaling as gnd::lssmap::build_bmp()
+		 * @param [in] l   : likelihood
+		 * @param [in] max : likelihood of full scale (maximum of the image)
+		 */
+		inline
+		uint32_t image_pixel32( double l, double max ) {
+			return max > 0 && l > 0 ? (uint32_t) ((l < max ? l / max : 1.0) * 0xffffffffU) : 0;
+		}
+
+		/**
+		 * @brief extent of map image
+		 * @param [in]  lssmap : statistics map
+		 * @param [in]  ps     : pixel size (m)
+		 * @param [out] x0, y0 : lower left of image (m), the lower corner of the planes
+		 * @param [out] width  : image width (pixel)
+		 * @param [out] height : image height (pixel)
+		 * @return 0: empty map, 1: extent
+		 */
+		inline
+		int image_extent( gnd::lssmap::lssmap_t *lssmap, double ps, double *x0, double *y0, uint32_t *width, uint32_t *height ) {
+			double xupper = 0, yupper = 0;
+			bool flg_extent = false;
+
+			for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+				if( lssmap->plane[i].row() == 0 || lssmap->plane[i].column() == 0 ) continue;
+				if( !flg_extent || lssmap->plane[i].xlower() < *x0 ) *x0 = lssmap->plane[i].xlower();
+				if( !flg_extent || lssmap->plane[i].ylower() < *y0 ) *y0 = lssmap->plane[i].ylower();
+				if( !flg_extent || lssmap->plane[i].xupper() > xupper ) xupper = lssmap->plane[i].xupper();
+				if( !flg_extent || lssmap->plane[i].yupper() > yupper ) yupper = lssmap->plane[i].yupper();
+				flg_extent = true;
+			}
+			if( !flg_extent ) return 0;
+			*width = (uint32_t) ::ceil( (xupper - *x0) / ps );
+			*height = (uint32_t) ::ceil( (yupper - *y0) / ps );
+			return 1;
+		}
+
+		/**
+		 * @brief maximum likelihood at the pixel centers of a band of image
+		 * @param [in]     lssmap : statistics map
+		 * @param [in]     ps     : pixel size (m)
+		 * @param [in]     x0, y0 : lower left of image (m)
+		 * @param [in]     width  : image width (pixel)
+		 * @param [in,out] band   : band (row and nrows are set), the maximum is set in band->max
+		 */
+		inline
+		void band_likelihood_max( gnd::lssmap::lssmap_t *lssmap, double ps, double x0, double y0, uint32_t width, image_band_t *band ) {
+			band->max = 0;
+			for( uint32_t r = 0; r < band->nrows; r++ ) {
+				const double y = y0 + (band->row + r + 0.5) * ps;
+				for( uint32_t c = 0; c < width; c++ ) {
+					const double l = pixel_likelihood(lssmap, x0 + (c + 0.5) * ps, y);
+					if( l > band->max ) band->max = l;
+				}
+			}
+			band->ret = 0;
+		}
+
+		/**
+		 * @brief maximum likelihood at the pixel centers of the whole image, the full scale of every band
+		 * @param [in]  lssmap   : statistics map
+		 * @param [in]  ps       : pixel size (m)
+		 * @param [in]  x0, y0   : lower left of image (m)
+		 * @param [in]  width    : image width (pixel)
+		 * @param [in]  height   : image height (pixel)
+		 * @param [in]  nthreads : number of threads
+		 * @param [out] max      : maximum likelihood
+		 */
+		inline
+		int image_likelihood_max( gnd::lssmap::lssmap_t *lssmap, double ps, double x0, double y0, uint32_t width, uint32_t height, int nthreads, double *max ) {
+			gnd_assert(!lssmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!max, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				const uint32_t n = nthreads > 1 ? (uint32_t) nthreads : 1;
+				std::vector<image_band_t> bands(n);
+				boost::thread_group threads;
+
+				*max = 0;
+				for( uint32_t k = 0; k < n; k++ ) {
+					bands[k].row = (uint32_t) ((uint64_t) height * k / n);
+					bands[k].nrows = (uint32_t) ((uint64_t) height * (k + 1) / n) - bands[k].row;
+					threads.create_thread( boost::bind(&band_likelihood_max, lssmap, ps, x0, y0, width, &bands[k]) );
+				}
+				threads.join_all();
+				for( uint32_t k = 0; k < n; k++ ) {
+					if( bands[k].max > *max ) *max = bands[k].max;
+				}
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief rasterize a band of image
+		 * @details the likelihood at the pixel centers is scaled by the full scale of the whole image
+		 *          (see image_likelihood_max()), so the bands join without seams
+		 * @param [in]     lssmap : statistics map (read only, shared by the band threads)
+		 * @param [in]     ps     : pixel size (m)
+		 * @param [in]     x0, y0 : lower left of image (m)
+		 * @param [in]     width  : image width (pixel)
+		 * @param [in]     max    : likelihood of full scale
+		 * @param [in,out] band   : band (row and nrows are set)
+		 */
+		inline
+		void rasterize_image_band( gnd::lssmap::lssmap_t *lssmap, double ps, double x0, double y0, uint32_t width, double max, image_band_t *band ) {
+			band->pixel8.resize( (size_t)band->nrows * width );
+			band->pixel32.resize( (size_t)band->nrows * width );
+			for( uint32_t r = 0; r < band->nrows; r++ ) {
+				const double y = y0 + (band->row + r + 0.5) * ps;
+				for( uint32_t c = 0; c < width; c++ ) {
+					const double l = pixel_likelihood(lssmap, x0 + (c + 0.5) * ps, y);
+					band->pixel8[(size_t)r * width + c] = image_pixel8(l, max);
+					band->pixel32[(size_t)r * width + c] = image_pixel32(l, max);
+				}
+			}
+			band->ret = 0;
+		}
+
+		/**
+		 * @brief rasterize a region of map into occupancy values
+		 * @details the likelihood at the pixel centers is scaled by a fixed full scale into the 8 bits pixel value v
+		 *          (see image_pixel8()) and v into 1 to 100, a pixel of v = 0 (no likelihood) or out of the statistics map
+		 *          is Occupancy_unknown. with the same full scale, a pixel has the same value whichever region it is rasterized in
+		 * @param [in]  lssmap : statistics map, the cells of the region and its halo (see build_halo()) are required
+		 * @param [in]  ps     : pixel size (m)
+		 * @param [in]  x0, y0 : lower left of region (m)
+		 * @param [in]  width  : region width (pixel)
+		 * @param [in]  height : region height (pixel)
+		 * @param [in]  max    : likelihood of full scale (occupancy 100, above it is clipped)
+		 * @param [out] dest   : occupancy values, rows from the bottom (height x width)
+		 */
+		inline
+		int rasterize_occupancy_region( gnd::lssmap::lssmap_t *lssmap, double ps, double x0, double y0, uint32_t width, uint32_t height, double max, std::vector<int8_t> *dest ) {
+			gnd_assert(!lssmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				dest->resize( (size_t)height * width );
+				for( uint32_t r = 0; r < height; r++ ) {
+					const double y = y0 + (r + 0.5) * ps;
+					for( uint32_t c = 0; c < width; c++ ) {
+						const int v = image_pixel8( pixel_likelihood(lssmap, x0 + (c + 0.5) * ps, y), max );
+						(*dest)[(size_t)r * width + c] = v > 0 ? (int8_t) (1 + (v - 1) * (Occupancy_max - 1) / 254) : Occupancy_unknown;
+					}
+				}
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief file out map image and its origin band by band
+		 * @note the pixels are the likelihood at their centers on the scale of gnd::lssmap::build_bmp() over the whole image,
+		 *       the origin is the lower corner of the planes. it is used only if "image-map-band-rows" is set (default: the whole image)
+		 * @param [in] lssmap : statistics map
+		 * @param [in] conf   : node configuration
+		 * @param [in] dir    : output directory
+		 */
+		inline
+		int fwrite_map_image_banded( gnd::lssmap::lssmap_t *lssmap, const node_config *conf, const char *dir ) {
+			gnd_assert(!lssmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+			gnd_assert(conf->image_map_pixel_size.value <= 0, -1, "invalid pixel size\n" );
+			gnd_assert(conf->image_map_band_rows.value <= 0, -1, "invalid band size\n" );
+
+			{ // ---> operation
+				const double ps = conf->image_map_pixel_size.value;
+				const int nthreads = conf->map_build_threads.value > 1 ? conf->map_build_threads.value : 1;
+				double xlower = 0, ylower = 0;
+				uint32_t width, height;
+				bmp_stream out8, out32;
+				char fname[512];
+				double max;
+				int ret = 0;
+
+				if( image_extent(lssmap, ps, &xlower, &ylower, &width, &height) == 0 ) return 0;
+				// full scale of all the bands
+				if( image_likelihood_max(lssmap, ps, xlower, ylower, width, height, nthreads, &max) < 0 ) return -1;
+
+				::snprintf(fname, sizeof(fname), "%s/%s", dir, "map-image8.bmp");
+				if( out8.open(fname, width, height, 8) < 0 ) return -1;
+				::snprintf(fname, sizeof(fname), "%s/%s", dir, "map-image32.bmp");
+				if( out32.open(fname, width, height, 32) < 0 ) return -1;
+
+				// ---> rasterize bands on threads and write in order
+				for( uint32_t row = 0; row < height && ret == 0; ) {
+					std::vector<image_band_t> bands(nthreads);
+					boost::thread_group threads;
+					int n = 0;
+
+					for( ; n < nthreads && row < height; n++ ) {
+						bands[n].row = row;
+						bands[n].nrows = std::min( (uint32_t)conf->image_map_band_rows.value, height - row );
+						row += bands[n].nrows;
+						threads.create_thread( boost::bind(&rasterize_image_band, lssmap, ps, xlower, ylower, width, max, &bands[n]) );
+					}
+					threads.join_all();
+
+					for( int k = 0; k < n && ret == 0; k++ ) {
+						if( bands[k].ret < 0 ) {
+							ret = -1;
+							break;
+						}
+						for( uint32_t r = 0; r < bands[k].nrows; r++ ) {
+							if( out8.write_row( &bands[k].pixel8[(size_t)r * width] ) < 0
+							||  out32.write_row( &bands[k].pixel32[(size_t)r * width] ) < 0 ) {
+								ret = -1;
+								break;
+							}
+						}
+					}
+				} // <--- rasterize bands on threads and write in order
+
+				if( out8.close() < 0 )	ret = -1;
+				if( out32.close() < 0 )	ret = -1;
+				if( ret < 0 ) return -1;
+
+				{ // ---> origin
+					FILE *fp;
+
+					::snprintf(fname, sizeof(fname), "%s/%s", dir, "origin.txt" );
+					if( !(fp = ::fopen(fname, "w")) ) {
+						::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to open \"\x1b[4m%s\x1b[0m\"\n", fname);
+						return -1;
+					}
+					::fprintf(fp, "%lf %lf\n", xlower, ylower);
+					::fclose(fp);
+				} // <--- origin
+				return 0;
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_IMAGE_EXPORT_HPP_ */
@@ -0,0 +1,189 @@
+/*
+ * gnd_lssmap_maker_integrator.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: scan INTEGRATOR, ros free core of laser scan statistics map maker (libgnd_lssmap_maker)
+ */
+
+#ifndef GND_LSSMAP_MAKER_INTEGRATOR_HPP_
+#define GND_LSSMAP_MAKER_INTEGRATOR_HPP_
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_dataset.hpp"
+#include "gnd/gnd_lssmap_maker_worker.hpp"
+#include "gnd/gnd_lssmap_maker_tiled_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_live_map.hpp"
+#include "gnd/gnd_lssmap_maker_checkpoint.hpp"
+#include "gnd/gnd_lssmap_maker_point_log.hpp"
+#include "gnd/gnd_lssmap_maker_stats.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		class map_integrator;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief scan integrator
+		 * @details owns the counting map and everything that writes into it: integration threads, point log,
+		 *          checkpoint writer and live map. a caller associates a scan with a pose, checks the collect
+		 *          condition with is_collect() and counts the points with integrate(), on raw arrays of points
+		 *          or packed points (e.g. point-cloud message buffer) on sensor coordinate.
+		 *          each point-cloud source (see get_pointcloud_source()) has its own mounting pose, culling,
+		 *          range gate and collect condition state, and all sources count into the one counting map
+		 *          (through the shards of the integration threads). update() runs the cyclic tasks (shard merge, live map, checkpoint)
+		 *          on the caller's clock. there is no ros dependency, a localization node links libgnd_lssmap_maker
+		 *          and builds the statistics map in-process with build().
+		 * @note not thread safe, call from one thread
+		 */
+		class map_integrator {
+		public:
+			map_integrator();
+			~map_integrator();
+
+		public:
+			int initialize( const node_config *conf, double time, bool offline = false );
+			int update( double time );
+			int stop();
+			int finalize( const char *dir );
+
+		public:
+			bool is_collect( const pose2d_t *pose, int source = 0 ) const;
+			template< typename point_t >
+			int integrate( const pose2d_t *pose, const point_t *points, size_t n, double age = 0, int source = 0 );
+			int integrate( const pose2d_t *pose, std::vector<point3d_t> *points, double age = 0, int source = 0 );
+			template< typename point_t >
+			int integrate( const pose2d_t *pose, const boost::shared_ptr<const void> &hold, const point_t *points, size_t n, double age = 0, int source = 0 );
+			int integrate( const pose2d_t *pose, const boost::shared_ptr<const void> &hold, const packed_points_t *points, double age = 0, int source = 0 );
+			int flush();
+			int build( gnd::lssmap::lssmap_t *dest, int level = 0 );
+			int live_map_delta( live_map_delta_t *dest );
+
+		public:
+			const node_config* config() const;
+			tiled_cmap_t* counting_map();
+			node_stats* stats();
+			point_logger* log();
+			const live_map_t* live_map() const;
+			uint32_t ncheckpoint();
+			bool is_checkpoint() const;
+			bool is_initialized() const;
+			int nthreads() const;
+			size_t backlog();
+
+		private:
+			int count( const pose2d_t *pose, int cnt, double age, int source );
+			const node_config* sensor_pose( int source, const pose2d_t *pose, pose2d_t *dest ) const;
+
+		private:
+			/**
+			 * @brief point-cloud source
+			 */
+			struct source_state {
+				node_config conf;						///< configuration with culling and range gate of the source
+				pose2d_t mount;							///< sensor mounting pose on robot coordinate
+				pose2d_t prevcollect;					///< robot pose at previous collection
+			};
+
+		private:
+			node_config _conf;							///< configuration
+			tiled_cmap_t _cmap;							///< counting map (sparse tiles)
+			integration_pool<point3d_t> _pool;			///< integration threads
+			scan_workspace_t _workspace;				///< transform workspace of caller thread
+			std::vector<point3d_t> _points;				///< point storage to deal to integration threads
+			point_logger _log;							///< counted point log
+			checkpoint_writer _checkpoint;				///< background checkpoint writer
+			live_map_t _live;							///< statistics map rebuilt during operation
+			node_stats _stats;							///< statistics
+			source_state _source[PointCloud_sources_max];	///< point-cloud sources
+			double _time_start;							///< time of initialize
+			double _time_merge;							///< next time to merge shards
+			double _time_live;							///< next time to rebuild live map
+			double _time_checkpoint;					///< next time to write checkpoint
+			bool _flg_init;								///< initialized
+			bool _flg_stop;								///< stopped
+		};
+
+		/**
+		 * @brief count a scan on raw array
+		 * @note on integration threads the points are copied, on the caller thread they are counted in place
+		 * @param [in] pose   : pose associated with the point-cloud
+		 * @param [in] points : points on sensor coordinate (require member x, y, z)
+		 * @param [in] n      : number of points
+		 * @param [in] age    : scan age (sec)
+		 * @param [in] source : point-cloud source index
+		 * @return number of counted points (0 on integration threads)
+		 */
+		template< typename point_t >
+		inline
+		int map_integrator::integrate( const pose2d_t *pose, const point_t *points, size_t n, double age, int source ) {
+			gnd_assert(!pose, -1, "invalid null pointer argument\n" );
+			gnd_assert(n > 0 && !points, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_flg_init || _flg_stop, -1, "not operating\n" );
+
+			if( _pool.nthreads() > 0 ) {
+				_points.resize(n);
+				for( size_t i = 0; i < n; i++ ) {
+					_points[i].x = points[i].x;
+					_points[i].y = points[i].y;
+					_points[i].z = points[i].z;
+				}
+				return integrate(pose, &_points, age, source);
+			}
+
+			{ // ---> operation
+				pose2d_t sensor;
+				const node_config *conf = sensor_pose(source, pose, &sensor);
+				double time = clock_sec();
+				int cnt;
+
+				if( !conf ) return -1;
+				cnt = counting_points(&_cmap, conf, &sensor, points, n, _log.is_open() ? &_log : 0, &_workspace);
+				return count(pose, cnt, age + (clock_sec() - time), source);
+			} // <--- operation
+		}
+
+		/**
+		 * @brief count a scan on raw array owned by a shared object, without copy
+		 * @note integration threads keep hold alive until the points are counted
+		 * @param [in] pose   : pose associated with the point-cloud
+		 * @param [in] hold   : owner of the points, e.g. received message (ConstPtr)
+		 * @param [in] points : points on sensor coordinate (require member x, y, z of float or double)
+		 * @param [in] n      : number of points
+		 * @param [in] age    : scan age (sec)
+		 * @param [in] source : point-cloud source index
+		 * @return number of counted points (0 on integration threads)
+		 */
+		template< typename point_t >
+		inline
+		int map_integrator::integrate( const pose2d_t *pose, const boost::shared_ptr<const void> &hold, const point_t *points, size_t n, double age, int source ) {
+			gnd_assert(n > 0 && !points, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				packed_points_t packed;
+				pack_points(points, n, &packed);
+				return integrate(pose, hold, &packed, age, source);
+			} // <--- operation
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_INTEGRATOR_HPP_ */
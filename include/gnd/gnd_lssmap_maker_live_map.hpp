@@ -0,0 +1,273 @@
+/*
+ * gnd_lssmap_maker_live_map.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: LIVE statistics MAP rebuilt incrementally on the tiles counted since the last build
+ */
+
+#ifndef GND_LSSMAP_MAKER_LIVE_MAP_HPP_
+#define GND_LSSMAP_MAKER_LIVE_MAP_HPP_
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <set>
+#include <vector>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+#include "gnd/gnd_lssmap_maker_tiled_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_tile_build.hpp"
+#include "gnd/gnd_lssmap_maker_image_export.hpp"
+
+/*
+ * the counted tiles and their neighbour tiles within the halo are rebuilt by tile_builder
+ * (see gnd_lssmap_maker_tile_build.hpp).
+ * the first build, a single tile counting map and a configuration of unbounded build halo are always built
+ * from the whole counting map.
+ * the rebuilt tiles are recorded until a consumer (e.g. map publisher) takes the changed cells with take_live_map_delta().
+ */
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct live_map;
+		typedef struct live_map live_map_t;
+
+		struct live_map_delta;
+		typedef struct live_map_delta live_map_delta_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief live statistics map
+		 */
+		struct live_map {
+			gnd::lssmap::lssmap_t lssmap;		///< statistics map
+			bool flg_built;						///< lssmap is built
+			uint64_t since;						///< generation of counting map to rebuild from
+			uint32_t nbuild;					///< number of builds
+			size_t ntiles;						///< number of tiles rebuilt at last build
+			std::set<tile_key_t> changed;		///< tiles rebuilt since the last take_live_map_delta()
+			bool flg_changed_all;				///< whole map is rebuilt since the last take_live_map_delta()
+		};
+
+		/**
+		 * @brief changed cells of live map
+		 */
+		struct live_map_delta {
+			gnd::lssmap::lssmap_t lssmap;		///< statistics cells of the changed region and its halo
+			bool flg_built;						///< lssmap is built
+			bool flg_full;						///< changed region is the whole map
+			double extent[4];					///< extent of the whole map, xlower, ylower, xupper, yupper (m)
+			double region[4];					///< changed region, xlower, ylower, xupper, yupper (m)
+			uint32_t nbuild;					///< number of builds of live map
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief initialize live map
+		 * @param [out] live : live map
+		 */
+		inline
+		int init_live_map( live_map_t *live ) {
+			gnd_assert(!live, -1, "invalid null pointer argument\n" );
+			live->flg_built = false;
+			live->since = 1;
+			live->nbuild = 0;
+			live->ntiles = 0;
+			live->changed.clear();
+			live->flg_changed_all = false;
+			return 0;
+		}
+
+		/**
+		 * @brief rebuild live map on the tiles counted since the last build
+		 * @param [in,out] live : live map
+		 * @param [in,out] cmap : tiled counting map
+		 * @param [in]     conf : node configuration
+		 * @return number of rebuilt tiles
+		 */
+		inline
+		int update_live_map( live_map_t *live, tiled_cmap_t *cmap, const node_config *conf ) {
+			gnd_assert(!live, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			std::vector<tile_key_t> keys;
+			int unbounded;
+
+			if( modified_tiles(cmap, live->since, &keys) <= 0 ) {
+				live->ntiles = 0;
+				return 0;
+			}
+			live->since = next_generation(cmap) + 1;
+			// a configuration of unbounded build halo is rebuilt on the whole map
+			if( (unbounded = build_halo(cmap->cell_size, conf, 0, 0)) < 0 ) return -1;
+
+			if( !live->flg_built || cmap->tile_size <= 0 || unbounded ) { // ---> full build
+				if( live->flg_built ) gnd::lssmap::destroy_map(&live->lssmap);
+				live->flg_built = false;
+
+				if( build_map(&live->lssmap, cmap, conf) < 0 ) return -1;
+				live->flg_built = true;
+				live->flg_changed_all = true;
+			} // <--- full build
+			else { // ---> rebuild counted tiles and their neighbours
+				std::vector<tile_key_t> rebuild;
+				tile_builder builder(&live->lssmap, cmap, conf);
+				int radius;
+
+				if( (radius = tile_halo_radius(cmap, conf)) < 0 ) return -1;
+				dilate_tile_keys(keys, radius, &rebuild);
+				if( builder.build(rebuild, conf->map_build_threads.value) < 0 ) return -1;
+				live->changed.insert(rebuild.begin(), rebuild.end());
+			} // <--- rebuild counted tiles and their neighbours
+
+			live->ntiles = keys.size();
+			live->nbuild++;
+			return (int) live->ntiles;
+		}
+
+		/**
+		 * @brief file out live map image and its origin
+		 * @param [in] live : live map
+		 * @param [in] conf : node configuration
+		 * @param [in] dir  : output directory (created if not exist)
+		 */
+		inline
+		int fwrite_live_map( live_map_t *live, const node_config *conf, const char *dir ) {
+			gnd_assert(!live, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+
+			if( !live->flg_built ) return 0;
+			if( ::mkdir(dir, 0755) < 0 && errno != EEXIST ) return -1;
+			return fwrite_map_image(&live->lssmap, conf, dir);
+		}
+
+		/**
+		 * @brief take the cells changed since the previous call
+		 * @details the cells of the rebuilt tiles and their halo are copied, so the consumer can rasterize them
+		 *          on its own thread while the live map is rebuilt. the changes are accumulated until this call.
+		 *          the copy runs on the caller thread and is the whole map after a full build, so the consumer
+		 *          calls it on a tiled counting map (the map publisher of the node requires it)
+		 * @param [in,out] live  : live map
+		 * @param [in]     cmap  : tiled counting map (tile size)
+		 * @param [in]     conf  : node configuration
+		 * @param [out]    delta : changed cells (lssmap is initialized in this function)
+		 * @return 0: no change, 1: changed
+		 */
+		inline
+		int take_live_map_delta( live_map_t *live, const tiled_cmap_t *cmap, const node_config *conf, live_map_delta_t *delta ) {
+			gnd_assert(!live, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!delta, -1, "invalid null pointer argument\n" );
+
+			delta->flg_built = false;
+			if( !live->flg_built || (!live->flg_changed_all && live->changed.empty()) ) return 0;
+
+			{ // ---> operation
+				// the cell size of a counting map read from files may differ from the configuration
+				const double cell_size = counting_map_cell_size(cmap);
+				double halo = 0;
+				bool flg_extent = false;
+
+				// statistics cells around the changed region that the pixels of it depend on
+				// (an unbounded halo is only rebuilt on the whole map, see update_live_map())
+				if( build_halo(cell_size, conf, 0, &halo) < 0 ) return -1;
+
+				// ---> extent of the whole map
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					if( live->lssmap.plane[i].row() == 0 || live->lssmap.plane[i].column() == 0 ) continue;
+					if( !flg_extent || live->lssmap.plane[i].xlower() < delta->extent[0] ) delta->extent[0] = live->lssmap.plane[i].xlower();
+					if( !flg_extent || live->lssmap.plane[i].ylower() < delta->extent[1] ) delta->extent[1] = live->lssmap.plane[i].ylower();
+					if( !flg_extent || live->lssmap.plane[i].xupper() > delta->extent[2] ) delta->extent[2] = live->lssmap.plane[i].xupper();
+					if( !flg_extent || live->lssmap.plane[i].yupper() > delta->extent[3] ) delta->extent[3] = live->lssmap.plane[i].yupper();
+					flg_extent = true;
+				}
+				if( !flg_extent ) return 0;
+				// <--- extent of the whole map
+
+				// ---> changed region
+				delta->flg_full = live->flg_changed_all || cmap->tile_size <= 0;
+				if( delta->flg_full ) {
+					::memcpy(delta->region, delta->extent, sizeof(delta->region));
+				}
+				else {
+					std::set<tile_key_t>::const_iterator it = live->changed.begin();
+
+					delta->region[0] = it->first * cmap->tile_size;
+					delta->region[1] = it->second * cmap->tile_size;
+					delta->region[2] = (it->first + 1) * cmap->tile_size;
+					delta->region[3] = (it->second + 1) * cmap->tile_size;
+					for( ++it; it != live->changed.end(); ++it ) {
+						if( it->first * cmap->tile_size < delta->region[0] )		delta->region[0] = it->first * cmap->tile_size;
+						if( it->second * cmap->tile_size < delta->region[1] )		delta->region[1] = it->second * cmap->tile_size;
+						if( (it->first + 1) * cmap->tile_size > delta->region[2] )	delta->region[2] = (it->first + 1) * cmap->tile_size;
+						if( (it->second + 1) * cmap->tile_size > delta->region[3] )	delta->region[3] = (it->second + 1) * cmap->tile_size;
+					}
+				} // <--- changed region
+
+				// ---> copy cells of the changed region and its halo
+				if( init_tile_build_map(&delta->lssmap, cell_size, conf) < 0 ) return -1;
+				if( copy_map_region(&delta->lssmap, &live->lssmap,
+						delta->region[0] - halo, delta->region[1] - halo, delta->region[2] + halo, delta->region[3] + halo) < 0 ) {
+					gnd::lssmap::destroy_map(&delta->lssmap);
+					return -1;
+				} // <--- copy cells of the changed region and its halo
+
+				delta->flg_built = true;
+				delta->nbuild = live->nbuild;
+				live->changed.clear();
+				live->flg_changed_all = false;
+				return 1;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief release changed cells of live map
+		 */
+		inline
+		int destroy_live_map_delta( live_map_delta_t *delta ) {
+			gnd_assert(!delta, -1, "invalid null pointer argument\n" );
+			if( delta->flg_built ) gnd::lssmap::destroy_map(&delta->lssmap);
+			delta->flg_built = false;
+			return 0;
+		}
+
+		/**
+		 * @brief release live map
+		 */
+		inline
+		int destroy_live_map( live_map_t *live ) {
+			gnd_assert(!live, -1, "invalid null pointer argument\n" );
+			if( live->flg_built ) gnd::lssmap::destroy_map(&live->lssmap);
+			live->flg_built = false;
+			live->changed.clear();
+			live->flg_changed_all = false;
+			return 0;
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_LIVE_MAP_HPP_ */
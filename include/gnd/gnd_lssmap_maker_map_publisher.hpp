@@ -0,0 +1,433 @@
+/*
+ * gnd_lssmap_maker_map_publisher.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: live MAP PUBLISHER, occupancy grid with delta updates
+ */
+
+#ifndef GND_LSSMAP_MAKER_MAP_PUBLISHER_HPP_
+#define GND_LSSMAP_MAKER_MAP_PUBLISHER_HPP_
+
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+
+#include "ros/ros.h"
+#include "nav_msgs/OccupancyGrid.h"
+#include "map_msgs/OccupancyGridUpdate.h"
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_live_map.hpp"
+#include "gnd/gnd_lssmap_maker_image_export.hpp"
+
+/*
+ * the grid covers the live map extent rounded out to blocks of Map_publisher_block pixels,
+ * so it is reallocated (and sent as a whole) only when the map grows out of the blocks.
+ * the changed region is rasterized on the publisher thread and compared with the last published grid,
+ * on a fixed scale: the maximum likelihood of the first published map is occupancy 100 for all the later updates
+ * (higher likelihood is clipped), so an unchanged pixel keeps its value across updates.
+ * only the bounding box of the changed pixels is sent on "<topic>_updates" (rviz map display subscribes it).
+ * a new subscriber of the map topic receives the whole grid on connection.
+ */
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		class map_publisher;
+	}
+} // <--- type declaration
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// size of grid allocation block (pixel)
+		static const uint32_t Map_publisher_block = 256;
+	}
+} // <--- const variables definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief live map publisher
+		 * @details push() hands over the changed cells of live map (see map_integrator::live_map_delta()) to the publisher thread,
+		 *          which rasterizes and publishes them, so the integration loop is not stalled by the rasterization.
+		 *          while a handed over delta is not yet published (is_busy()), the caller keeps the changes in live map.
+		 */
+		class map_publisher {
+		public:
+			map_publisher();
+			~map_publisher();
+
+		public:
+			int start( ros::NodeHandle *nh, const node_config *conf );
+			int push( live_map_delta_t *delta );
+			int stop();
+
+			bool is_busy();
+			bool is_running() const;
+			uint32_t nfull();
+			uint32_t nupdate();
+			uint64_t nbytes();
+
+		private:
+			void run();
+			int publish( live_map_delta_t *delta );
+			void connected( const ros::SingleSubscriberPublisher &pub );
+
+		private:
+			node_config _conf;					///< configuration
+			ros::Publisher _pub_map;			///< whole grid publisher
+			ros::Publisher _pub_update;			///< changed cells publisher
+			boost::thread _thread;				///< publisher thread
+			boost::mutex _mutex;				///< mutex for pending delta, flags and counters
+			boost::condition_variable _cond;	///< notify pending delta or quit
+			live_map_delta_t *_pending;			///< delta handed over and not yet taken
+			boost::mutex _mutex_grid;			///< mutex for grid (publisher thread and connection callback)
+			nav_msgs::OccupancyGrid _grid;		///< last published grid
+			double _scale;						///< likelihood of occupancy 100 (0: not yet fixed)
+			uint32_t _nfull;					///< number of published whole grids
+			uint32_t _nupdate;					///< number of published updates
+			uint64_t _nbytes;					///< published grid data (bytes)
+			bool _flg_busy;						///< a delta is handed over and not yet published
+			bool _flg_running;					///< thread is running
+			bool _flg_quit;						///< quit request
+		};
+
+		inline
+		map_publisher::map_publisher()
+		: _pending(0), _scale(0), _nfull(0), _nupdate(0), _nbytes(0), _flg_busy(false), _flg_running(false), _flg_quit(false) {
+		}
+
+		inline
+		map_publisher::~map_publisher() {
+			stop();
+		}
+
+		/**
+		 * @brief advertise topics and start publisher thread
+		 * @param [in] nh   : node handle to advertise
+		 * @param [in] conf : configuration (copied)
+		 */
+		inline
+		int map_publisher::start( ros::NodeHandle *nh, const node_config *conf ) {
+			gnd_assert(!nh, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(_flg_running, -1, "already started\n" );
+			gnd_assert(conf->image_map_pixel_size.value <= 0, -1, "invalid pixel size\n" );
+
+			_conf = *conf;
+			_pub_map = nh->advertise<nav_msgs::OccupancyGrid>(_conf.topic_name_live_map.value, 1,
+					boost::bind(&map_publisher::connected, this, _1));
+			_pub_update = nh->advertise<map_msgs::OccupancyGridUpdate>(std::string(_conf.topic_name_live_map.value) + "_updates", 16);
+
+			_grid.data.clear();
+			_scale = 0;
+			_nfull = 0;
+			_nupdate = 0;
+			_nbytes = 0;
+			_flg_busy = false;
+			_flg_quit = false;
+			_flg_running = true;
+			_thread = boost::thread( boost::bind(&map_publisher::run, this) );
+			return 0;
+		}
+
+		/**
+		 * @brief hand over changed cells of live map
+		 * @param [in] delta : changed cells (allocated with new), the publisher thread releases it
+		 * @return 0: handed over, 1: busy (not handed over, the caller keeps delta)
+		 */
+		inline
+		int map_publisher::push( live_map_delta_t *delta ) {
+			gnd_assert(!delta, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_flg_running, -1, "not started\n" );
+
+			{ // ---> operation
+				boost::mutex::scoped_lock lock(_mutex);
+
+				if( _flg_busy ) return 1;
+				_pending = delta;
+				_flg_busy = true;
+				_cond.notify_all();
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief stop publisher thread
+		 * @note a pending delta is discarded
+		 */
+		inline
+		int map_publisher::stop() {
+			if( !_flg_running ) return 0;
+
+			{
+				boost::mutex::scoped_lock lock(_mutex);
+				_flg_quit = true;
+				_cond.notify_all();
+			}
+			_thread.join();
+			_flg_running = false;
+
+			if( _pending ) {
+				destroy_live_map_delta(_pending);
+				delete _pending;
+				_pending = 0;
+			}
+			_flg_busy = false;
+			_pub_map.shutdown();
+			_pub_update.shutdown();
+			return 0;
+		}
+
+		/**
+		 * @brief a delta is handed over and not yet published
+		 */
+		inline
+		bool map_publisher::is_busy() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _flg_busy;
+		}
+
+		/**
+		 * @brief publisher thread is running
+		 */
+		inline
+		bool map_publisher::is_running() const {
+			return _flg_running;
+		}
+
+		/**
+		 * @brief number of published whole grids
+		 */
+		inline
+		uint32_t map_publisher::nfull() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _nfull;
+		}
+
+		/**
+		 * @brief number of published updates
+		 */
+		inline
+		uint32_t map_publisher::nupdate() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _nupdate;
+		}
+
+		/**
+		 * @brief published grid data (bytes)
+		 */
+		inline
+		uint64_t map_publisher::nbytes() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _nbytes;
+		}
+
+		/**
+		 * @brief publisher thread
+		 */
+		inline
+		void map_publisher::run() {
+			for(;;) {
+				live_map_delta_t *delta;
+
+				{ // ---> wait for delta
+					boost::mutex::scoped_lock lock(_mutex);
+					while( !_pending && !_flg_quit ) {
+						_cond.wait(lock);
+					}
+					if( _flg_quit ) break;
+					delta = _pending;
+					_pending = 0;
+				} // <--- wait for delta
+
+				if( publish(delta) < 0 ) {
+					::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to publish live map\n");
+				}
+				destroy_live_map_delta(delta);
+				delete delta;
+
+				{
+					boost::mutex::scoped_lock lock(_mutex);
+					_flg_busy = false;
+				}
+			}
+		}
+
+		/**
+		 * @brief rasterize changed region and publish
+		 * @param [in] delta : changed cells
+		 */
+		inline
+		int map_publisher::publish( live_map_delta_t *delta ) {
+			const double ps = _conf.image_map_pixel_size.value;
+			const double block = ps * Map_publisher_block;
+			double xorg, yorg;
+			uint32_t width, height;
+			uint32_t c0, r0, c1, r1;
+			std::vector<int8_t> occupancy;
+			bool flg_full;
+
+			if( !delta->flg_built ) return 0;
+
+			// ---> fix the scale on the first map (the whole map)
+			if( _scale <= 0 ) {
+				double x0 = 0, y0 = 0;
+				uint32_t w, h;
+
+				if( image_extent(&delta->lssmap, ps, &x0, &y0, &w, &h) > 0
+				&& image_likelihood_max(&delta->lssmap, ps, x0, y0, w, h, 1, &_scale) < 0 ) return -1;
+				if( _scale <= 0 ) return 0;
+			} // <--- fix the scale on the first map
+
+			{ // ---> grid extent
+				boost::mutex::scoped_lock lock(_mutex_grid);
+				double xupper, yupper;
+
+				xorg = ::floor(delta->extent[0] / block) * block;
+				yorg = ::floor(delta->extent[1] / block) * block;
+				xupper = ::ceil(delta->extent[2] / block) * block;
+				yupper = ::ceil(delta->extent[3] / block) * block;
+				flg_full = _grid.data.empty();
+				if( !flg_full ) {
+					// the grid never shrinks
+					xorg = std::min(xorg, _grid.info.origin.position.x);
+					yorg = std::min(yorg, _grid.info.origin.position.y);
+					xupper = std::max(xupper, _grid.info.origin.position.x + _grid.info.width * ps);
+					yupper = std::max(yupper, _grid.info.origin.position.y + _grid.info.height * ps);
+				}
+				width = (uint32_t) ::floor( (xupper - xorg) / ps + 0.5 );
+				height = (uint32_t) ::floor( (yupper - yorg) / ps + 0.5 );
+
+				if( flg_full || width != _grid.info.width || height != _grid.info.height ) { // ---> reallocate grid
+					std::vector<int8_t> data( (size_t)width * height, Occupancy_unknown );
+
+					if( !flg_full ) {
+						// keep the published pixels
+						uint32_t dc = (uint32_t) ::floor( (_grid.info.origin.position.x - xorg) / ps + 0.5 );
+						uint32_t dr = (uint32_t) ::floor( (_grid.info.origin.position.y - yorg) / ps + 0.5 );
+						for( uint32_t r = 0; r < _grid.info.height; r++ ) {
+							std::copy( _grid.data.begin() + (size_t)r * _grid.info.width, _grid.data.begin() + (size_t)(r + 1) * _grid.info.width,
+									data.begin() + (size_t)(r + dr) * width + dc );
+						}
+					}
+					_grid.data.swap(data);
+					_grid.header.frame_id = _conf.live_map_frame_id.value;
+					_grid.info.map_load_time = ros::Time::now();
+					_grid.info.resolution = (float) ps;
+					_grid.info.width = width;
+					_grid.info.height = height;
+					_grid.info.origin.position.x = xorg;
+					_grid.info.origin.position.y = yorg;
+					_grid.info.origin.position.z = 0;
+					_grid.info.origin.orientation.x = 0;
+					_grid.info.origin.orientation.y = 0;
+					_grid.info.origin.orientation.z = 0;
+					_grid.info.origin.orientation.w = 1;
+					flg_full = true;
+				} // <--- reallocate grid
+			} // <--- grid extent
+
+			{ // ---> changed region on grid
+				double fc0 = ::floor( (delta->region[0] - xorg) / ps ), fr0 = ::floor( (delta->region[1] - yorg) / ps );
+				double fc1 = ::ceil( (delta->region[2] - xorg) / ps ), fr1 = ::ceil( (delta->region[3] - yorg) / ps );
+
+				c0 = fc0 < 0 ? 0 : (uint32_t) fc0;
+				r0 = fr0 < 0 ? 0 : (uint32_t) fr0;
+				c1 = fc1 > width ? width : (uint32_t) fc1;
+				r1 = fr1 > height ? height : (uint32_t) fr1;
+				if( c1 <= c0 || r1 <= r0 ) {
+					c1 = c0;
+					r1 = r0;
+				}
+			} // <--- changed region on grid
+
+			// rasterize without lock, it is the heaviest part
+			if( c1 > c0 && rasterize_occupancy_region(&delta->lssmap, ps, xorg + c0 * ps, yorg + r0 * ps, c1 - c0, r1 - r0, _scale, &occupancy) < 0 ) return -1;
+
+			{ // ---> compare with last published grid and publish
+				boost::mutex::scoped_lock lock(_mutex_grid);
+				uint32_t uc0 = c1, ur0 = r1, uc1 = c0, ur1 = r0;		// bounding box of changed pixels
+
+				for( uint32_t r = r0; r < r1; r++ ) {
+					const int8_t *src = &occupancy[(size_t)(r - r0) * (c1 - c0)];
+					int8_t *dest = &_grid.data[(size_t)r * width];
+
+					for( uint32_t c = c0; c < c1; c++ ) {
+						if( dest[c] == src[c - c0] ) continue;
+						dest[c] = src[c - c0];
+						if( c < uc0 )		uc0 = c;
+						if( c + 1 > uc1 )	uc1 = c + 1;
+						if( r < ur0 )		ur0 = r;
+						if( r + 1 > ur1 )	ur1 = r + 1;
+					}
+				}
+
+				if( flg_full ) {
+					_grid.header.stamp = ros::Time::now();
+					_pub_map.publish(_grid);
+
+					boost::mutex::scoped_lock lock_count(_mutex);
+					_nfull++;
+					_nbytes += _grid.data.size();
+				}
+				else if( uc1 > uc0 ) {
+					map_msgs::OccupancyGridUpdate update;
+
+					update.header.frame_id = _grid.header.frame_id;
+					update.header.stamp = ros::Time::now();
+					update.x = (int32_t) uc0;
+					update.y = (int32_t) ur0;
+					update.width = uc1 - uc0;
+					update.height = ur1 - ur0;
+					update.data.resize( (size_t)update.width * update.height );
+					for( uint32_t r = ur0; r < ur1; r++ ) {
+						std::copy( _grid.data.begin() + (size_t)r * width + uc0, _grid.data.begin() + (size_t)r * width + uc1,
+								update.data.begin() + (size_t)(r - ur0) * update.width );
+					}
+					_grid.header.stamp = update.header.stamp;
+					_pub_update.publish(update);
+
+					boost::mutex::scoped_lock lock_count(_mutex);
+					_nupdate++;
+					_nbytes += update.data.size();
+				}
+			} // <--- compare with last published grid and publish
+			return 0;
+		}
+
+		/**
+		 * @brief send the whole grid to a new subscriber
+		 * @note called on a spinner thread
+		 */
+		inline
+		void map_publisher::connected( const ros::SingleSubscriberPublisher &pub ) {
+			boost::mutex::scoped_lock lock(_mutex_grid);
+
+			if( _grid.data.empty() ) return;
+			pub.publish(_grid);
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_MAP_PUBLISHER_HPP_ */
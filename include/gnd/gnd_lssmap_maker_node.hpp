@@ -0,0 +1,641 @@
+/*
+ * gnd_lssmap_maker_node.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: ros NODE of laser scan statistics map maker, shared by the executable and the nodelet
+ */
+
+#ifndef GND_LSSMAP_MAKER_NODE_HPP_
+#define GND_LSSMAP_MAKER_NODE_HPP_
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include "ros/ros.h"
+#include "ros/Time.h"
+
+#include "sensor_msgs/PointCloud.h"
+#include "sensor_msgs/PointCloud2.h"
+#include "gnd_msgs/msg_pose2d_stamped.h"
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_event.hpp"
+#include "gnd/gnd_lssmap_maker_integrator.hpp"
+#include "gnd/gnd_lssmap_maker_map_publisher.hpp"
+#include "gnd/gnd_lssmap_maker_pointcloud_buffer.hpp"
+#include "gnd/gnd_lssmap_maker_pointcloud_msg.hpp"
+#include "gnd/gnd_lssmap_maker_pose_buffer.hpp"
+#include "gnd/gnd_lssmap_maker_stats.hpp"
+#include "gnd/gnd_lssmap_maker_overload.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		class map_maker_node;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief laser scan statistics map maker node
+		 * @details subscribes the pose and the point-clouds with shared pointer callbacks, associates them and
+		 *          counts the points through map_integrator. a received message is only referred until it is counted,
+		 *          the points are not copied (unless downsampled on overload).
+		 *          each point-cloud source has its own subscriber and ring buffer, and is associated independently,
+		 *          so a source waiting for the pose or shed on its full buffer does not delay the others.
+		 *          the association of all the sources (at most PointCloud_sources_max) runs in turn on the run() thread,
+		 *          only the counting is dealt to the integration threads (none by default, "integration-threads" is 1).
+		 *          the caller spins the callbacks (ros::AsyncSpinner in the executable, the manager in the nodelet)
+		 *          and runs run() on its own thread.
+		 */
+		class map_maker_node {
+		public:
+			typedef sensor_msgs::PointCloud								msg_pointcloud_t;
+			typedef sensor_msgs::PointCloud2							msg_pointcloud2_t;
+			typedef pointcloud_buffer									msgreader_pointcloud_t;
+			typedef gnd_msgs::msg_pose2d_stamped						msg_pose_t;
+			typedef pose_buffer<msg_pose_t>								msgreader_pose_t;
+
+			typedef notifying_reader<msgreader_pointcloud_t, msg_pointcloud_t>	notifier_pointcloud_t;
+			typedef notifying_reader<msgreader_pointcloud_t, msg_pointcloud2_t>	notifier_pointcloud2_t;
+			typedef notifying_reader<msgreader_pose_t, msg_pose_t>				notifier_pose_t;
+
+		public:
+			map_maker_node();
+			~map_maker_node();
+
+		public:
+			int initialize( ros::NodeHandle *nh, const node_config *conf );
+			int run();
+			void quit();
+			int finalize();
+
+			bool is_quit();
+
+		private:
+			/**
+			 * @brief point-cloud source
+			 */
+			struct pointcloud_source {
+				pointcloud_source( event_signal *signal );
+
+				int index;										///< source index of configuration and integrator
+				pointcloud_source_config conf;					///< source configuration
+				ros::Subscriber subsc;							///< point-cloud subscriber
+				msgreader_pointcloud_t msgreader;				///< point-cloud message reader and storage (ring buffer)
+				notifier_pointcloud_t notifier;					///< point-cloud subscriber callback (PointCloud)
+				notifier_pointcloud2_t notifier2;				///< point-cloud subscriber callback (PointCloud2)
+				pointcloud_slot_t *pointcloud;					///< operating point-cloud (borrowed from the ring buffer)
+				int seq_at_map_update;							///< sequence id of the last collected point-cloud
+				int npoints;									///< number of points of the last read point-cloud
+			};
+
+		private:
+			int subscribe( ros::NodeHandle *nh, pointcloud_source *src );
+			size_t backlog();
+			void set_received( node_stats *stats );
+
+		private:
+			node_config _conf;									///< configuration
+
+			std::vector<pointcloud_source*> _sources;			///< point-cloud sources
+			ros::Subscriber _subsc_pose;						///< pose subscriber
+			msgreader_pose_t _msgreader_pose;					///< pose storage (time indexed)
+
+			event_signal _event_arrival;						///< message arrival event (wake up main loop)
+			notifier_pose_t _notifier_pose;						///< pose subscriber callback
+
+			map_integrator _integrator;							///< counting map, integration threads, point log, checkpoint and live map
+			overload_state_t _overload;							///< overload detection and load shedding
+			map_publisher _publisher;							///< live map publisher
+
+			boost::mutex _mutex;								///< mutex for quit flag
+			bool _flg_init;										///< initialized
+			bool _flg_quit;										///< quit request
+		};
+
+		inline
+		map_maker_node::pointcloud_source::pointcloud_source( event_signal *signal )
+		: index(0), notifier(&msgreader, signal), notifier2(&msgreader, signal),
+		  pointcloud(0), seq_at_map_update(0), npoints(0) {
+		}
+
+		inline
+		map_maker_node::map_maker_node()
+		: _notifier_pose(&_msgreader_pose, &_event_arrival),
+		  _flg_init(false), _flg_quit(false) {
+		}
+
+		inline
+		map_maker_node::~map_maker_node() {
+			_subsc_pose.shutdown();
+			for( size_t i = 0; i < _sources.size(); i++ ) {
+				_sources[i]->subsc.shutdown();
+				delete _sources[i];
+			}
+			_sources.clear();
+		}
+
+		/**
+		 * @brief make subscribers and initialize scan integrator
+		 * @param [in] nh   : node handle to subscribe
+		 * @param [in] conf : configuration (copied)
+		 */
+		inline
+		int map_maker_node::initialize( ros::NodeHandle *nh, const node_config *conf ) {
+			gnd_assert(!nh, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			_conf = *conf;
+			::fprintf(stdout, "---------- initialize ----------\n");
+
+			// ---> initialize robot pose subscriber
+			{
+				::fprintf(stdout, "\n");
+				::fprintf(stdout, " => initialize robot pose topic subscriber\n");
+
+				if( !_conf.topic_name_pose.value[0] ) {
+					::fprintf(stderr, "    ... error: laser scan topic name is null\n");
+					::fprintf(stderr, "        usage: fill \"%s\" item in configuration file\n", _conf.topic_name_pose.item);
+					return -1;
+				}
+				else {
+					::fprintf(stdout, "    ... topic name is \"%s\"\n", _conf.topic_name_pose.value);
+
+					// allocate buffer
+					_msgreader_pose.allocate(_conf.pose_queue_depth.value > 0 ? _conf.pose_queue_depth.value : 1);
+
+					// make subscriber
+					_subsc_pose = nh->subscribe(_conf.topic_name_pose.value, _conf.pose_queue_depth.value > 0 ? _conf.pose_queue_depth.value : 1,
+							&notifier_pose_t::rosmsg_read,
+							&_notifier_pose );
+					::fprintf(stderr, "    ... ok\n");
+				}
+			} // <--- initialize robot pose subscriber
+
+
+			// ---> initialize point-cloud subscribers
+			{
+				for( int i = 0; i < PointCloud_sources_max; i++ ) {
+					pointcloud_source *src = new pointcloud_source(&_event_arrival);
+
+					src->index = i;
+					get_pointcloud_source(&_conf, i, &src->conf);
+					if( i > 0 && !src->conf.topic_name_pointcloud.value[0] ) {
+						// additional source is not used
+						delete src;
+						continue;
+					}
+					_sources.push_back(src);
+					if( subscribe(nh, src) < 0 ) {
+						return -1;
+					}
+				}
+			} // <--- initialize point-cloud subscribers
+
+
+			// ---> initialize scan integrator (counting map, point log, integration threads and checkpoint writer)
+			{
+				if( _integrator.initialize(&_conf, ros::Time::now().toSec()) < 0 ) {
+					return -1;
+				}
+				_flg_init = true;
+			} // <--- initialize scan integrator
+
+
+
+			// ---> live map publisher
+			if( _conf.live_map_publish_cycle.value > 0 ) {
+				::fprintf(stdout, "\n");
+				::fprintf(stdout, " => initialize live map publisher\n");
+
+				if( _conf.live_map_cycle.value <= 0 ) {
+					::fprintf(stderr, "    ... error: live map is not built\n");
+					::fprintf(stderr, "        usage: fill \"%s\" item with a positive value\n", _conf.live_map_cycle.item);
+					return -1;
+				}
+				// a single tile counting map is rebuilt whole and the whole live map would be copied on this thread at every publish
+				if( _conf.counting_map_tile_size.value <= 0 ) {
+					::fprintf(stderr, "    ... error: live map publish requires tiled counting map\n");
+					::fprintf(stderr, "        usage: fill \"%s\" item with a positive value\n", _conf.counting_map_tile_size.item);
+					return -1;
+				}
+				if( _publisher.start(nh, &_conf) < 0 ) {
+					::fprintf(stderr, "    ... error: fail to start live map publisher\n");
+					return -1;
+				}
+				::fprintf(stdout, "    ... topic name is \"%s\" and \"%s_updates\"\n", _conf.topic_name_live_map.value, _conf.topic_name_live_map.value);
+			} // <--- live map publisher
+
+
+
+			// ---> overload policy
+			{
+				if( init_overload_state(&_overload, &_conf) < 0 ) {
+					::fprintf(stderr, "   ... error: unknown overload policy \"%s\"\n", _conf.overload_policy.value);
+					::fprintf(stderr, "       usage: fill \"%s\" item with \"none\", \"drop-oldest\", \"decimate\" or \"downsample\"\n", _conf.overload_policy.item);
+					return -1;
+				}
+			} // <--- overload policy
+
+			return 0;
+		}
+
+		/**
+		 * @brief make point-cloud subscriber of a source
+		 * @param [in]     nh  : node handle to subscribe
+		 * @param [in,out] src : point-cloud source
+		 */
+		inline
+		int map_maker_node::subscribe( ros::NodeHandle *nh, pointcloud_source *src ) {
+			const pointcloud_source_config *conf = &src->conf;
+
+			::fprintf(stdout, "\n");
+			::fprintf(stdout, " => initialize point-cloud topic subscriber (source %d)\n", src->index);
+
+			if( !conf->topic_name_pointcloud.value[0] ) {
+				::fprintf(stderr, "    ... error: laser scan topic name is null\n");
+				::fprintf(stderr, "        usage: fill \"%s\" item in configuration file\n", conf->topic_name_pointcloud.item);
+				return -1;
+			}
+			::fprintf(stdout, "    ... topic name is \"%s\", type %s\n", conf->topic_name_pointcloud.value, conf->topic_type_pointcloud.value);
+			::fprintf(stdout, "    ... sensor pose (%.03lf, %.03lf, %.01lf[deg])\n",
+					conf->sensor_pose.value[0], conf->sensor_pose.value[1], gnd_ang2deg(conf->sensor_pose.value[2]));
+
+			// allocate buffer, the slot storage is only copied into on "downsample" overload policy
+			src->msgreader.allocate(_conf.pointcloud_queue_depth.value > 0 ? _conf.pointcloud_queue_depth.value : 1,
+					overload_policy(_conf.overload_policy.value) == Overload_downsample && _conf.pointcloud_points_reserve.value > 0 ?
+							_conf.pointcloud_points_reserve.value : 0);
+
+			// make subscriber
+			if( ::strcmp(conf->topic_type_pointcloud.value, "PointCloud") == 0 ) {
+				src->subsc = nh->subscribe(conf->topic_name_pointcloud.value, _conf.pointcloud_queue_depth.value > 0 ? _conf.pointcloud_queue_depth.value : 1,
+						&notifier_pointcloud_t::rosmsg_read,
+						&src->notifier );
+			}
+			else if( ::strcmp(conf->topic_type_pointcloud.value, "PointCloud2") == 0 ) {
+				// x, y and z are decoded straight from the byte buffer of the message
+				src->subsc = nh->subscribe(conf->topic_name_pointcloud.value, _conf.pointcloud_queue_depth.value > 0 ? _conf.pointcloud_queue_depth.value : 1,
+						&notifier_pointcloud2_t::rosmsg_read,
+						&src->notifier2 );
+			}
+			else {
+				::fprintf(stderr, "    ... error: unknown point-cloud message type \"%s\"\n", conf->topic_type_pointcloud.value);
+				::fprintf(stderr, "        usage: fill \"%s\" item with \"PointCloud\" or \"PointCloud2\"\n", conf->topic_type_pointcloud.item);
+				return -1;
+			}
+			::fprintf(stderr, "    ... ok\n");
+			return 0;
+		}
+
+		/**
+		 * @brief number of point-clouds waiting in the ring buffers and the integration threads
+		 */
+		inline
+		size_t map_maker_node::backlog() {
+			size_t n = _integrator.backlog();
+			for( size_t i = 0; i < _sources.size(); i++ ) {
+				n += _sources[i]->msgreader.size();
+			}
+			return n;
+		}
+
+		/**
+		 * @brief set received and dropped point-clouds of all the sources and dropped log into statistics
+		 */
+		inline
+		void map_maker_node::set_received( node_stats *stats ) {
+			uint32_t nreceived = 0, ndropped = 0;
+
+			for( size_t i = 0; i < _sources.size(); i++ ) {
+				nreceived += _sources[i]->msgreader.nreceived();
+				ndropped += _sources[i]->msgreader.ndropped();
+			}
+			stats->set_received(nreceived, ndropped);
+			stats->set_log_dropped(_integrator.log()->is_open() ? _integrator.log()->ndropped() : 0);
+		}
+
+		/**
+		 * @brief main loop, until ros shutdown or quit()
+		 * @note integrate queued scans, stop integration threads and write the last checkpoint and statistics at the end
+		 */
+		inline
+		int map_maker_node::run() {
+			gnd_assert(!_flg_init, -1, "not initialized\n" );
+
+			{ // ---> operate
+				node_stats *stats = _integrator.stats();
+				point_logger *point_log = _integrator.log();
+
+				double time_current;
+				double time_start;
+				double time_display;
+				double time_collect;
+				double time_stats;
+				double time_publish;
+
+				uint32_t seq_pose_at_map_update = 0;
+				double time_pose_at_map_update = 0;
+				double time_pointcloud_at_map_update = 0;
+				pose2d_t pose_latest;
+				stats_snapshot_t stats_display;		// statistics at previous status display
+				stats_snapshot_t stats_file;			// statistics at previous file out
+
+				int nline_show = 0;
+				bool flg_progress = false;
+
+				{ // ---> initialize time
+					time_current = ros::Time::now().toSec();
+					time_start = time_current;
+					time_display = time_start;
+					time_collect = time_start;
+					time_stats = time_start + _conf.stats_cycle.value;
+					time_publish = time_start + _conf.live_map_publish_cycle.value;
+					stats->snapshot(&stats_display);
+					stats->snapshot(&stats_file);
+				} // <--- initialize time
+
+
+				// ---> main loop
+				while( ros::ok() && !is_quit() ) {
+					// ---> blocking: wait for message arrival unless the previous cycle made progress
+					if( !flg_progress ) {
+						double timeout = Event_wait_timeout;
+
+						time_current = ros::Time::now().toSec();
+						if( _conf.cycle_cui_status_display.value > 0 && time_display - time_current < timeout ) {
+							timeout = time_display - time_current;
+						}
+						_event_arrival.wait( timeout );
+					}
+					flg_progress = false;
+					// <--- blocking: wait for message arrival unless the previous cycle made progress
+
+					// time
+					time_current = ros::Time::now().toSec();
+
+					// ---> point-cloud sources
+					for( size_t k = 0; k < _sources.size(); k++ ) {
+						pointcloud_source *src = _sources[k];
+
+						// ---> read new pointcloud data
+						if( !src->pointcloud																				// point-cloud data had already been associated
+						&& (src->pointcloud = src->msgreader.front()) ){											// borrow new data
+							src->npoints = (int)src->pointcloud->header.n;
+							stats->record(Stage_queue, clock_sec() - src->pointcloud->time_arrival);
+							flg_progress = true;
+
+							// ---> overload detection on backlog and age
+							if( _overload.policy != Overload_none ) {
+								update_overload(&_overload, &_conf, backlog(), time_current - src->pointcloud->header.stamp);
+								stats->set_overload_count(_overload.noverload);
+
+								// shed the oldest point-cloud without association
+								if( _overload.flg_overload && _overload.policy == Overload_drop_oldest ) {
+									stats->count_shed(1, src->pointcloud->header.n);
+									src->msgreader.pop();
+									src->pointcloud = 0;
+								}
+							} // <--- overload detection on backlog and age
+						} // <--- read new pointcloud data
+
+						// ---> data collection
+						if( src->pointcloud																				// point-cloud data had not been associated
+						&& src->msgreader.nreceived() >= 2																// exception: few data
+						&& _msgreader_pose.latest( &pose_latest ) == 0												// pose data is delay and it's not able to associate on time-stamp
+						&& ( pose_latest.stamp >= src->pointcloud->header.stamp											// wait for the pose after the point-cloud to interpolate
+							|| ( _conf.pose_extrapolation_limit.value > 0												// or give up waiting and extrapolate
+								&& time_current >= src->pointcloud->header.stamp + _conf.pose_extrapolation_limit.value ) ) ) {
+							bool flg_collect = false;
+							bool flg_associated = false;
+							bool flg_downsample = _overload.flg_overload && _overload.policy == Overload_downsample;
+							pose2d_t pose;
+							double time_associate = clock_sec();
+
+							// ---> associate point-cloud with pose and check data collect condition
+							if( _msgreader_pose.at_time( src->pointcloud->header.stamp,
+									_conf.pose_interpolation_max_gap.value, _conf.pose_extrapolation_limit.value, &pose ) == 0 ) { // get point cloud data
+								flg_associated = true;
+								// check data collect condition
+								flg_collect = _integrator.is_collect(&pose, src->index);
+							}
+							flg_progress = true;
+							stats->record(Stage_associate, clock_sec() - time_associate);
+							if( flg_collect && (is_overload_shed_scan(&_overload, &_conf)
+									|| (flg_downsample && src->msgreader.load(src->pointcloud) != 0)) ) {
+								// decimated on overload, or larger than the slot storage to thin out
+								stats->count_shed(1, src->pointcloud->header.n);
+								flg_collect = false;
+							}
+							else if( !flg_associated ) {
+								// no pose at the time (too large gap or before the first pose)
+								stats->count_unassociated();
+							}
+							else {
+								stats->count_scan(flg_collect);
+							}
+							// <--- associate point-cloud with pose and check data collect condition
+
+							// ---> coordinate transform and counting
+							if( flg_collect ) { // in meeting condition case
+								if( flg_downsample ) {
+									// thin out the points copied into the slot storage
+									stats->count_shed(0, downsample_points(&src->pointcloud->points, _conf.overload_ratio.value));
+									_integrator.integrate(&pose, &src->pointcloud->points, ros::Time::now().toSec() - src->pointcloud->header.stamp, src->index);
+								}
+								else {
+									// count the points of the message in place, integration threads hold the message until counted
+									_integrator.integrate(&pose, src->pointcloud->msg, &src->pointcloud->view,
+											ros::Time::now().toSec() - src->pointcloud->header.stamp, src->index);
+								}
+
+								seq_pose_at_map_update = pose.seq;
+								src->seq_at_map_update = src->pointcloud->header.seq;
+
+								time_pose_at_map_update = pose.stamp;
+								time_pointcloud_at_map_update = src->pointcloud->header.stamp;
+
+							} // <--- coordinate transform and counting
+							// (a skipped point-cloud is never touched)
+
+							// give back the slot to the ring buffer
+							src->msgreader.pop();
+							src->pointcloud = 0;
+						} // <--- data collection
+					} // <--- point-cloud sources
+
+
+					// shard merge, live map rebuild and checkpoint
+					_integrator.update(time_current);
+
+
+					// ---> live map publication
+					if( _publisher.is_running() && time_current > time_publish ) {
+						// the changes are kept in live map while the previous one is being published
+						if( !_publisher.is_busy() ) {
+							live_map_delta_t *delta = new live_map_delta_t;
+
+							delta->flg_built = false;
+							if( _integrator.live_map_delta(delta) <= 0 || _publisher.push(delta) != 0 ) {
+								destroy_live_map_delta(delta);
+								delete delta;
+							}
+						}
+						time_publish = gnd_loop_next(time_current, time_start, _conf.live_map_publish_cycle.value);
+					} // <--- live map publication
+
+
+					// ---> statistics file out
+					if( _conf.stats_file.value[0] && _conf.stats_cycle.value > 0 && time_current > time_stats ) {
+						stats_snapshot_t cur;
+
+						set_received(stats);
+						stats->snapshot(&cur);
+						fwrite_stats(_conf.stats_file.value, &cur, &stats_file);
+						stats_file = cur;
+						time_stats = gnd_loop_next(time_current, time_start, _conf.stats_cycle.value);
+					} // <--- statistics file out
+
+
+
+					// ---> status display
+					if( _conf.cycle_cui_status_display.value > 0 && time_current > time_display ) {
+						stats_snapshot_t cur;
+						double scans_per_sec, points_per_sec;
+
+						set_received(stats);
+						stats->snapshot(&cur);
+						stats_throughput(&cur, &stats_display, &scans_per_sec, &points_per_sec);
+
+						// clear
+						if( nline_show ) {
+							::fprintf(stderr, "\x1b[%02dA", nline_show);
+							nline_show = 0;
+						}
+
+						nline_show++; ::fprintf(stderr, "\x1b[K-------------------- \x1b[1m\x1b[36m%s\x1b[39m\x1b[0m --------------------\n", _conf.node_name.value);
+						nline_show++; ::fprintf(stderr, "\x1b[K operating time : %6.01lf[sec]\n", time_current - time_start);
+						nline_show++; ::fprintf(stderr, "\x1b[K           pose : topic name \"%s\"\n", _conf.topic_name_pose.value );
+						nline_show++; ::fprintf(stderr, "\x1b[K                :    latest seq %d\n", _msgreader_pose.size() > 0 ? pose_latest.seq : 0 );
+						nline_show++; ::fprintf(stderr, "\x1b[K                : collected seq %d\n", seq_pose_at_map_update );
+						for( size_t k = 0; k < _sources.size(); k++ ) {
+							pointcloud_source *src = _sources[k];
+
+							nline_show++; ::fprintf(stderr, "\x1b[K  point-cloud %d : name \"%s\", type %s\n", src->index, src->conf.topic_name_pointcloud.value, src->conf.topic_type_pointcloud.value );
+							nline_show++; ::fprintf(stderr, "\x1b[K                : collected seq  %d\n", src->seq_at_map_update );
+							nline_show++; ::fprintf(stderr, "\x1b[K                : size %d [laser points]\n", src->npoints );
+							nline_show++; ::fprintf(stderr, "\x1b[K                : received %u, dropped %u [scans] (buffer full)\n", src->msgreader.nreceived(), src->msgreader.ndropped() );
+							if( src->msgreader.ninvalid() > 0 ) {
+								nline_show++; ::fprintf(stderr, "\x1b[K                : \x1b[31minvalid %u [scans]\x1b[39m (no float x, y or z field, or foreign byte order)\n", src->msgreader.ninvalid() );
+							}
+						}
+						nline_show++; ::fprintf(stderr, "\x1b[K data associate : stamp diff %7.04lf [sec] (associated pose - point-cloud)\n", time_pose_at_map_update - time_pointcloud_at_map_update );
+						nline_show++; ::fprintf(stderr, "\x1b[K  collect count : %llu [scans]\n", (unsigned long long)cur.scans_collected );
+						nline_show++; ::fprintf(stderr, "\x1b[K     skip count : %llu [scans] (not meet collect condition)\n", (unsigned long long)cur.scans_skipped );
+						if( cur.scans_unassociated > 0 ) {
+							nline_show++; ::fprintf(stderr, "\x1b[K                : \x1b[31mno pose %llu [scans]\x1b[39m (pose gap or before the first pose)\n", (unsigned long long)cur.scans_unassociated );
+						}
+						nline_show++; ::fprintf(stderr, "\x1b[K     throughput : %7.02lf [scans/sec], %10.01lf [points/sec]\n", scans_per_sec, points_per_sec );
+						if( _overload.policy != Overload_none ) {
+							nline_show++; ::fprintf(stderr, "\x1b[K       overload : %s, %s, %llu periods, shed %llu [scans], %llu [points]\n",
+									Overload_policy_name[_overload.policy], _overload.flg_overload ? "\x1b[31mon\x1b[39m" : "off",
+									(unsigned long long)cur.overload_count, (unsigned long long)cur.scans_shed, (unsigned long long)cur.points_shed );
+						}
+						for( int i = 0; i < StageNum; i++ ) {
+							const latency_histogram_t *h = &cur.stage[i];
+							nline_show++; ::fprintf(stderr, "\x1b[K %14s : mean %8.03lf, p99 %8.03lf, max %8.03lf [msec]\n", Stage_name[i],
+									histogram_mean(h) * 1.0e3, histogram_percentile(h, 0.99) * 1.0e3, h->max * 1.0e3 );
+						}
+						if( _conf.live_map_cycle.value > 0 ) {
+							nline_show++; ::fprintf(stderr, "\x1b[K       live map : %d builds, %d tiles at last build\n", (int)_integrator.live_map()->nbuild, (int)_integrator.live_map()->ntiles );
+						}
+						if( _publisher.is_running() ) {
+							nline_show++; ::fprintf(stderr, "\x1b[K   live map pub : %u whole, %u updates, %.01lf [kB] sent\n", _publisher.nfull(), _publisher.nupdate(), _publisher.nbytes() / 1024.0 );
+						}
+						if( point_log->is_open() ) {
+							nline_show++; ::fprintf(stderr, "\x1b[K      point log : %llu [scans] dropped\n", (unsigned long long)cur.log_dropped );
+						}
+						if( _integrator.is_checkpoint() ) {
+							nline_show++; ::fprintf(stderr, "\x1b[K     checkpoint : %d written\n", (int)_integrator.ncheckpoint() );
+						}
+
+						stats_display = cur;
+						time_display = gnd_loop_next(time_current, time_start, _conf.cycle_cui_status_display.value);
+					} // <--- status display
+
+				} // <--- main loop
+
+				// integrate queued scans, merge counting map shards and write the last checkpoint
+				_integrator.stop();
+				_publisher.stop();
+
+				// write the last statistics
+				if( _conf.stats_file.value[0] ) {
+					stats_snapshot_t cur;
+
+					set_received(stats);
+					stats->snapshot(&cur);
+					fwrite_stats(_conf.stats_file.value, &cur, 0);
+				}
+			} // <--- operate
+
+			return 0;
+		}
+
+		/**
+		 * @brief request main loop to quit
+		 */
+		inline
+		void map_maker_node::quit() {
+			{
+				boost::mutex::scoped_lock lock(_mutex);
+				_flg_quit = true;
+			}
+			_event_arrival.notify();
+		}
+
+		/**
+		 * @brief quit is requested
+		 */
+		inline
+		bool map_maker_node::is_quit() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _flg_quit;
+		}
+
+		/**
+		 * @brief file out counting map, map image and its origin
+		 */
+		inline
+		int map_maker_node::finalize() {
+			for( size_t i = 0; i < _sources.size(); i++ ) {
+				_sources[i]->subsc.shutdown();
+			}
+			_subsc_pose.shutdown();
+			_publisher.stop();
+
+			// counting map, map image and origin file out
+			if( _integrator.is_initialized() ) {
+				_integrator.finalize("./");
+			}
+			_flg_init = false;
+			return 0;
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_NODE_HPP_ */
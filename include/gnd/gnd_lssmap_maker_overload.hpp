@@ -0,0 +1,169 @@
+/*
+ * gnd_lssmap_maker_overload.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: OVERLOAD detection on backlog and scan age, and load shedding policies
+ */
+
+#ifndef GND_LSSMAP_MAKER_OVERLOAD_HPP_
+#define GND_LSSMAP_MAKER_OVERLOAD_HPP_
+
+#include <string.h>
+#include <vector>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+#include "gnd/gnd_lssmap_maker_config.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct overload_state;
+		typedef struct overload_state overload_state_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// overload policies
+		enum {
+			Overload_none = 0,			///< no load shedding (the backlog grows)
+			Overload_drop_oldest,		///< drop the oldest point-clouds until the overload is resolved
+			Overload_decimate,			///< integrate one of "overload-ratio" collected point-clouds
+			Overload_downsample,		///< integrate one of "overload-ratio" points per point-cloud
+			OverloadPolicyNum,
+		};
+
+		/// overload policy names ("overload-policy" item value)
+		static const char *const Overload_policy_name[OverloadPolicyNum] = {
+				"none", "drop-oldest", "decimate", "downsample"
+		};
+	}
+} // <--- const variables definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief overload state of the integration loop
+		 */
+		struct overload_state {
+			int policy;					///< overload policy
+			bool flg_overload;			///< in overload
+			uint32_t nscan;				///< number of collected point-clouds since overload start (decimation phase)
+			uint64_t noverload;			///< number of overload periods
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief overload policy from name
+		 * @param [in] name : policy name
+		 * @return policy (-1: unknown name)
+		 */
+		inline
+		int overload_policy( const char *name ) {
+			gnd_assert(!name, -1, "invalid null pointer argument\n" );
+
+			for( int i = 0; i < OverloadPolicyNum; i++ ) {
+				if( ::strcmp(name, Overload_policy_name[i]) == 0 ) return i;
+			}
+			return -1;
+		}
+
+		/**
+		 * @brief initialize overload state
+		 * @param [out] state : overload state
+		 * @param [in]  conf  : configuration
+		 * @return -1: unknown overload policy name
+		 */
+		inline
+		int init_overload_state( overload_state_t *state, const node_config *conf ) {
+			gnd_assert(!state, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			state->policy = overload_policy(conf->overload_policy.value);
+			state->flg_overload = false;
+			state->nscan = 0;
+			state->noverload = 0;
+			return state->policy < 0 ? -1 : 0;
+		}
+
+		/**
+		 * @brief update overload state on a borrowed point-cloud
+		 * @param [in,out] state   : overload state
+		 * @param [in]     conf    : configuration
+		 * @param [in]     backlog : number of waiting point-clouds (ring buffer and integration queues)
+		 * @param [in]     age     : point-cloud age (sec)
+		 * @return true: in overload
+		 */
+		inline
+		bool update_overload( overload_state_t *state, const node_config *conf, size_t backlog, double age ) {
+			bool flg = false;
+
+			if( conf->overload_backlog.value > 0 && backlog >= (size_t)conf->overload_backlog.value )	flg = true;
+			if( conf->overload_age.value > 0 && age >= conf->overload_age.value )							flg = true;
+
+			if( flg && !state->flg_overload ) {
+				state->nscan = 0;
+				state->noverload++;
+			}
+			state->flg_overload = flg;
+			return flg;
+		}
+
+		/**
+		 * @brief decide to shed a collected point-cloud
+		 * @param [in,out] state : overload state
+		 * @param [in]     conf  : configuration
+		 * @return true: shed the point-cloud
+		 */
+		inline
+		bool is_overload_shed_scan( overload_state_t *state, const node_config *conf ) {
+			if( !state->flg_overload || state->policy != Overload_decimate )	return false;
+			if( conf->overload_ratio.value <= 1 )								return false;
+			return ( state->nscan++ % (uint32_t)conf->overload_ratio.value ) != 0;
+		}
+
+		/**
+		 * @brief keep one of ratio points
+		 * @param [in,out] points : points
+		 * @param [in]     ratio  : decimation ratio
+		 * @return number of removed points
+		 */
+		template< typename point_t >
+		inline
+		size_t downsample_points( std::vector<point_t> *points, int ratio ) {
+			gnd_assert(!points, 0, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				size_t n = points->size();
+				size_t j = 0;
+
+				if( ratio <= 1 ) return 0;
+				for( size_t i = 0; i < n; i += ratio ) {
+					(*points)[j++] = (*points)[i];
+				}
+				points->resize(j);
+				return n - j;
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_OVERLOAD_HPP_ */
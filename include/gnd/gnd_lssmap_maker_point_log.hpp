@@ -0,0 +1,417 @@
+/*
+ * gnd_lssmap_maker_point_log.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: asynchronous POINT LOG of counted points (binary records or text) written by a background thread
+ */
+
+#ifndef GND_LSSMAP_MAKER_POINT_LOG_HPP_
+#define GND_LSSMAP_MAKER_POINT_LOG_HPP_
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+/*
+ * binary point log file layout (host byte order, checked by byte order mark)
+ *  - file header           : point_log_header
+ *  - scan record x N       : point_log_scan followed by point_log_scan.n x point_log_point
+ * text point log
+ *  - one line per point    : "<scan sequence id> <x> <y>"
+ */
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct point_log_header;
+		typedef struct point_log_header point_log_header_t;
+
+		struct point_log_scan;
+		typedef struct point_log_scan point_log_scan_t;
+
+		struct point_log_point;
+		typedef struct point_log_point point_log_point_t;
+
+		struct point_log_buffer;
+		typedef struct point_log_buffer point_log_buffer_t;
+
+		class point_logger;
+	}
+} // <--- type declaration
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// file magic
+		static const char PointLog_magic[8] = { 'G', 'N', 'D', 'P', 'L', 'O', 'G', '\0' };
+		/// file format version
+		static const uint32_t PointLog_version = 1;
+		/// byte order mark
+		static const uint32_t PointLog_byte_order = 0x01020304;
+		/// size of a log buffer (byte)
+		static const size_t PointLog_buffer_bytes = 4 * 1024 * 1024;
+		/// number of log buffers
+		static const size_t PointLog_nbuffers = 4;
+		/// cycle to hand over a partially filled buffer to the writer thread (sec)
+		static const double PointLog_flush_cycle = 1.0;
+	}
+} // <--- const variables definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief binary point log file header
+		 */
+		struct point_log_header {
+			char magic[8];				///< file magic
+			uint32_t version;			///< format version
+			uint32_t byte_order;		///< byte order mark
+		};
+
+		/**
+		 * @brief binary point log scan record
+		 */
+		struct point_log_scan {
+			uint32_t seq;				///< sequence id of the associated pose
+			uint32_t n;					///< number of points
+			double stamp;				///< time stamp of the associated pose (sec)
+			double x;					///< robot x (m)
+			double y;					///< robot y (m)
+			double theta;				///< robot orientation (rad)
+		};
+
+		/**
+		 * @brief binary point log point record
+		 */
+		struct point_log_point {
+			double x;					///< x on global coordinate (m)
+			double y;					///< y on global coordinate (m)
+		};
+
+
+		/**
+		 * @brief point log buffer
+		 */
+		struct point_log_buffer {
+			std::vector<char> data;		///< storage (data.size() is the capacity)
+			size_t size;				///< bytes of claimed records
+			size_t npending;			///< number of claimed records being copied
+		};
+
+
+		/**
+		 * @brief asynchronous point logger
+		 * @details write() claims the region of a scan record in the filling buffer under a short lock
+		 *          and copies the points into the claimed region outside the lock.
+		 *          a full buffer is handed over to the writer thread, which writes it into the file
+		 *          (or formats it as text) after every claimed record is copied, and gives it back.
+		 *          a partially filled buffer is also handed over every PointLog_flush_cycle seconds
+		 *          and the file is flushed after each buffer, so the log is not lost on crash.
+		 *          the buffers are allocated at open().
+		 *          when every buffer is waiting for the disk the scan is dropped and counted,
+		 *          so the integration thread never blocks on the disk (unless opened as blocking for off-line use).
+		 */
+		class point_logger {
+		public:
+			point_logger();
+			~point_logger();
+
+		public:
+			int open( const char *fname, bool binary, bool blocking = false, size_t buffer_bytes = PointLog_buffer_bytes, size_t nbuffers = PointLog_nbuffers );
+			int write( uint32_t seq, double stamp, double x, double y, double theta, const double *gx, const double *gy, size_t n );
+			int close();
+
+			bool is_open() const;
+			uint32_t ndropped();
+
+		private:
+			void run();
+			int fwrite_buffer( const point_log_buffer_t *buf );
+
+		private:
+			FILE *_fp;									///< file stream
+			bool _flg_binary;							///< binary format
+			bool _flg_blocking;							///< wait for an empty buffer instead of dropping
+			boost::thread _thread;						///< writer thread
+			boost::mutex _mutex;						///< mutex for buffers and flags
+			boost::condition_variable _cond;			///< notify full buffer or quit
+			std::vector<point_log_buffer_t> _buffers;	///< buffers
+			std::deque<size_t> _free;					///< empty buffers
+			std::deque<size_t> _full;					///< buffers to write
+			size_t _filling;							///< buffer to append (== _buffers.size(): none)
+			size_t _buffer_bytes;						///< buffer size
+			uint32_t _ndropped;							///< number of dropped scans
+			bool _flg_quit;								///< quit request
+		};
+
+		inline
+		point_logger::point_logger()
+		: _fp(0), _flg_binary(false), _flg_blocking(false), _filling(0), _buffer_bytes(0), _ndropped(0), _flg_quit(false) {
+		}
+
+		inline
+		point_logger::~point_logger() {
+			close();
+		}
+
+		/**
+		 * @brief open log file and start writer thread
+		 * @param [in] fname        : file name
+		 * @param [in] binary       : binary format (false: text)
+		 * @param [in] blocking     : wait for an empty buffer instead of dropping the scan
+		 * @param [in] buffer_bytes : size of a buffer
+		 * @param [in] nbuffers     : number of buffers
+		 */
+		inline
+		int point_logger::open( const char *fname, bool binary, bool blocking, size_t buffer_bytes, size_t nbuffers ) {
+			gnd_assert(!fname, -1, "invalid null pointer argument\n" );
+			gnd_assert(_fp, -1, "already opened\n" );
+			gnd_assert(nbuffers < 2 || buffer_bytes == 0, -1, "invalid argument\n" );
+
+			if( !(_fp = ::fopen(fname, binary ? "wb" : "w")) ) return -1;
+			_flg_binary = binary;
+			_flg_blocking = blocking;
+
+			if( _flg_binary ) {
+				point_log_header_t header;
+				::memset(&header, 0, sizeof(header));
+				::memcpy(header.magic, PointLog_magic, sizeof(header.magic));
+				header.version = PointLog_version;
+				header.byte_order = PointLog_byte_order;
+				::fwrite(&header, sizeof(header), 1, _fp);
+			}
+			else {
+				::fprintf(_fp, "#[1. sequence id] [2. x] [3. y]\n");
+			}
+
+			_buffers.resize(nbuffers);
+			_free.clear();
+			_full.clear();
+			for( size_t i = 0; i < nbuffers; i++ ) {
+				_buffers[i].data.resize(buffer_bytes);
+				_buffers[i].size = 0;
+				_buffers[i].npending = 0;
+				_free.push_back(i);
+			}
+			_filling = _free.front();
+			_free.pop_front();
+			_buffer_bytes = buffer_bytes;
+			_ndropped = 0;
+			_flg_quit = false;
+			_thread = boost::thread( boost::bind(&point_logger::run, this) );
+			return 0;
+		}
+
+		/**
+		 * @brief log counted points of a scan
+		 * @param [in] seq, stamp, x, y, theta : associated pose
+		 * @param [in] gx, gy                  : counted points on global coordinate
+		 * @param [in] n                       : number of points
+		 * @return 0: ok, 1: dropped, <0: error
+		 */
+		inline
+		int point_logger::write( uint32_t seq, double stamp, double x, double y, double theta, const double *gx, const double *gy, size_t n ) {
+			gnd_assert(!_fp, -1, "not opened\n" );
+			gnd_assert(n > 0 && (!gx || !gy), -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				const size_t bytes = sizeof(point_log_scan_t) + sizeof(point_log_point_t) * n;
+				point_log_buffer_t *buf;
+				point_log_scan_t *scan;
+				point_log_point_t *p;
+
+				{ // ---> claim the region of the scan record
+					boost::mutex::scoped_lock lock(_mutex);
+
+					// ---> take a filling buffer which the scan fits in
+					// (another thread may take one while waiting)
+					for(;;) {
+						if( _filling < _buffers.size() ) {
+							if( _buffers[_filling].size == 0 || _buffers[_filling].size + bytes <= _buffer_bytes ) break;
+							// hand over the filling buffer
+							_full.push_back(_filling);
+							_filling = _buffers.size();
+							_cond.notify_all();
+						}
+						if( !_free.empty() ) {
+							_filling = _free.front();
+							_free.pop_front();
+						}
+						else if( _flg_blocking ) {
+							_cond.wait(lock);
+						}
+						else {
+							// every buffer is waiting for the disk
+							_ndropped++;
+							return 1;
+						}
+					} // <--- take a filling buffer which the scan fits in
+
+					buf = &_buffers[_filling];
+					// a scan larger than the buffer size grows the empty buffer, no record refers to it
+					if( buf->data.size() < bytes ) buf->data.resize(bytes);
+					scan = (point_log_scan_t*) (&buf->data[0] + buf->size);
+					buf->size += bytes;
+					buf->npending++;
+				} // <--- claim the region of the scan record
+
+				// ---> copy the scan record
+				// (the claimed region is only touched by this thread until completed)
+				scan->seq = seq;
+				scan->n = (uint32_t) n;
+				scan->stamp = stamp;
+				scan->x = x;
+				scan->y = y;
+				scan->theta = theta;
+				p = (point_log_point_t*) (scan + 1);
+				for( size_t i = 0; i < n; i++ ) {
+					p[i].x = gx[i];
+					p[i].y = gy[i];
+				}
+				// <--- copy the scan record
+
+				{ // ---> complete
+					boost::mutex::scoped_lock lock(_mutex);
+					buf->npending--;
+					if( buf->npending == 0 ) _cond.notify_all();
+				} // <--- complete
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief write all buffered scans, stop writer thread and close log file
+		 */
+		inline
+		int point_logger::close() {
+			if( !_fp ) return 0;
+
+			{
+				boost::mutex::scoped_lock lock(_mutex);
+				if( _filling < _buffers.size() && _buffers[_filling].size > 0 ) {
+					_full.push_back(_filling);
+					_filling = _buffers.size();
+				}
+				_flg_quit = true;
+				_cond.notify_all();
+			}
+			_thread.join();
+
+			::fclose(_fp);
+			_fp = 0;
+			_buffers.clear();
+			_free.clear();
+			_full.clear();
+			return 0;
+		}
+
+		/**
+		 * @brief log file is opened
+		 */
+		inline
+		bool point_logger::is_open() const {
+			return _fp != 0;
+		}
+
+		/**
+		 * @brief number of dropped scans
+		 */
+		inline
+		uint32_t point_logger::ndropped() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _ndropped;
+		}
+
+		/**
+		 * @brief writer thread
+		 */
+		inline
+		void point_logger::run() {
+			for(;;) {
+				size_t i;
+
+				{ // ---> wait for full buffer whose records are completed
+					boost::mutex::scoped_lock lock(_mutex);
+					boost::system_time deadline = boost::get_system_time()
+							+ boost::posix_time::microseconds( (int64_t)(PointLog_flush_cycle * 1.0e+6) );
+
+					while( _full.empty() || _buffers[_full.front()].npending > 0 ) {
+						if( _full.empty() && _flg_quit ) break;
+						if( !_cond.timed_wait(lock, deadline) ) {
+							// hand over the partially filled buffer on time out
+							if( _full.empty() && _filling < _buffers.size() && _buffers[_filling].size > 0 ) {
+								_full.push_back(_filling);
+								_filling = _buffers.size();
+							}
+							deadline = boost::get_system_time()
+									+ boost::posix_time::microseconds( (int64_t)(PointLog_flush_cycle * 1.0e+6) );
+						}
+					}
+					if( _full.empty() ) break;
+					i = _full.front();
+					_full.pop_front();
+				} // <--- wait for full buffer whose records are completed
+
+				// the buffer is only touched by this thread until given back
+				fwrite_buffer( &_buffers[i] );
+				::fflush(_fp);
+
+				{ // ---> give back
+					boost::mutex::scoped_lock lock(_mutex);
+					_buffers[i].size = 0;
+					_free.push_back(i);
+					_cond.notify_all();
+				} // <--- give back
+			}
+			::fflush(_fp);
+		}
+
+		/**
+		 * @brief write a buffer into the log file
+		 */
+		inline
+		int point_logger::fwrite_buffer( const point_log_buffer_t *buf ) {
+			if( buf->size == 0 ) return 0;
+
+			if( _flg_binary ) {
+				return ::fwrite(&buf->data[0], buf->size, 1, _fp) == 1 ? 0 : -1;
+			}
+
+			{ // ---> text
+				const char *p = &buf->data[0];
+				const char *end = p + buf->size;
+
+				while( p < end ) {
+					const point_log_scan_t *scan = (const point_log_scan_t*) p;
+					const point_log_point_t *points = (const point_log_point_t*) (scan + 1);
+
+					for( uint32_t i = 0; i < scan->n; i++ ) {
+						::fprintf(_fp, "%u %lf %lf\n", scan->seq, points[i].x, points[i].y);
+					}
+					p = (const char*) (points + scan->n);
+				}
+				return 0;
+			} // <--- text
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_POINT_LOG_HPP_ */
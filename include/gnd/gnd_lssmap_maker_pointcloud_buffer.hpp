@@ -0,0 +1,245 @@
+/*
+ * gnd_lssmap_maker_pointcloud_buffer.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: preallocated POINT-CLOUD ring BUFFER that lends slots to the integration loop
+ */
+
+#ifndef GND_LSSMAP_MAKER_POINTCLOUD_BUFFER_HPP_
+#define GND_LSSMAP_MAKER_POINTCLOUD_BUFFER_HPP_
+
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+#include "gnd/gnd_lssmap_maker_dataset.hpp"
+#include "gnd/gnd_lssmap_maker_transform.hpp"
+#include "gnd/gnd_lssmap_maker_stats.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct pointcloud_slot;
+		typedef struct pointcloud_slot pointcloud_slot_t;
+
+		/// point-cloud message description, specialized for each message type (see gnd_lssmap_maker_pointcloud_msg.hpp)
+		template< typename msg_t >
+		struct pointcloud_traits;
+
+		class pointcloud_buffer;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief point-cloud slot of ring buffer
+		 * @note the received message is only referred, its points are read through the packed view.
+		 *       points are copied into the storage by load() when they have to outlive the slot.
+		 *       points.size() may be larger than header.n, the storage is only grown and reused
+		 */
+		struct pointcloud_slot {
+			scan_header_t header;				///< header
+			double time_arrival;				///< reception time (monotonic sec)
+			boost::shared_ptr<const void> msg;	///< received message
+			packed_points_t view;				///< view of the points in the message
+			std::vector<point3d_t> points;		///< point storage
+		};
+
+
+		/**
+		 * @brief point-cloud ring buffer
+		 * @details a subscriber callback stores the header and the message pointer into the slot after the newest one.
+		 *          the integration loop borrows the oldest slot with front() and gives it back with pop().
+		 *          the points are not touched until the loop decides to collect the scan,
+		 *          and the slot storage used by load() is recycled without allocation
+		 *          (a point-cloud larger than the reserved storage is not loaded).
+		 *          when every slot is in use the received message is dropped and counted.
+		 *          any message type described by pointcloud_traits is stored, the slots do not depend on it.
+		 */
+		class pointcloud_buffer {
+		public:
+			typedef pointcloud_slot_t slot_t;
+
+		public:
+			pointcloud_buffer();
+
+		public:
+			int allocate( size_t nslots, size_t npoints_reserve = 0 );
+			template< typename msg_t >
+			void rosmsg_read( const boost::shared_ptr<const msg_t> &msg );
+
+			slot_t* front();
+			int load( slot_t *slot );
+			int pop();
+
+			size_t size();
+			size_t capacity() const;
+			uint32_t nreceived();
+			uint32_t ndropped();
+			uint32_t ninvalid();
+
+		private:
+			boost::mutex _mutex;						///< mutex for ring indices
+			std::vector<slot_t> _slots;					///< slots
+			size_t _head;								///< index of oldest slot
+			size_t _size;								///< number of stored slots
+			size_t _npoints_reserve;					///< number of points reserved per slot (0: storage grows)
+			uint32_t _nreceived;						///< number of received messages
+			uint32_t _ndropped;							///< number of dropped messages
+			uint32_t _ninvalid;							///< number of messages of unsupported layout
+		};
+
+		inline
+		pointcloud_buffer::pointcloud_buffer()
+		: _head(0), _size(0), _npoints_reserve(0), _nreceived(0), _ndropped(0), _ninvalid(0) {
+		}
+
+		/**
+		 * @brief allocate slots
+		 * @param [in] nslots          : number of slots
+		 * @param [in] npoints_reserve : number of points to reserve per slot (0: the storage grows on load())
+		 */
+		inline
+		int pointcloud_buffer::allocate( size_t nslots, size_t npoints_reserve ) {
+			gnd_assert(nslots == 0, -1, "invalid argument\n" );
+
+			boost::mutex::scoped_lock lock(_mutex);
+			_slots.resize(nslots);
+			for( size_t i = 0; i < nslots; i++ ) {
+				_slots[i].points.reserve(npoints_reserve);
+				_slots[i].header.n = 0;
+			}
+			_head = 0;
+			_size = 0;
+			_npoints_reserve = npoints_reserve;
+			_nreceived = 0;
+			_ndropped = 0;
+			_ninvalid = 0;
+			return 0;
+		}
+
+		/**
+		 * @brief store a point-cloud message (subscriber callback)
+		 * @param [in] msg : point-cloud message (ConstPtr of a type described by pointcloud_traits)
+		 */
+		template< typename msg_t >
+		inline
+		void pointcloud_buffer::rosmsg_read( const boost::shared_ptr<const msg_t> &msg ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			slot_t *slot;
+
+			_nreceived++;
+			if( _slots.empty() || _size >= _slots.size() ) {
+				_ndropped++;
+				return;
+			}
+			slot = &_slots[ (_head + _size) % _slots.size() ];
+			if( pointcloud_traits<msg_t>::describe(*msg, &slot->header, &slot->view) < 0 ) {
+				_ninvalid++;
+				return;
+			}
+			slot->msg = msg;
+			slot->time_arrival = clock_sec();
+			_size++;
+		}
+
+		/**
+		 * @brief borrow the oldest slot
+		 * @return slot (null: no data), valid until pop()
+		 */
+		inline
+		pointcloud_buffer::slot_t* pointcloud_buffer::front() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _size > 0 ? &_slots[_head] : 0;
+		}
+
+		/**
+		 * @brief copy points of the message into the slot storage
+		 * @note call only for a point-cloud to be integrated after the slot is given back.
+		 *       with the storage reserved by allocate() nothing is allocated, a point-cloud larger than
+		 *       the storage is not copied and the caller sheds it. a storage swapped out to integration threads
+		 *       is replaced with a recycled one of the same lifetime.
+		 *       without reservation the storage grows on the first copies and is reused afterwards
+		 * @param [in,out] slot : borrowed slot
+		 * @return 0: loaded, 1: larger than the reserved storage (not loaded)
+		 */
+		inline
+		int pointcloud_buffer::load( slot_t *slot ) {
+			gnd_assert(!slot, -1, "invalid null pointer argument\n" );
+			gnd_assert(!slot->msg, -1, "no message\n" );
+
+			if( _npoints_reserve > 0 && slot->view.n > slot->points.capacity() ) return 1;
+			return unpack_points(&slot->view, &slot->points);
+		}
+
+		/**
+		 * @brief give back the oldest slot
+		 */
+		inline
+		int pointcloud_buffer::pop() {
+			boost::mutex::scoped_lock lock(_mutex);
+			gnd_assert(_size == 0, -1, "no data\n" );
+			_slots[_head].msg.reset();
+			_head = (_head + 1) % _slots.size();
+			_size--;
+			return 0;
+		}
+
+		/**
+		 * @brief number of stored point-clouds
+		 */
+		inline
+		size_t pointcloud_buffer::size() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _size;
+		}
+
+		/**
+		 * @brief number of slots
+		 */
+		inline
+		size_t pointcloud_buffer::capacity() const {
+			return _slots.size();
+		}
+
+		/**
+		 * @brief number of received messages (including dropped)
+		 */
+		inline
+		uint32_t pointcloud_buffer::nreceived() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _nreceived;
+		}
+
+		/**
+		 * @brief number of dropped messages on full buffer
+		 */
+		inline
+		uint32_t pointcloud_buffer::ndropped() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _ndropped;
+		}
+
+		/**
+		 * @brief number of dropped messages of unsupported layout (no x, y or z field, not float or foreign byte order)
+		 */
+		inline
+		uint32_t pointcloud_buffer::ninvalid() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _ninvalid;
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_POINTCLOUD_BUFFER_HPP_ */
@@ -0,0 +1,121 @@
+/*
+ * gnd_lssmap_maker_pointcloud_msg.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: description of POINT-CLOUD MeSsaGes (sensor_msgs::PointCloud and PointCloud2) as packed points
+ */
+
+#ifndef GND_LSSMAP_MAKER_POINTCLOUD_MSG_HPP_
+#define GND_LSSMAP_MAKER_POINTCLOUD_MSG_HPP_
+
+#include <string.h>
+
+#include "sensor_msgs/PointCloud.h"
+#include "sensor_msgs/PointCloud2.h"
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+#include "gnd/gnd_lssmap_maker_dataset.hpp"
+#include "gnd/gnd_lssmap_maker_transform.hpp"
+#include "gnd/gnd_lssmap_maker_pointcloud_buffer.hpp"
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// field names of a point in sensor_msgs::PointCloud2
+		static const char *const PointCloud2_field_name[3] = { "x", "y", "z" };
+	}
+} // <--- const variables definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief sensor_msgs::PointCloud, an array of geometry_msgs::Point32
+		 */
+		template< >
+		struct pointcloud_traits<sensor_msgs::PointCloud> {
+			/**
+			 * @brief fill header and view of points
+			 * @param [in]  msg    : message
+			 * @param [out] header : header
+			 * @param [out] view   : view of points in msg.points
+			 */
+			static int describe( const sensor_msgs::PointCloud &msg, scan_header_t *header, packed_points_t *view ) {
+				gnd_assert(!header, -1, "invalid null pointer argument\n" );
+				gnd_assert(!view, -1, "invalid null pointer argument\n" );
+
+				header->seq = msg.header.seq;
+				header->stamp = msg.header.stamp.toSec();
+				header->n = (uint32_t) msg.points.size();
+				return pack_points(msg.points.empty() ? (const geometry_msgs::Point32*) 0 : &msg.points[0], msg.points.size(), view);
+			}
+		};
+
+		/**
+		 * @brief sensor_msgs::PointCloud2, fields x, y and z of float32 or float64 in the byte buffer
+		 * @note the fields are read straight from data at their offsets, no intermediate message is built.
+		 *       a layout without any of x, y and z, of other field types or of foreign byte order is not supported
+		 */
+		template< >
+		struct pointcloud_traits<sensor_msgs::PointCloud2> {
+			/**
+			 * @brief fill header and view of points
+			 * @param [in]  msg    : message
+			 * @param [out] header : header
+			 * @param [out] view   : view of points in msg.data
+			 */
+			static int describe( const sensor_msgs::PointCloud2 &msg, scan_header_t *header, packed_points_t *view ) {
+				gnd_assert(!header, -1, "invalid null pointer argument\n" );
+				gnd_assert(!view, -1, "invalid null pointer argument\n" );
+
+				{ // ---> byte order
+					const uint16_t one = 1;
+					bool host_bigendian = *((const uint8_t*) &one) == 0;
+
+					if( (bool) msg.is_bigendian != host_bigendian ) return -1;
+				} // <--- byte order
+
+				{ // ---> fields
+					for( int k = 0; k < 3; k++ ) {
+						size_t i;
+
+						for( i = 0; i < msg.fields.size() && ::strcmp(msg.fields[i].name.c_str(), PointCloud2_field_name[k]) != 0; i++ );
+						if( i >= msg.fields.size() ) return -1;
+						if( msg.fields[i].datatype != sensor_msgs::PointField::FLOAT32
+								&& msg.fields[i].datatype != sensor_msgs::PointField::FLOAT64 ) return -1;
+						view->offset[k] = msg.fields[i].offset;
+						view->datatype[k] = msg.fields[i].datatype == sensor_msgs::PointField::FLOAT64 ? Packed_float64 : Packed_float32;
+						if( view->offset[k] + (view->datatype[k] == Packed_float64 ? sizeof(double) : sizeof(float)) > msg.point_step ) return -1;
+					}
+				} // <--- fields
+
+				{ // ---> buffer
+					size_t n = (size_t) msg.width * msg.height;
+
+					if( n > 0 && ( msg.row_step < (size_t) msg.width * msg.point_step
+							|| msg.data.size() < (size_t)(msg.height - 1) * msg.row_step + (size_t) msg.width * msg.point_step ) ) return -1;
+
+					view->data = msg.data.empty() ? (const uint8_t*) 0 : &msg.data[0];
+					view->n = n;
+					view->width = msg.width;
+					view->row_step = msg.row_step;
+					view->point_step = msg.point_step;
+				} // <--- buffer
+
+				header->seq = msg.header.seq;
+				header->stamp = msg.header.stamp.toSec();
+				header->n = (uint32_t) view->n;
+				return 0;
+			}
+		};
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_POINTCLOUD_MSG_HPP_ */
@@ -0,0 +1,257 @@
+/*
+ * gnd_lssmap_maker_pose_buffer.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: time indexed POSE BUFFER with interpolation and extrapolation for scan association
+ */
+
+#ifndef GND_LSSMAP_MAKER_POSE_BUFFER_HPP_
+#define GND_LSSMAP_MAKER_POSE_BUFFER_HPP_
+
+#include <math.h>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include "gnd/gnd-multi-math.h"
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		template< typename msg_t >
+		class pose_buffer;
+	}
+} // <--- type declaration
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief get pose at a time
+		 * @details the bracketing poses are found by binary search and x, y and theta are interpolated linearly.
+		 *          after the latest pose, the pose is extrapolated with the velocity of the latest two poses
+		 * @param [in]  poses         : poses sorted by time stamp (require operator[])
+		 * @param [in]  n             : number of poses
+		 * @param [in]  stamp         : time stamp
+		 * @param [in]  max_gap       : maximum time between the bracketing poses to interpolate (sec)
+		 * @param [in]  extrapolation : maximum time to extrapolate after the latest pose (sec)
+		 * @param [out] out           : pose at the time stamp (seq of the nearer pose)
+		 * @return 0: ok, <0: no pose at the time
+		 */
+		template< typename seq_t >
+		inline
+		int interpolate_pose( const seq_t &poses, size_t n, double stamp, double max_gap, double extrapolation, pose2d_t *out ) {
+			gnd_assert(!out, -1, "invalid null pointer argument\n" );
+			if( n == 0 ) return -1;
+
+			{ // ---> operation
+				size_t lo = 0, hi = n;
+				const pose2d_t *p0, *p1;
+				double r;
+
+				// lower bound of stamp
+				while( lo < hi ) {
+					size_t mid = (lo + hi) / 2;
+					if( poses[mid].stamp < stamp )	lo = mid + 1;
+					else							hi = mid;
+				}
+
+				if( lo < n && poses[lo].stamp == stamp ) {
+					// exact
+					*out = poses[lo];
+					return 0;
+				}
+				else if( lo == 0 ) {
+					// before the oldest pose
+					return -1;
+				}
+				else if( lo == n ) {
+					// ---> extrapolate
+					p1 = &poses[n - 1];
+					if( stamp - p1->stamp > extrapolation ) return -1;
+					if( n < 2 || p1->stamp - poses[n - 2].stamp > max_gap || p1->stamp <= poses[n - 2].stamp ) {
+						*out = *p1;
+						out->stamp = stamp;
+						return 0;
+					}
+					p0 = &poses[n - 2];
+					// <--- extrapolate
+				}
+				else {
+					// ---> interpolate
+					p0 = &poses[lo - 1];
+					p1 = &poses[lo];
+					if( p1->stamp - p0->stamp > max_gap ) return -1;
+					// <--- interpolate
+				}
+
+				r = (stamp - p0->stamp) / (p1->stamp - p0->stamp);
+				out->seq = r < 0.5 ? p0->seq : p1->seq;
+				out->stamp = stamp;
+				out->x = p0->x + (p1->x - p0->x) * r;
+				out->y = p0->y + (p1->y - p0->y) * r;
+				out->theta = gnd_rad_normalize( p0->theta + gnd_rad_normalize(p1->theta - p0->theta) * r );
+				return 0;
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief time indexed pose buffer
+		 * @details a subscriber callback appends poses into a preallocated ring, the oldest pose is overwritten.
+		 *          a pose older than the latest one is dropped, so the ring is always sorted by time stamp
+		 *          and at_time() costs O(log n).
+		 */
+		template< typename msg_t >
+		class pose_buffer {
+		public:
+			pose_buffer();
+
+		public:
+			int allocate( size_t n );
+			void rosmsg_read( const typename msg_t::ConstPtr &msg );
+
+			int at_time( double stamp, double max_gap, double extrapolation, pose2d_t *out );
+			int latest( pose2d_t *out );
+
+			size_t size();
+			uint32_t ndropped();
+
+		public:
+			/**
+			 * @brief i-th oldest pose (not locked, for interpolate_pose())
+			 */
+			const pose2d_t& operator[]( size_t i ) const {
+				return _ring[ (_head + i) % _ring.size() ];
+			}
+
+		private:
+			boost::mutex _mutex;				///< mutex
+			std::vector<pose2d_t> _ring;		///< poses
+			size_t _head;						///< index of oldest pose
+			size_t _size;						///< number of poses
+			uint32_t _ndropped;					///< number of dropped poses (not in time order)
+		};
+
+		template< typename msg_t >
+		inline
+		pose_buffer<msg_t>::pose_buffer()
+		: _head(0), _size(0), _ndropped(0) {
+		}
+
+		/**
+		 * @brief allocate ring
+		 * @param [in] n : number of poses
+		 */
+		template< typename msg_t >
+		inline
+		int pose_buffer<msg_t>::allocate( size_t n ) {
+			gnd_assert(n == 0, -1, "invalid argument\n" );
+
+			boost::mutex::scoped_lock lock(_mutex);
+			_ring.resize(n);
+			_head = 0;
+			_size = 0;
+			_ndropped = 0;
+			return 0;
+		}
+
+		/**
+		 * @brief store a pose message (subscriber callback)
+		 * @param [in] msg : pose message (require header.seq, header.stamp, x, y and theta)
+		 */
+		template< typename msg_t >
+		inline
+		void pose_buffer<msg_t>::rosmsg_read( const typename msg_t::ConstPtr &msg ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			pose2d_t *p;
+			double stamp = msg->header.stamp.toSec();
+
+			if( _ring.empty() ) return;
+			if( _size > 0 && stamp <= (*this)[_size - 1].stamp ) {
+				_ndropped++;
+				return;
+			}
+
+			if( _size < _ring.size() ) {
+				p = &_ring[ (_head + _size) % _ring.size() ];
+				_size++;
+			}
+			else {
+				// overwrite the oldest
+				p = &_ring[_head];
+				_head = (_head + 1) % _ring.size();
+			}
+			p->seq = msg->header.seq;
+			p->stamp = stamp;
+			p->x = msg->x;
+			p->y = msg->y;
+			p->theta = msg->theta;
+		}
+
+		/**
+		 * @brief get pose at a time
+		 * @see interpolate_pose()
+		 */
+		template< typename msg_t >
+		inline
+		int pose_buffer<msg_t>::at_time( double stamp, double max_gap, double extrapolation, pose2d_t *out ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			return interpolate_pose(*this, _size, stamp, max_gap, extrapolation, out);
+		}
+
+		/**
+		 * @brief get the latest pose
+		 * @return 0: ok, <0: no pose
+		 */
+		template< typename msg_t >
+		inline
+		int pose_buffer<msg_t>::latest( pose2d_t *out ) {
+			gnd_assert(!out, -1, "invalid null pointer argument\n" );
+
+			boost::mutex::scoped_lock lock(_mutex);
+			if( _size == 0 ) return -1;
+			*out = (*this)[_size - 1];
+			return 0;
+		}
+
+		/**
+		 * @brief number of stored poses
+		 */
+		template< typename msg_t >
+		inline
+		size_t pose_buffer<msg_t>::size() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _size;
+		}
+
+		/**
+		 * @brief number of dropped poses
+		 */
+		template< typename msg_t >
+		inline
+		uint32_t pose_buffer<msg_t>::ndropped() {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _ndropped;
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_POSE_BUFFER_HPP_ */
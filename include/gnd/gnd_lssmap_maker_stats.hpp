@@ -0,0 +1,403 @@
+/*
+ * gnd_lssmap_maker_stats.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: per-stage latency histograms and throughput counters (STATisticS of the node)
+ */
+
+#ifndef GND_LSSMAP_MAKER_STATS_HPP_
+#define GND_LSSMAP_MAKER_STATS_HPP_
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <boost/thread/mutex.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct latency_histogram;
+		typedef struct latency_histogram latency_histogram_t;
+
+		struct stats_snapshot;
+		typedef struct stats_snapshot stats_snapshot_t;
+
+		class node_stats;
+	}
+} // <--- type declaration
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// stages of scan processing
+		enum {
+			Stage_queue = 0,		///< point-cloud reception to borrowed by the integration loop
+			Stage_associate,		///< pose association and collect condition
+			Stage_dispatch,			///< waiting in the queue of integration thread
+			Stage_transform,		///< range gate and coordinate transform
+			Stage_counting,			///< culling and counting
+			Stage_log,				///< point log
+			Stage_age,				///< scan age at integration (now - point-cloud time stamp)
+			StageNum,
+		};
+
+		/// stage names
+		static const char *const Stage_name[StageNum] = {
+				"queue", "associate", "dispatch", "transform", "counting", "log", "age"
+		};
+
+		/// number of histogram buckets, bucket i counts [2^(i-1), 2^i) micro sec (bucket 0: < 1 micro sec)
+		static const int Histogram_nbuckets = 32;
+	}
+} // <--- const variables definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief latency histogram on log2 buckets of micro sec
+		 */
+		struct latency_histogram {
+			uint64_t count;							///< number of samples
+			double sum;								///< sum of samples (sec)
+			double max;								///< maximum sample (sec)
+			uint64_t bucket[Histogram_nbuckets];	///< number of samples in buckets
+		};
+
+		/**
+		 * @brief snapshot of node statistics (cumulative)
+		 */
+		struct stats_snapshot {
+			double time;							///< time of snapshot (monotonic sec)
+			double elapsed;							///< time since start (sec)
+			uint64_t scans_received;				///< received point-clouds
+			uint64_t scans_dropped;					///< point-clouds dropped on full buffer
+			uint64_t scans_collected;				///< point-clouds integrated
+			uint64_t scans_skipped;					///< point-clouds not meeting collect condition
+			uint64_t scans_unassociated;			///< point-clouds without a pose at the time (gap or before the first pose)
+			uint64_t scans_shed;					///< point-clouds shed on overload
+			uint64_t points_shed;					///< points shed on overload (including shed point-clouds)
+			uint64_t overload_count;				///< number of overload periods
+			uint64_t points_counted;				///< counted points
+			uint64_t log_dropped;					///< scans dropped from point log
+			latency_histogram_t stage[StageNum];	///< stage latency
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief monotonic clock (sec)
+		 */
+		inline
+		double clock_sec() {
+			struct timespec ts;
+			::clock_gettime(CLOCK_MONOTONIC, &ts);
+			return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+		}
+
+		/**
+		 * @brief add a sample into histogram
+		 * @param [in,out] h   : histogram
+		 * @param [in]     sec : sample (sec)
+		 */
+		inline
+		void histogram_record( latency_histogram_t *h, double sec ) {
+			double us = sec * 1.0e6;
+			int i = 0;
+
+			if( sec < 0 ) sec = us = 0;
+			while( i < Histogram_nbuckets - 1 && us >= 1.0 ) {
+				us /= 2;
+				i++;
+			}
+			h->bucket[i]++;
+			h->count++;
+			h->sum += sec;
+			if( sec > h->max ) h->max = sec;
+		}
+
+		/**
+		 * @brief percentile of histogram
+		 * @param [in] h : histogram
+		 * @param [in] p : percentile (0 - 1)
+		 * @return upper bound of the bucket (sec)
+		 */
+		inline
+		double histogram_percentile( const latency_histogram_t *h, double p ) {
+			uint64_t n = 0;
+			if( h->count == 0 ) return 0;
+
+			for( int i = 0; i < Histogram_nbuckets; i++ ) {
+				n += h->bucket[i];
+				if( n >= p * h->count ) {
+					double ub = ( (uint64_t)1 << i ) * 1.0e-6;
+					return ub < h->max ? ub : h->max;
+				}
+			}
+			return h->max;
+		}
+
+		/**
+		 * @brief mean of histogram (sec)
+		 */
+		inline
+		double histogram_mean( const latency_histogram_t *h ) {
+			return h->count > 0 ? h->sum / h->count : 0;
+		}
+
+		/**
+		 * @brief print histogram summary as a json object
+		 * @param [in] fp : file stream
+		 * @param [in] h  : histogram
+		 */
+		inline
+		int fprint_histogram_json( FILE *fp, const latency_histogram_t *h ) {
+			gnd_assert(!fp, -1, "invalid null pointer argument\n" );
+			gnd_assert(!h, -1, "invalid null pointer argument\n" );
+
+			return ::fprintf(fp, "{ \"count\": %llu, \"mean\": %.9lf, \"p50\": %.9lf, \"p99\": %.9lf, \"max\": %.9lf }",
+					(unsigned long long)h->count, histogram_mean(h),
+					histogram_percentile(h, 0.5), histogram_percentile(h, 0.99), h->max) < 0 ? -1 : 0;
+		}
+
+		/**
+		 * @brief throughput between snapshots
+		 * @param [in]  cur    : current snapshot
+		 * @param [in]  prev   : previous snapshot (null: since start)
+		 * @param [out] scans  : integrated scans per sec
+		 * @param [out] points : counted points per sec
+		 */
+		inline
+		int stats_throughput( const stats_snapshot_t *cur, const stats_snapshot_t *prev, double *scans, double *points ) {
+			gnd_assert(!cur, -1, "invalid null pointer argument\n" );
+			gnd_assert(!scans, -1, "invalid null pointer argument\n" );
+			gnd_assert(!points, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				double dt = prev ? cur->time - prev->time : cur->elapsed;
+
+				if( dt <= 0 ) {
+					*scans = 0;
+					*points = 0;
+					return 0;
+				}
+				*scans = (cur->scans_collected - (prev ? prev->scans_collected : 0)) / dt;
+				*points = (cur->points_counted - (prev ? prev->points_counted : 0)) / dt;
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief file out statistics snapshot in json
+		 * @note written into "<fname>.tmp" and renamed, so a reader never sees a partial file
+		 * @param [in] fname : file name
+		 * @param [in] cur   : current snapshot
+		 * @param [in] prev  : previous snapshot to calculate rates (null: since start)
+		 */
+		inline
+		int fwrite_stats( const char *fname, const stats_snapshot_t *cur, const stats_snapshot_t *prev ) {
+			gnd_assert(!fname, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cur, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				char fname_tmp[1024];
+				FILE *fp;
+				double scans, points;
+
+				if( ::snprintf(fname_tmp, sizeof(fname_tmp), "%s.tmp", fname) >= (int)sizeof(fname_tmp) ) return -1;
+				if( !(fp = ::fopen(fname_tmp, "w")) ) return -1;
+				stats_throughput(cur, prev, &scans, &points);
+
+				::fprintf(fp, "{\n");
+				::fprintf(fp, "  \"elapsed\": %.3lf,\n", cur->elapsed);
+				::fprintf(fp, "  \"scans_received\": %llu,\n", (unsigned long long)cur->scans_received);
+				::fprintf(fp, "  \"scans_dropped\": %llu,\n", (unsigned long long)cur->scans_dropped);
+				::fprintf(fp, "  \"scans_collected\": %llu,\n", (unsigned long long)cur->scans_collected);
+				::fprintf(fp, "  \"scans_skipped\": %llu,\n", (unsigned long long)cur->scans_skipped);
+				::fprintf(fp, "  \"scans_unassociated\": %llu,\n", (unsigned long long)cur->scans_unassociated);
+				::fprintf(fp, "  \"scans_shed\": %llu,\n", (unsigned long long)cur->scans_shed);
+				::fprintf(fp, "  \"points_shed\": %llu,\n", (unsigned long long)cur->points_shed);
+				::fprintf(fp, "  \"overload_count\": %llu,\n", (unsigned long long)cur->overload_count);
+				::fprintf(fp, "  \"points_counted\": %llu,\n", (unsigned long long)cur->points_counted);
+				::fprintf(fp, "  \"log_dropped\": %llu,\n", (unsigned long long)cur->log_dropped);
+				::fprintf(fp, "  \"scans_per_sec\": %.3lf,\n", scans);
+				::fprintf(fp, "  \"points_per_sec\": %.3lf,\n", points);
+				::fprintf(fp, "  \"stages\": {\n");
+				for( int i = 0; i < StageNum; i++ ) {
+					::fprintf(fp, "    \"%s\": ", Stage_name[i]);
+					fprint_histogram_json(fp, &cur->stage[i]);
+					::fprintf(fp, "%s\n", i < StageNum - 1 ? "," : "");
+				}
+				::fprintf(fp, "  }\n");
+				::fprintf(fp, "}\n");
+
+				if( ::fclose(fp) != 0 ) {
+					::unlink(fname_tmp);
+					return -1;
+				}
+				return ::rename(fname_tmp, fname) == 0 ? 0 : -1;
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief node statistics
+		 * @details the integration loop and the integration threads record a scan at once under a short lock,
+		 *          snapshot() copies the cumulative values for the status display and the stats file
+		 */
+		class node_stats {
+		public:
+			node_stats();
+
+		public:
+			void record( int stage, double sec );
+			void count_scan( bool collected );
+			void count_unassociated();
+			void count_integrated( double transform, double counting, double log, double age, uint64_t npoints );
+			void count_shed( uint64_t nscans, uint64_t npoints );
+			void set_overload_count( uint64_t count );
+			void set_received( uint64_t received, uint64_t dropped );
+			void set_log_dropped( uint64_t dropped );
+			void snapshot( stats_snapshot_t *out );
+
+		private:
+			boost::mutex _mutex;			///< mutex
+			stats_snapshot_t _stats;		///< cumulative values
+			double _time_start;				///< time of start (monotonic sec)
+		};
+
+		inline
+		node_stats::node_stats() {
+			::memset(&_stats, 0, sizeof(_stats));
+			_time_start = clock_sec();
+		}
+
+		/**
+		 * @brief add a stage latency
+		 * @param [in] stage : stage
+		 * @param [in] sec   : latency (sec)
+		 */
+		inline
+		void node_stats::record( int stage, double sec ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			histogram_record(&_stats.stage[stage], sec);
+		}
+
+		/**
+		 * @brief count an associated scan
+		 * @param [in] collected : meeting collect condition (false: skipped)
+		 */
+		inline
+		void node_stats::count_scan( bool collected ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			if( collected )	_stats.scans_collected++;
+			else			_stats.scans_skipped++;
+		}
+
+		/**
+		 * @brief count a scan that is not associated with a pose
+		 */
+		inline
+		void node_stats::count_unassociated() {
+			boost::mutex::scoped_lock lock(_mutex);
+			_stats.scans_unassociated++;
+		}
+
+		/**
+		 * @brief add the latency of an integrated scan
+		 * @param [in] transform : latency of transform stage (sec)
+		 * @param [in] counting  : latency of counting stage (sec)
+		 * @param [in] log       : latency of log stage (sec)
+		 * @param [in] age       : scan age at integration (sec)
+		 * @param [in] npoints   : number of counted points
+		 */
+		inline
+		void node_stats::count_integrated( double transform, double counting, double log, double age, uint64_t npoints ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			histogram_record(&_stats.stage[Stage_transform], transform);
+			histogram_record(&_stats.stage[Stage_counting], counting);
+			histogram_record(&_stats.stage[Stage_log], log);
+			histogram_record(&_stats.stage[Stage_age], age);
+			_stats.points_counted += npoints;
+		}
+
+		/**
+		 * @brief count shed data on overload
+		 * @param [in] nscans  : number of shed point-clouds
+		 * @param [in] npoints : number of shed points
+		 */
+		inline
+		void node_stats::count_shed( uint64_t nscans, uint64_t npoints ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			_stats.scans_shed += nscans;
+			_stats.points_shed += npoints;
+		}
+
+		/**
+		 * @brief set number of overload periods
+		 */
+		inline
+		void node_stats::set_overload_count( uint64_t count ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			_stats.overload_count = count;
+		}
+
+		/**
+		 * @brief set point-cloud reception counters
+		 */
+		inline
+		void node_stats::set_received( uint64_t received, uint64_t dropped ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			_stats.scans_received = received;
+			_stats.scans_dropped = dropped;
+		}
+
+		/**
+		 * @brief set point log drop counter
+		 */
+		inline
+		void node_stats::set_log_dropped( uint64_t dropped ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			_stats.log_dropped = dropped;
+		}
+
+		/**
+		 * @brief copy cumulative values
+		 * @param [out] out : snapshot
+		 */
+		inline
+		void node_stats::snapshot( stats_snapshot_t *out ) {
+			boost::mutex::scoped_lock lock(_mutex);
+			*out = _stats;
+			out->time = clock_sec();
+			out->elapsed = out->time - _time_start;
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_STATS_HPP_ */
@@ -0,0 +1,582 @@
+/*
+ * gnd_lssmap_maker_tile_build.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: statistics map BUILD per counting map TILE with halo, on a thread pool
+ */
+
+#ifndef GND_LSSMAP_MAKER_TILE_BUILD_HPP_
+#define GND_LSSMAP_MAKER_TILE_BUILD_HPP_
+
+#include <math.h>
+#include <string.h>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_tiled_cmap.hpp"
+
+/*
+ * the statistics of a cell only depend on the counting cells around it (halo),
+ * so a tile is built from the counting map of the tile and its neighbour tiles within the halo
+ * and only the cells inside the tile are copied into the statistics map.
+ * every cell is computed from the same counting cells as the build of the whole map.
+ * the result is identical to the build of the counting map counted untiled only if the tiles hold whole counting cells,
+ * i.e. a single tile counting map split for the build (build_map_parallel()). the cells on a tile border
+ * of a directly counted tiled counting map are counted in both tiles and hold partial sums.
+ * the counts of a tile reach the cells of its neighbour tiles within the halo,
+ * so the tiles around the counted tiles are built too (dilate_tile_keys()).
+ * the halo depends on "sensor-range" and "additional-smoothing-parameter" of gndlib build,
+ * it is measured on a probe counting map for the configuration (see measure_build_halo()),
+ * a configuration of wider reach than Tile_build_halo_max_cells is built serially on the whole map.
+ */
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		class tile_builder;
+	}
+} // <--- type declaration
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// upper limit of build halo (counting cells), a configuration of wider reach is not built by tiles
+		static const int Tile_build_halo_max_cells = 16;
+		/// tile size (cells) to split a single tile counting map for parallel build
+		static const int Tile_build_split_cells = 128;
+	}
+} // <--- const variables definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief Chebyshev distance to the nearest probe
+		 */
+		inline
+		double probe_distance( const double (*probe)[2], size_t n, double x, double y ) {
+			double d = HUGE_VAL;
+
+			for( size_t k = 0; k < n; k++ ) {
+				double dk = std::max( ::fabs(x - probe[k][0]), ::fabs(y - probe[k][1]) );
+				if( dk < d ) d = dk;
+			}
+			return d;
+		}
+
+		/**
+		 * @brief measure reach of statistics map build and of its image
+		 * @details points are counted in two cells apart on a probe counting map and it is built with the configured
+		 *          parameters. the statistics cells (image pixels) that differ from the one far from both cells are reached
+		 *          by the counts. a statistics cell depends on the counting cells within the reach and half a cell
+		 *          (the points may lie anywhere in the cell).
+		 * @param [in]  cell_size : counting map cell size (m)
+		 * @param [in]  conf      : node configuration
+		 * @param [out] cells     : number of counting cells around a statistics cell that it depends on
+		 * @param [out] raster    : distance (m) around a pixel of the statistics cells that the pixel depends on
+		 * @return 0: measured, 1: the reach is not within Tile_build_halo_max_cells (not set), <0: error
+		 */
+		inline
+		int measure_build_halo( double cell_size, const node_config *conf, int *cells, double *raster ) {
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cells, -1, "invalid null pointer argument\n" );
+			gnd_assert(!raster, -1, "invalid null pointer argument\n" );
+			gnd_assert(cell_size <= 0, -1, "invalid cell size\n" );
+
+			{ // ---> operation
+				const int nmax = Tile_build_halo_max_cells;
+				// counted cells, and the reference cell far from both
+				const double probe[2][2] = {
+						{ 0.5 * cell_size, 0.5 * cell_size },
+						{ (4 * nmax + 0.5) * cell_size, (4 * nmax + 0.5) * cell_size } };
+				const double ref[2] = { (2 * nmax + 0.5) * cell_size, 0.5 * cell_size };
+				gnd::lssmap::cmap_t ws;
+				gnd::lssmap::lssmap_t lssmap;
+				gnd::bmp8_t bmp;
+				double reach = 0, reach_raster = 0;
+				int ret;
+
+				// ---> build probe counting map
+				if( gnd::lssmap::init_counting_map(&ws, cell_size, cell_size) < 0 ) return -1;
+				for( size_t k = 0; k < 2; k++ ) {
+					// points spread over the cell
+					for( int j = 0; j < 4; j++ ) {
+						gnd::lssmap::counting_map(&ws, probe[k][0] + ((j & 1) ? 0.25 : -0.25) * cell_size,
+								probe[k][1] + ((j & 2) ? 0.25 : -0.25) * cell_size);
+					}
+				}
+				ret = gnd::lssmap::build_map(&lssmap, &ws, conf->sensor_range.value, conf->additional_smoothing_parameter.value );
+				gnd::lssmap::destroy_counting_map(&ws);
+				if( ret < 0 ) return -1;
+				// <--- build probe counting map
+
+				// ---> reach of statistics cells
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					const gnd::lssmap::lss_cell *q = lssmap.plane[i].ppointer(ref[0], ref[1]);
+
+					if( !q ) {
+						gnd::lssmap::destroy_map(&lssmap);
+						return -1;
+					}
+					for( uint32_t r = 0; r < lssmap.plane[i].row(); r++ ) {
+						for( uint32_t c = 0; c < lssmap.plane[i].column(); c++ ) {
+							double x, y, d;
+
+							if( ::memcmp(lssmap.plane[i].pointer(r, c), q, sizeof(*q)) == 0 ) continue;
+							lssmap.plane[i].pget_pos_core(r, c, &x, &y);
+							if( (d = probe_distance(probe, 2, x, y)) > reach ) reach = d;
+						}
+					}
+				} // <--- reach of statistics cells
+
+				// ---> reach of image pixels
+				if( conf->image_map_pixel_size.value > 0 ) {
+					const uint8_t *q;
+
+					gnd::lssmap::build_bmp(&bmp, &lssmap, conf->image_map_pixel_size.value);
+					if( (q = bmp.ppointer(ref[0], ref[1])) ) {
+						const uint8_t v = *q;
+
+						for( uint32_t r = 0; r < bmp.row(); r++ ) {
+							for( uint32_t c = 0; c < bmp.column(); c++ ) {
+								double x, y, d;
+
+								if( *bmp.pointer(r, c) == v ) continue;
+								bmp.pget_pos_core(r, c, &x, &y);
+								if( (d = probe_distance(probe, 2, x, y)) > reach_raster ) reach_raster = d;
+							}
+						}
+					}
+					else ret = -1;
+					bmp.deallocate();
+				} // <--- reach of image pixels
+				gnd::lssmap::destroy_map(&lssmap);
+
+				if( ret < 0 ) return -1;
+				if( reach >= nmax * cell_size || reach_raster >= nmax * cell_size ) return 1;
+				*cells = (int) ::ceil( reach / cell_size + 0.5 );
+				*raster = reach_raster + 0.5 * cell_size + 0.5 * conf->image_map_pixel_size.value;
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief build halo of the configuration
+		 * @note measured once for each set of parameters (see measure_build_halo())
+		 * @param [in]  cell_size : counting map cell size (m)
+		 * @param [in]  conf      : node configuration
+		 * @param [out] cells     : number of counting cells around a statistics cell that it depends on (null: not required)
+		 * @param [out] raster    : distance (m) around a pixel of the statistics cells that the pixel depends on (null: not required)
+		 * @return 0: measured, 1: the halo is not bounded (not set), <0: error
+		 */
+		inline
+		int build_halo( double cell_size, const node_config *conf, int *cells, double *raster ) {
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				static boost::mutex mutex;
+				static double key[4] = { 0, 0, 0, 0 };
+				static int cache_ret = -1;
+				static int cache_cells = 0;
+				static double cache_raster = 0;
+				const double k[4] = { cell_size, conf->sensor_range.value, conf->additional_smoothing_parameter.value, conf->image_map_pixel_size.value };
+				boost::mutex::scoped_lock lock(mutex);
+
+				if( cache_ret < 0 || ::memcmp(key, k, sizeof(key)) != 0 ) {
+					if( (cache_ret = measure_build_halo(cell_size, conf, &cache_cells, &cache_raster)) < 0 ) return -1;
+					::memcpy(key, k, sizeof(key));
+				}
+				if( cache_ret > 0 ) return 1;
+				if( cells )		*cells = cache_cells;
+				if( raster )	*raster = cache_raster;
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief number of neighbour tile rings to cover the halo
+		 * @param [in] cmap : tiled counting map
+		 * @param [in] conf : node configuration
+		 * @return number of rings, <0: error or the halo is not bounded (see build_halo())
+		 */
+		inline
+		int tile_halo_radius( const tiled_cmap_t *cmap, const node_config *conf ) {
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				int cells;
+
+				if( cmap->tile_size <= 0 ) return 0;
+				if( build_halo(cmap->cell_size, conf, &cells, 0) != 0 ) return -1;
+				return (int) ::ceil( cells * cmap->cell_size / cmap->tile_size );
+			} // <--- operation
+		}
+
+		/**
+		 * @brief add the neighbour tiles within radius
+		 * @param [in]  keys   : tile keys
+		 * @param [in]  radius : number of neighbour tile rings
+		 * @param [out] out    : tile keys in key order
+		 */
+		inline
+		int dilate_tile_keys( const std::vector<tile_key_t> &keys, int radius, std::vector<tile_key_t> *out ) {
+			gnd_assert(!out, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				std::set<tile_key_t> ws;
+				std::vector<tile_key_t>::const_iterator it;
+
+				for( it = keys.begin(); it != keys.end(); ++it ) {
+					for( int ix = it->first - radius; ix <= it->first + radius; ix++ ) {
+						for( int iy = it->second - radius; iy <= it->second + radius; iy++ ) {
+							ws.insert( tile_key_t(ix, iy) );
+						}
+					}
+				}
+				out->assign(ws.begin(), ws.end());
+				return (int) out->size();
+			} // <--- operation
+		}
+
+		/**
+		 * @brief copy statistics cells inside a tile
+		 * @param [out] dest : statistics map
+		 * @param [in]  src  : statistics map built around the tile
+		 * @param [in]  cmap : tiled counting map
+		 * @param [in]  key  : tile key
+		 */
+		inline
+		int copy_tile_cells( gnd::lssmap::lssmap_t *dest, gnd::lssmap::lssmap_t *src, const tiled_cmap_t *cmap, const tile_key_t &key ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+
+			for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+				for( uint32_t r = 0; r < src->plane[i].row(); r++ ) {
+					for( uint32_t c = 0; c < src->plane[i].column(); c++ ) {
+						gnd::lssmap::lss_cell *d;
+						double x, y;
+
+						src->plane[i].pget_pos_core(r, c, &x, &y);
+						if( tile_key(cmap, x, y) != key ) continue;
+
+						if( !(d = dest->plane[i].ppointer(x, y)) ) {
+							dest->plane[i].reallocate(x, y);
+							if( !(d = dest->plane[i].ppointer(x, y)) ) return -1;
+						}
+						*d = *src->plane[i].pointer(r, c);
+					}
+				}
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief initialize statistics map to be filled by tiles
+		 * @details the planes are set up by a build on an empty counting map,
+		 *          so the resolution and the origin are the same as the build of the whole map
+		 * @param [out] dest      : statistics map
+		 * @param [in]  cell_size : counting map cell size (m)
+		 * @param [in]  conf      : node configuration
+		 */
+		inline
+		int init_tile_build_map( gnd::lssmap::lssmap_t *dest, double cell_size, const node_config *conf ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				gnd::lssmap::cmap_t ws;
+				int ret;
+
+				if( gnd::lssmap::init_counting_map(&ws, cell_size, cell_size) < 0 ) return -1;
+				ret = gnd::lssmap::build_map(dest, &ws, conf->sensor_range.value, conf->additional_smoothing_parameter.value );
+				gnd::lssmap::destroy_counting_map(&ws);
+				return ret < 0 ? -1 : 0;
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief tile build thread pool
+		 * @details each thread takes the next tile, gathers the counting map of the tile and its halo,
+		 *          builds it and copies the cells inside the tile into the statistics map under a lock.
+		 *          the tiled counting map is only read (evicted tiles are read from the swap files),
+		 *          so it must not be counted during the build.
+		 */
+		class tile_builder {
+		public:
+			tile_builder( gnd::lssmap::lssmap_t *dest, tiled_cmap_t *cmap, const node_config *conf );
+
+		public:
+			int build( const std::vector<tile_key_t> &keys, int nthreads );
+
+		private:
+			void run();
+			int build_tile( const tile_key_t &key );
+
+		private:
+			gnd::lssmap::lssmap_t *_dest;		///< statistics map
+			tiled_cmap_t *_cmap;				///< tiled counting map
+			const node_config *_conf;			///< configuration
+			int _radius;						///< number of neighbour tile rings of halo
+			const std::vector<tile_key_t> *_keys;	///< tiles to build
+			boost::mutex _mutex;				///< mutex for next tile, statistics map and error
+			size_t _next;						///< next tile to build
+			int _ret;							///< result
+		};
+
+		inline
+		tile_builder::tile_builder( gnd::lssmap::lssmap_t *dest, tiled_cmap_t *cmap, const node_config *conf )
+		: _dest(dest), _cmap(cmap), _conf(conf), _radius(tile_halo_radius(cmap, conf)), _keys(0), _next(0), _ret(0) {
+		}
+
+		/**
+		 * @brief build tiles
+		 * @param [in] keys     : tiles to build
+		 * @param [in] nthreads : number of threads (<= 1: on the calling thread)
+		 */
+		inline
+		int tile_builder::build( const std::vector<tile_key_t> &keys, int nthreads ) {
+			gnd_assert(!_dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_conf, -1, "invalid null pointer argument\n" );
+			if( _radius < 0 ) return -1;
+
+			_keys = &keys;
+			_next = 0;
+			_ret = 0;
+			if( nthreads <= 1 ) {
+				run();
+			}
+			else {
+				boost::thread_group threads;
+				for( int i = 0; i < nthreads; i++ ) {
+					threads.create_thread( boost::bind(&tile_builder::run, this) );
+				}
+				threads.join_all();
+			}
+			return _ret;
+		}
+
+		/**
+		 * @brief build thread
+		 */
+		inline
+		void tile_builder::run() {
+			for(;;) {
+				size_t i;
+
+				{ // ---> take next tile
+					boost::mutex::scoped_lock lock(_mutex);
+					if( _ret < 0 || _next >= _keys->size() ) break;
+					i = _next++;
+				} // <--- take next tile
+
+				if( build_tile( (*_keys)[i] ) < 0 ) {
+					boost::mutex::scoped_lock lock(_mutex);
+					_ret = -1;
+				}
+			}
+		}
+
+		/**
+		 * @brief build a tile and copy it into the statistics map
+		 */
+		inline
+		int tile_builder::build_tile( const tile_key_t &key ) {
+			gnd::lssmap::cmap_t ws;
+			gnd::lssmap::lssmap_t lssmap;
+			int ret;
+
+			if( to_counting_map(&ws, _cmap, key, _radius) < 0 ) return -1;
+			ret = gnd::lssmap::build_map(&lssmap, &ws, _conf->sensor_range.value, _conf->additional_smoothing_parameter.value );
+			gnd::lssmap::destroy_counting_map(&ws);
+			if( ret < 0 ) return -1;
+
+			{
+				boost::mutex::scoped_lock lock(_mutex);
+				ret = copy_tile_cells(_dest, &lssmap, _cmap, key);
+			}
+			gnd::lssmap::destroy_map(&lssmap);
+			return ret;
+		}
+
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief build statistics map of the whole tiled counting map on the calling thread
+		 * @details a single tile counting map is built in place, the tiles are gathered into a counting map
+		 * @param [out] dest : statistics map
+		 * @param [in]  cmap : tiled counting map
+		 * @param [in]  conf : node configuration
+		 */
+		inline
+		int build_map_serial( gnd::lssmap::lssmap_t *dest, tiled_cmap_t *cmap, const node_config *conf ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			if( cmap->tile_size <= 0 ) {
+				gnd::lssmap::cmap_t *p;
+
+				if( !(p = single_tile_map(cmap)) ) return -1;
+				return gnd::lssmap::build_map(dest, p, conf->sensor_range.value, conf->additional_smoothing_parameter.value ) < 0 ? -1 : 0;
+			}
+
+			{ // ---> gather tiles
+				gnd::lssmap::cmap_t ws;
+				int ret;
+
+				if( to_counting_map(&ws, cmap) < 0 ) return -1;
+				ret = gnd::lssmap::build_map(dest, &ws, conf->sensor_range.value, conf->additional_smoothing_parameter.value );
+				gnd::lssmap::destroy_counting_map(&ws);
+				return ret < 0 ? -1 : 0;
+			} // <--- gather tiles
+		}
+
+		/**
+		 * @brief build statistics map of the whole tiled counting map on a thread pool
+		 * @note a single tile counting map is split into tiles of Tile_build_split_cells in a temporary tiled counting map.
+		 *       the map is built serially (build_map_serial()) if the build halo is not bounded (see build_halo())
+		 * @param [out] dest     : statistics map
+		 * @param [in]  cmap     : tiled counting map
+		 * @param [in]  conf     : node configuration
+		 * @param [in]  nthreads : number of threads
+		 */
+		inline
+		int build_map_parallel( gnd::lssmap::lssmap_t *dest, tiled_cmap_t *cmap, const node_config *conf, int nthreads ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			{ // ---> bounded halo
+				int ret;
+
+				if( (ret = build_halo(cmap->cell_size, conf, 0, 0)) < 0 ) return -1;
+				if( ret > 0 ) return build_map_serial(dest, cmap, conf);
+			} // <--- bounded halo
+
+			if( cmap->tile_size <= 0 ) { // ---> split single tile
+				tiled_cmap_t split;
+				gnd::lssmap::cmap_t *p;
+				int ret;
+
+				if( !(p = single_tile_map(cmap)) ) return -1;
+				if( init_counting_map(&split, cmap->cell_size, cmap->cell_size * Tile_build_split_cells) < 0 ) return -1;
+				ret = gnd::lssmap_maker::merge_counting_map(&split, p);
+				if( ret >= 0 ) ret = build_map_parallel(dest, &split, conf, nthreads);
+				destroy_counting_map(&split);
+				return ret;
+			} // <--- split single tile
+
+			{ // ---> operation
+				std::vector<tile_key_t> counted;
+				std::vector<tile_key_t> keys;
+				std::map<tile_key_t, cmap_tile_t>::const_iterator it;
+				tile_builder builder(dest, cmap, conf);
+				int radius;
+
+				if( (radius = tile_halo_radius(cmap, conf)) < 0 ) return -1;
+				for( it = cmap->tiles.begin(); it != cmap->tiles.end(); ++it ) {
+					counted.push_back(it->first);
+				}
+				dilate_tile_keys(counted, radius, &keys);
+
+				if( init_tile_build_map(dest, cmap->cell_size, conf) < 0 ) return -1;
+				if( builder.build(keys, nthreads) < 0 ) {
+					gnd::lssmap::destroy_map(dest);
+					return -1;
+				}
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief build statistics map of tiled counting map
+		 * @details the tiles are built on map-build-threads threads, a single tile counting map on the calling thread
+		 *          is built in place, and the tiles on the calling thread one by one, so the counting map is not gathered
+		 *          unless the build halo is not bounded (see build_map_parallel())
+		 * @param [out] dest : statistics map
+		 * @param [in]  cmap : tiled counting map
+		 * @param [in]  conf : node configuration
+		 */
+		inline
+		int build_map( gnd::lssmap::lssmap_t *dest, tiled_cmap_t *cmap, const node_config *conf ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+
+			if( conf->map_build_threads.value <= 1 && cmap->tile_size <= 0 ) {
+				return build_map_serial(dest, cmap, conf);
+			}
+			return build_map_parallel(dest, cmap, conf, conf->map_build_threads.value);
+		}
+
+		/**
+		 * @brief compare statistics maps cell by cell
+		 * @param [in] a : statistics map
+		 * @param [in] b : statistics map to compare with
+		 * @return number of cells of a that differ from (or are missing in) b
+		 */
+		inline
+		int compare_map( gnd::lssmap::lssmap_t *a, gnd::lssmap::lssmap_t *b ) {
+			gnd_assert(!a, -1, "invalid null pointer argument\n" );
+			gnd_assert(!b, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				int cnt = 0;
+
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					for( uint32_t r = 0; r < a->plane[i].row(); r++ ) {
+						for( uint32_t c = 0; c < a->plane[i].column(); c++ ) {
+							const gnd::lssmap::lss_cell *p = a->plane[i].pointer(r, c);
+							const gnd::lssmap::lss_cell *q;
+							double x, y;
+
+							a->plane[i].pget_pos_core(r, c, &x, &y);
+							q = b->plane[i].ppointer(x, y);
+							if( !q || ::memcmp(p, q, sizeof(*p)) != 0 ) cnt++;
+						}
+					}
+				}
+				return cnt;
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_TILE_BUILD_HPP_ */
@@ -0,0 +1,1027 @@
+/*
+ * gnd_lssmap_maker_tiled_cmap.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: sparse TILED Counting MAP, tiles are allocated on first hit and optionally evicted to disk or packed in memory
+ */
+
+#ifndef GND_LSSMAP_MAKER_TILED_CMAP_HPP_
+#define GND_LSSMAP_MAKER_TILED_CMAP_HPP_
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <map>
+#include <vector>
+#include <utility>
+
+#include <boost/thread/mutex.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_cmap_binary.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct cmap_tile;
+		typedef struct cmap_tile cmap_tile_t;
+
+		struct tile_share;
+		typedef struct tile_share tile_share_t;
+
+		struct tiled_cmap;
+		typedef struct tiled_cmap tiled_cmap_t;
+
+		typedef std::pair<int, int> tile_key_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief counting map of a tile shared with a reader on another thread
+		 * @details the tile copies the counting map before it is counted while the reader references it (copy on write),
+		 *          the last reference releases it (see share_tile(), release_tile_share())
+		 */
+		struct tile_share {
+			gnd::lssmap::cmap_t *cmap;		///< shared counting map
+			int refs;						///< number of references (under tile_share_mutex())
+		};
+
+		/**
+		 * @brief tile of counting map
+		 * @note a tile is a gnd::lssmap::cmap_t that only holds points in its square.
+		 *       a cell on the tile border may be held by two tiles, merging them adds the cells
+		 */
+		struct cmap_tile {
+			gnd::lssmap::cmap_t *cmap;		///< counting map of this tile (null: evicted or not allocated)
+			uint64_t tick;					///< last access tick
+			uint64_t modified;				///< generation of last counting (0: not counted)
+			bool flg_evicted;				///< stored in the swap directory or packed
+			bool flg_stored;				///< the stored image is the same as cmap (not counted since), evict without packing
+			std::vector<uint8_t> packed;	///< packed counting map of evicted tile (without swap directory)
+			tile_share_t *share;			///< cmap is shared with a reader (null: not shared)
+		};
+
+		/**
+		 * @brief sparse tiled counting map
+		 * @details tile_size <= 0 means a single tile that covers everything (same as plain counting map)
+		 */
+		struct tiled_cmap {
+			double cell_size;							///< cell size (m)
+			double tile_size;							///< tile size (m)
+			size_t max_resident;						///< maximum number of tiles in memory (0: unlimited)
+			char swap_dir[256];							///< directory to evict tiles (empty: packed in memory)
+			bool flg_compact;							///< evict tiles in compact layout (lossy), otherwise exact
+			std::map<tile_key_t, cmap_tile_t> tiles;	///< tiles
+			size_t nresident;							///< number of tiles in memory
+			uint64_t tick;								///< access tick
+			tile_key_t last_key;						///< last accessed tile key
+			cmap_tile_t *last;							///< last accessed tile
+			uint64_t generation;						///< current generation, see next_generation()
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief initialize tiled counting map
+		 * @param [out] m            : tiled counting map
+		 * @param [in]  cell_size    : cell size (m)
+		 * @param [in]  tile_size    : tile size (m), <= 0: single tile
+		 * @param [in]  max_resident : maximum number of tiles in memory, 0: unlimited
+		 * @param [in]  swap_dir     : directory to evict tiles (null or empty: packed in memory)
+		 * @param [in]  compact      : evict tiles in compact layout, otherwise in exact layout (dense file or packed wide cells)
+		 */
+		inline
+		int init_counting_map( tiled_cmap_t *m, double cell_size, double tile_size = 0, size_t max_resident = 0, const char *swap_dir = 0, bool compact = false ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+			gnd_assert(cell_size <= 0, -1, "invalid argument\n" );
+
+			m->cell_size = cell_size;
+			m->tile_size = tile_size > 0 ? tile_size : 0;
+			m->max_resident = m->tile_size > 0 ? max_resident : 0;
+			::snprintf(m->swap_dir, sizeof(m->swap_dir), "%s", swap_dir ? swap_dir : "");
+			m->flg_compact = compact;
+			m->tiles.clear();
+			m->nresident = 0;
+			m->tick = 0;
+			m->last = 0;
+			m->generation = 1;
+			return 0;
+		}
+
+		/**
+		 * @brief file name of a tile in a directory
+		 */
+		inline
+		int tile_fname( const char *dir, const tile_key_t &key, char *fname, size_t size ) {
+			return ::snprintf(fname, size, "%s/tile_%d_%d.cmap", dir, key.first, key.second) < (int)size ? 0 : -1;
+		}
+
+		/**
+		 * @brief tile key of a tile file name (without directory)
+		 * @return 0: tile file, <0: other file
+		 */
+		inline
+		int parse_tile_fname( const char *name, tile_key_t *key ) {
+			int x, y;
+			char tail[8];
+
+			if( ::sscanf(name, "tile_%d_%d%7s", &x, &y, tail) != 3 || ::strcmp(tail, ".cmap") != 0 ) return -1;
+			*key = tile_key_t(x, y);
+			return 0;
+		}
+
+		/**
+		 * @brief swap file name of a tile
+		 */
+		inline
+		int tile_swap_fname( const tiled_cmap_t *m, const tile_key_t &key, char *fname, size_t size ) {
+			return tile_fname(m->swap_dir, key, fname, size);
+		}
+
+		/**
+		 * @brief mutex for reference counts of shared tiles
+		 */
+		inline
+		boost::mutex& tile_share_mutex() {
+			static boost::mutex mutex;
+			return mutex;
+		}
+
+		/**
+		 * @brief release a reference of shared counting map, the last reference destroys it
+		 */
+		inline
+		void release_tile_share( tile_share_t *share ) {
+			bool flg_last;
+
+			if( !share ) return;
+			{
+				boost::mutex::scoped_lock lock(tile_share_mutex());
+				flg_last = --share->refs <= 0;
+			}
+			if( flg_last ) {
+				gnd::lssmap::destroy_counting_map(share->cmap);
+				delete share->cmap;
+				delete share;
+			}
+		}
+
+		/**
+		 * @brief make the counting map of a tile its own before it is counted
+		 * @details if the reader still references the counting map, it is copied and the reader keeps the old one
+		 * @return 0: own, 1: copied, <0: error
+		 */
+		inline
+		int unshare_tile( cmap_tile_t *tile ) {
+			gnd_assert(!tile, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				tile_share_t *share = tile->share;
+				gnd::lssmap::cmap_t *copy;
+
+				if( !share ) return 0;
+				{
+					boost::mutex::scoped_lock lock(tile_share_mutex());
+					// the reader released it, only the tile references it
+					if( share->refs <= 1 ) {
+						lock.unlock();
+						delete share;
+						tile->share = 0;
+						return 0;
+					}
+				}
+
+				// the reference of the tile keeps the counting map while copying
+				copy = new gnd::lssmap::cmap_t;
+				if( gnd::lssmap::init_counting_map(copy, counting_map_cell_size(share->cmap), counting_map_cell_size(share->cmap)) < 0 ) {
+					delete copy;
+					return -1;
+				}
+				if( merge_counting_map(copy, share->cmap) < 0 ) {
+					gnd::lssmap::destroy_counting_map(copy);
+					delete copy;
+					return -1;
+				}
+				tile->cmap = copy;
+				tile->share = 0;
+				release_tile_share(share);
+				return 1;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief release the counting map of a tile in memory
+		 */
+		inline
+		void release_tile_cmap( cmap_tile_t *tile ) {
+			if( tile->share ) {
+				// the reader may still reference it
+				release_tile_share(tile->share);
+				tile->share = 0;
+			}
+			else if( tile->cmap ) {
+				gnd::lssmap::destroy_counting_map(tile->cmap);
+				delete tile->cmap;
+			}
+			tile->cmap = 0;
+		}
+
+		/**
+		 * @brief read evicted tile from swap directory or packed memory
+		 * @param [in]  m    : tiled counting map
+		 * @param [in]  key  : tile key
+		 * @param [in]  tile : evicted tile
+		 * @param [out] dest : counting map of the tile (initialized in this function)
+		 */
+		inline
+		int read_evicted_tile( const tiled_cmap_t *m, const tile_key_t &key, const cmap_tile_t *tile, gnd::lssmap::cmap_t *dest ) {
+			if( !m->swap_dir[0] ) {
+				return tile->packed.empty() ? -1 : unpack_counting_map(dest, &tile->packed[0], tile->packed.size());
+			}
+			else {
+				char fname[512];
+				if( tile_swap_fname(m, key, fname, sizeof(fname)) < 0 ) return -1;
+				return read_counting_map_binary(dest, fname);
+			}
+		}
+
+		/**
+		 * @brief mark a tile counted, its stored image is out of date
+		 */
+		inline
+		void modify_tile( tiled_cmap_t *m, cmap_tile_t *tile ) {
+			tile->modified = m->generation;
+			if( tile->flg_stored ) {
+				tile->flg_stored = false;
+				std::vector<uint8_t>().swap(tile->packed);
+			}
+		}
+
+		/**
+		 * @brief evict least recently used tile to swap directory, or pack it in memory without swap directory
+		 * @details a tile not counted since it was loaded keeps its stored image and is released without packing,
+		 *          so evict and reload cycles of a tile do not round its statistics again. the exact layout
+		 *          (dense file or wide cells) restores the cells without error; in compact layout a tile is rounded
+		 *          once per eviction after it is counted (see the error bound in gnd_lssmap_maker_cmap_binary.hpp)
+		 */
+		inline
+		int evict_tile( tiled_cmap_t *m ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::iterator it, lru = m->tiles.end();
+				char fname[512];
+
+				for( it = m->tiles.begin(); it != m->tiles.end(); ++it ) {
+					if( !it->second.cmap ) continue;
+					if( lru == m->tiles.end() || it->second.tick < lru->second.tick ) lru = it;
+				}
+				if( lru == m->tiles.end() ) return 0;
+
+				if( lru->second.flg_stored ) {
+					// the stored image is up to date
+				}
+				else if( !m->swap_dir[0] ) {
+					if( pack_counting_map(lru->second.cmap, &lru->second.packed, !m->flg_compact) < 0 )	return -1;
+				}
+				else {
+					if( tile_swap_fname(m, lru->first, fname, sizeof(fname)) < 0 )					return -1;
+					if( write_counting_map_binary(lru->second.cmap, fname, m->flg_compact) < 0 )	return -1;
+				}
+				release_tile_cmap(&lru->second);
+				lru->second.flg_evicted = true;
+				lru->second.flg_stored = true;
+				m->nresident--;
+				if( m->last == &lru->second ) m->last = 0;
+				return 1;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief get tile in memory, allocate or load from swap directory if needed
+		 * @param [in,out] m   : tiled counting map
+		 * @param [in]     key : tile key
+		 * @return tile (null: error)
+		 */
+		inline
+		cmap_tile_t* tile_pointer( tiled_cmap_t *m, const tile_key_t &key ) {
+			gnd_assert(!m, 0, "invalid null pointer argument\n" );
+
+			if( m->last && m->last_key == key ) {
+				m->last->tick = ++m->tick;
+				return m->last;
+			}
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::iterator it = m->tiles.find(key);
+				cmap_tile_t *tile;
+
+				if( it == m->tiles.end() ) {
+					cmap_tile_t ws;
+					ws.cmap = 0;
+					ws.tick = 0;
+					ws.modified = 0;
+					ws.flg_evicted = false;
+					ws.flg_stored = false;
+					ws.share = 0;
+					it = m->tiles.insert( std::make_pair(key, ws) ).first;
+				}
+				tile = &it->second;
+
+				if( !tile->cmap ) {
+					// keep the number of tiles in memory
+					if( m->max_resident > 0 && m->nresident >= m->max_resident ) {
+						if( evict_tile(m) < 0 ) return 0;
+					}
+
+					tile->cmap = new gnd::lssmap::cmap_t;
+					if( tile->flg_evicted ) {
+						if( read_evicted_tile(m, key, tile, tile->cmap) < 0 ) {
+							delete tile->cmap;
+							tile->cmap = 0;
+							return 0;
+						}
+						// the packed image is kept until the tile is counted (see modify_tile())
+					}
+					else if( gnd::lssmap::init_counting_map(tile->cmap, m->cell_size, m->cell_size) < 0 ) {
+						delete tile->cmap;
+						tile->cmap = 0;
+						return 0;
+					}
+					m->nresident++;
+				}
+
+				tile->tick = ++m->tick;
+				m->last_key = key;
+				m->last = tile;
+				return tile;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief tile key of a position
+		 */
+		inline
+		tile_key_t tile_key( const tiled_cmap_t *m, double x, double y ) {
+			if( m->tile_size <= 0 ) return tile_key_t(0, 0);
+			return tile_key_t( (int) ::floor(x / m->tile_size), (int) ::floor(y / m->tile_size) );
+		}
+
+		/**
+		 * @brief count a point
+		 * @param [in,out] m : tiled counting map
+		 * @param [in]     x : x on global coordinate
+		 * @param [in]     y : y on global coordinate
+		 */
+		inline
+		int counting_map( tiled_cmap_t *m, double x, double y ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				cmap_tile_t *tile = tile_pointer(m, tile_key(m, x, y));
+				if( !tile ) return -1;
+				if( tile->share && unshare_tile(tile) < 0 ) return -1;
+				modify_tile(m, tile);
+				return gnd::lssmap::counting_map(tile->cmap, x, y);
+			} // <--- operation
+		}
+
+		/**
+		 * @brief counting map of single tile counting map, to be used in place without gathering
+		 * @param [in,out] m : tiled counting map (tile_size <= 0)
+		 * @return counting map (allocated if not counted yet, null: error or tiled)
+		 */
+		inline
+		gnd::lssmap::cmap_t* single_tile_map( tiled_cmap_t *m ) {
+			gnd_assert(!m, 0, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				cmap_tile_t *tile;
+
+				if( m->tile_size > 0 ) return 0;
+				if( !(tile = tile_pointer(m, tile_key_t(0, 0))) ) return 0;
+				return tile->cmap;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief get cell size of tiled counting map
+		 */
+		inline
+		double counting_map_cell_size( const tiled_cmap_t *m ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+			return m->cell_size;
+		}
+
+		/**
+		 * @brief add all counting cells of a plain counting map to tiled counting map
+		 * @param [out] dest : tiled counting map
+		 * @param [in]  src  : plain counting map
+		 * @return number of merged cells
+		 */
+		inline
+		int merge_counting_map( tiled_cmap_t *dest, gnd::lssmap::cmap_t *src ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+
+			if( dest->tile_size <= 0 ) {
+				cmap_tile_t *tile = tile_pointer(dest, tile_key_t(0, 0));
+				if( !tile ) return -1;
+				if( tile->share && unshare_tile(tile) < 0 ) return -1;
+				modify_tile(dest, tile);
+				return merge_counting_map(tile->cmap, src);
+			}
+
+			{ // ---> operation
+				int cnt = 0;
+
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					for( uint32_t r = 0; r < src->plane[i].row(); r++ ) {
+						for( uint32_t c = 0; c < src->plane[i].column(); c++ ) {
+							count_cell_t *s = src->plane[i].pointer(r, c);
+							count_cell_t *d;
+							cmap_tile_t *tile;
+							double x, y;
+
+							if( !s || s->n == 0 ) continue;
+
+							src->plane[i].pget_pos_core(r, c, &x, &y);
+							if( !(tile = tile_pointer(dest, tile_key(dest, x, y))) ) return -1;
+							if( tile->share && unshare_tile(tile) < 0 ) return -1;
+							modify_tile(dest, tile);
+							if( !(d = tile->cmap->plane[i].ppointer(x, y)) ) {
+								tile->cmap->plane[i].reallocate(x, y);
+								if( !(d = tile->cmap->plane[i].ppointer(x, y)) ) return -1;
+							}
+
+							add_count_cell(d, s);
+							cnt++;
+						}
+					}
+				}
+				return cnt;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief get counting map of a tile without loading it into the tiled map
+		 * @note an evicted tile is read from the swap directory (or unpacked) into the work space
+		 * @param [in]  src  : tiled counting map
+		 * @param [in]  key  : tile key
+		 * @param [out] ws   : work space to read an evicted tile
+		 * @param [out] cmap : counting map of the tile (null: no tile)
+		 * @return 0: tile in memory or no tile, 1: read into ws (release with gnd::lssmap::destroy_counting_map()), <0: error
+		 */
+		inline
+		int tile_counting_map( tiled_cmap_t *src, const tile_key_t &key, gnd::lssmap::cmap_t *ws, gnd::lssmap::cmap_t **cmap ) {
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+			gnd_assert(!ws, -1, "invalid null pointer argument\n" );
+			gnd_assert(!cmap, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::iterator it = src->tiles.find(key);
+
+				*cmap = 0;
+				if( it == src->tiles.end() ) return 0;
+				if( it->second.cmap ) {
+					*cmap = it->second.cmap;
+					return 0;
+				}
+				else if( it->second.flg_evicted ) {
+					if( read_evicted_tile(src, key, &it->second, ws) < 0 )	return -1;
+					*cmap = ws;
+					return 1;
+				}
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief share the counting map of a tile with a reader on another thread (copy on write)
+		 * @details the counting map in memory is not copied, the tile copies it before it is counted again
+		 *          while the reader references it (see unshare_tile()). an evicted tile is read into a counting map
+		 *          that only the reader references
+		 * @param [in,out] m   : tiled counting map
+		 * @param [in]     key : tile key
+		 * @return shared counting map (release with release_tile_share()), null: error or no tile
+		 */
+		inline
+		tile_share_t* share_tile( tiled_cmap_t *m, const tile_key_t &key ) {
+			gnd_assert(!m, 0, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::iterator it = m->tiles.find(key);
+				tile_share_t *share;
+
+				if( it == m->tiles.end() ) return 0;
+				if( it->second.cmap ) {
+					boost::mutex::scoped_lock lock(tile_share_mutex());
+
+					if( !it->second.share ) {
+						it->second.share = new tile_share_t;
+						it->second.share->cmap = it->second.cmap;
+						it->second.share->refs = 1;
+					}
+					it->second.share->refs++;
+					return it->second.share;
+				}
+				else if( it->second.flg_evicted ) {
+					share = new tile_share_t;
+					share->cmap = new gnd::lssmap::cmap_t;
+					share->refs = 1;
+					if( read_evicted_tile(m, key, &it->second, share->cmap) < 0 ) {
+						delete share->cmap;
+						delete share;
+						return 0;
+					}
+					return share;
+				}
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief add a tile to plain counting map
+		 * @note an evicted tile is read from the swap directory (or unpacked) without being loaded into the tiled map
+		 * @param [out] dest : plain counting map
+		 * @param [in]  src  : tiled counting map
+		 * @param [in]  key  : tile key
+		 */
+		inline
+		int merge_tile( gnd::lssmap::cmap_t *dest, tiled_cmap_t *src, const tile_key_t &key ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				gnd::lssmap::cmap_t ws;
+				gnd::lssmap::cmap_t *p;
+				int loaded, ret;
+
+				if( (loaded = tile_counting_map(src, key, &ws, &p)) < 0 ) return -1;
+				if( !p ) return 0;
+				ret = merge_counting_map(dest, p);
+				if( loaded ) gnd::lssmap::destroy_counting_map(&ws);
+				return ret < 0 ? -1 : 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief build plain counting map from tiled counting map
+		 * @note tiles are merged in key order, so the result is deterministic.
+		 *       evicted tiles are loaded one by one and released
+		 * @param [out] dest : plain counting map (initialized in this function)
+		 * @param [in]  src  : tiled counting map
+		 */
+		inline
+		int to_counting_map( gnd::lssmap::cmap_t *dest, tiled_cmap_t *src ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+
+			if( gnd::lssmap::init_counting_map(dest, src->cell_size, src->cell_size) < 0 ) return -1;
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::iterator it;
+
+				for( it = src->tiles.begin(); it != src->tiles.end(); ++it ) {
+					if( merge_tile(dest, src, it->first) < 0 ) {
+						gnd::lssmap::destroy_counting_map(dest);
+						return -1;
+					}
+				}
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief build plain counting map from a tile and its neighbours
+		 * @param [out] dest   : plain counting map (initialized in this function)
+		 * @param [in]  src    : tiled counting map
+		 * @param [in]  key    : center tile key
+		 * @param [in]  radius : number of neighbour tile rings
+		 */
+		inline
+		int to_counting_map( gnd::lssmap::cmap_t *dest, tiled_cmap_t *src, const tile_key_t &key, int radius ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+
+			if( gnd::lssmap::init_counting_map(dest, src->cell_size, src->cell_size) < 0 ) return -1;
+
+			for( int ix = key.first - radius; ix <= key.first + radius; ix++ ) {
+				for( int iy = key.second - radius; iy <= key.second + radius; iy++ ) {
+					if( merge_tile(dest, src, tile_key_t(ix, iy)) < 0 ) {
+						gnd::lssmap::destroy_counting_map(dest);
+						return -1;
+					}
+				}
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief extent of planes that covers every tile
+		 * @details the planes are aligned on the grid of a counting map of the cell size and cover the tile squares
+		 *          with a cell around them, where the cells held by the tiles lie
+		 * @param [in]  m      : tiled counting map (tile_size > 0)
+		 * @param [out] planes : extent of each plane
+		 */
+		inline
+		int tiled_plane_extent( const tiled_cmap_t *m, cmap_binary_plane_t *planes ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+			gnd_assert(!planes, -1, "invalid null pointer argument\n" );
+			gnd_assert(m->tile_size <= 0 || m->tiles.empty(), -1, "invalid argument\n" );
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::const_iterator it = m->tiles.begin();
+				tile_key_t lower = it->first, upper = it->first;
+				gnd::lssmap::cmap_t ws;
+				double x0, y0, x1, y1;
+
+				for( ++it; it != m->tiles.end(); ++it ) {
+					if( it->first.first < lower.first )		lower.first = it->first.first;
+					if( it->first.second < lower.second )	lower.second = it->first.second;
+					if( it->first.first > upper.first )		upper.first = it->first.first;
+					if( it->first.second > upper.second )	upper.second = it->first.second;
+				}
+				x0 = lower.first * m->tile_size - m->cell_size;
+				y0 = lower.second * m->tile_size - m->cell_size;
+				x1 = (upper.first + 1) * m->tile_size + m->cell_size;
+				y1 = (upper.second + 1) * m->tile_size + m->cell_size;
+
+				// the lower edge of the cell at the lower corner is the origin of each plane
+				if( gnd::lssmap::init_counting_map(&ws, m->cell_size, m->cell_size) < 0 ) return -1;
+				for( size_t i = 0; i < gnd::lssmap::PlaneNum; i++ ) {
+					uint32_t r, c;
+					double x, y;
+
+					if( !binary_cell_pointer(&ws, i, x0, y0) || ws.plane[i].pindex(x0, y0, &r, &c) < 0 ) {
+						gnd::lssmap::destroy_counting_map(&ws);
+						return -1;
+					}
+					ws.plane[i].pget_pos_core(r, c, &x, &y);
+					planes[i].xorg = x - m->cell_size / 2;
+					planes[i].yorg = y - m->cell_size / 2;
+					planes[i].columns = (uint32_t) ::ceil( (x1 - planes[i].xorg) / m->cell_size );
+					planes[i].rows = (uint32_t) ::ceil( (y1 - planes[i].yorg) / m->cell_size );
+				}
+				gnd::lssmap::destroy_counting_map(&ws);
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief write tiled counting map in binary format, tile row by tile row
+		 * @details the file is read as the gathered counting map, the plane extents cover the tiles (see tiled_plane_extent()).
+		 *          the rows of cells whose cores lie in a tile row are gathered from the tile row and its neighbour tile rows
+		 *          (a cell on the tile border may be held by two tiles), so three tile rows are in memory at once.
+		 *          the cells of dense layout are written at their place in the file, the counted cells of compact layout
+		 *          are kept until every tile row is visited. a single tile counting map is written in place
+		 * @note written into "<fname>.tmp" and renamed, so a reader never sees a partial file
+		 * @param [in] m       : tiled counting map
+		 * @param [in] fname   : file name
+		 * @param [in] compact : compact layout
+		 */
+		inline
+		int write_counting_map_binary( tiled_cmap_t *m, const char *fname, bool compact = false ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+			gnd_assert(!fname, -1, "invalid null pointer argument\n" );
+
+			if( m->tile_size <= 0 ) {
+				gnd::lssmap::cmap_t *p = single_tile_map(m);
+				return p ? write_counting_map_binary(p, fname, compact) : -1;
+			}
+			if( m->tiles.empty() ) {
+				gnd::lssmap::cmap_t ws;
+				int ret;
+
+				if( gnd::lssmap::init_counting_map(&ws, m->cell_size, m->cell_size) < 0 ) return -1;
+				ret = write_counting_map_binary(&ws, fname, compact);
+				gnd::lssmap::destroy_counting_map(&ws);
+				return ret;
+			}
+
+			{ // ---> operation
+				const size_t nplanes = gnd::lssmap::PlaneNum;
+				cmap_binary_header_t header;
+				cmap_binary_plane_t planes[gnd::lssmap::PlaneNum];
+				uint64_t offset[gnd::lssmap::PlaneNum + 1];		// file offset of dense cells of each plane (and end of file)
+				uint32_t next[gnd::lssmap::PlaneNum];			// next row of each plane
+				std::vector<cmap_compact_cell_t> ccells[gnd::lssmap::PlaneNum];
+				std::vector<cmap_binary_wide_cell_t> wcells[gnd::lssmap::PlaneNum];
+				std::vector<cmap_binary_cell_t> row;
+				std::map<tile_key_t, cmap_tile_t>::iterator it;
+				int ky, ky_end;
+				char fname_tmp[1024];
+				FILE *fp;
+
+				if( ::snprintf(fname_tmp, sizeof(fname_tmp), "%s.tmp", fname) >= (int)sizeof(fname_tmp) ) return -1;
+				if( tiled_plane_extent(m, planes) < 0 ) return -1;
+
+				offset[0] = sizeof(header) + sizeof(planes[0]) * nplanes;
+				for( size_t i = 0; i < nplanes; i++ ) {
+					uint64_t ncells = (uint64_t) planes[i].rows * planes[i].columns;
+					if( compact && ncells > 0xffffffffULL ) return -1;
+					offset[i + 1] = offset[i] + sizeof(cmap_binary_cell_t) * ncells;
+					next[i] = 0;
+				}
+
+				// cells held by the tiles lie in the tile rows from the lowest - 1 to the highest + 1
+				ky = ky_end = m->tiles.begin()->first.second;
+				for( it = m->tiles.begin(); it != m->tiles.end(); ++it ) {
+					if( it->first.second < ky )		ky = it->first.second;
+					if( it->first.second > ky_end )	ky_end = it->first.second;
+				}
+				ky--;
+				ky_end++;
+
+				if( !(fp = ::fopen(fname_tmp, "wb")) ) return -1;
+				if( !compact ) {
+					// headers, and extend the file to the full size, the cells not written are zero
+					binary_header(&header, m->cell_size, false);
+					if( ::fwrite(&header, sizeof(header), 1, fp) != 1 )				goto error;
+					if( ::fwrite(planes, sizeof(planes[0]), nplanes, fp) != nplanes )	goto error;
+					if( ::fflush(fp) != 0 || ::ftruncate(::fileno(fp), (off_t) offset[nplanes]) < 0 )	goto error;
+				}
+
+				for( ; ky <= ky_end; ky++ ) { // ---> tile row
+					gnd::lssmap::cmap_t ws;
+					int ngathered = 0;
+
+					// ---> gather the tile row and its neighbour tile rows
+					if( gnd::lssmap::init_counting_map(&ws, m->cell_size, m->cell_size) < 0 ) goto error;
+					for( it = m->tiles.begin(); it != m->tiles.end(); ++it ) {
+						if( it->first.second < ky - 1 || it->first.second > ky + 1 ) continue;
+						if( merge_tile(&ws, m, it->first) < 0 ) {
+							gnd::lssmap::destroy_counting_map(&ws);
+							goto error;
+						}
+						ngathered++;
+					} // <--- gather the tile row and its neighbour tile rows
+
+					// ---> rows of cells whose cores lie in the tile row
+					for( size_t i = 0; i < nplanes; i++ ) {
+						for( ; next[i] < planes[i].rows; next[i]++ ) {
+							const uint32_t r = next[i];
+							const double y = planes[i].yorg + (r + 0.5) * m->cell_size;
+
+							if( (int) ::floor(y / m->tile_size) > ky ) break;
+							if( ngathered == 0 ) continue;
+
+							if( compact ) {
+								for( uint32_t c = 0; c < planes[i].columns; c++ ) {
+									count_cell_t *p = ws.plane[i].ppointer(planes[i].xorg + (c + 0.5) * m->cell_size, y);
+									if( p && p->n > 0 ) compact_cell(p, r * planes[i].columns + c, &ccells[i], &wcells[i]);
+								}
+							}
+							else {
+								row.resize(planes[i].columns);
+								for( uint32_t c = 0; c < planes[i].columns; c++ ) {
+									binary_cell(&row[c], ws.plane[i].ppointer(planes[i].xorg + (c + 0.5) * m->cell_size, y));
+								}
+								if( row.empty() ) continue;
+								if( ::fseeko(fp, (off_t) (offset[i] + sizeof(row[0]) * r * planes[i].columns), SEEK_SET) < 0
+								||  ::fwrite(&row[0], sizeof(row[0]), row.size(), fp) != row.size() ) {
+									gnd::lssmap::destroy_counting_map(&ws);
+									goto error;
+								}
+							}
+						}
+					} // <--- rows of cells whose cores lie in the tile row
+					gnd::lssmap::destroy_counting_map(&ws);
+				} // <--- tile row
+
+				if( compact ) { // ---> compact layout
+					binary_header(&header, m->cell_size, true);
+					if( ::fwrite(&header, sizeof(header), 1, fp) != 1 ) goto error;
+					for( size_t i = 0; i < nplanes; i++ ) {
+						cmap_compact_plane_t plane;
+
+						::memset(&plane, 0, sizeof(plane));
+						plane.xorg = planes[i].xorg;
+						plane.yorg = planes[i].yorg;
+						plane.rows = planes[i].rows;
+						plane.columns = planes[i].columns;
+						plane.ncompact = (uint32_t) ccells[i].size();
+						plane.nwide = (uint32_t) wcells[i].size();
+						if( ::fwrite(&plane, sizeof(plane), 1, fp) != 1 ) goto error;
+					}
+					// wide cells first, they keep 8 byte alignment
+					for( size_t i = 0; i < nplanes; i++ ) {
+						if( !wcells[i].empty() && ::fwrite(&wcells[i][0], sizeof(wcells[i][0]), wcells[i].size(), fp) != wcells[i].size() ) goto error;
+					}
+					for( size_t i = 0; i < nplanes; i++ ) {
+						if( !ccells[i].empty() && ::fwrite(&ccells[i][0], sizeof(ccells[i][0]), ccells[i].size(), fp) != ccells[i].size() ) goto error;
+					}
+				} // <--- compact layout
+
+				if( ::fclose(fp) != 0 ) {
+					::unlink(fname_tmp);
+					return -1;
+				}
+				return ::rename(fname_tmp, fname) == 0 ? 0 : -1;
+
+			error:
+				::fclose(fp);
+				::unlink(fname_tmp);
+				return -1;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief close current generation of counting
+		 * @details every consumer of the counted tiles (live map, checkpoint) keeps its own generation.
+		 *          the tiles counted until this call have modified <= return value,
+		 *          the tiles counted after this call have modified > return value.
+		 * @return closed generation
+		 */
+		inline
+		uint64_t next_generation( tiled_cmap_t *m ) {
+			gnd_assert(!m, 0, "invalid null pointer argument\n" );
+			return m->generation++;
+		}
+
+		/**
+		 * @brief get tiles counted since a generation
+		 * @param [in]  m     : tiled counting map
+		 * @param [in]  since : generation (tiles with modified >= since)
+		 * @param [out] keys  : tile keys in key order
+		 * @return number of tiles
+		 */
+		inline
+		int modified_tiles( const tiled_cmap_t *m, uint64_t since, std::vector<tile_key_t> *keys ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+			gnd_assert(!keys, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::const_iterator it;
+
+				keys->clear();
+				for( it = m->tiles.begin(); it != m->tiles.end(); ++it ) {
+					if( it->second.modified > 0 && it->second.modified >= since ) keys->push_back(it->first);
+				}
+				return (int) keys->size();
+			} // <--- operation
+		}
+
+		/**
+		 * @brief read a directory of tile files (e.g. checkpoint) into tiled counting map
+		 * @note the tiles are merged one by one, so the tile size of the directory and of the map may differ
+		 * @param [out] m   : tiled counting map
+		 * @param [in]  dir : directory of binary counting map files "tile_<x>_<y>.cmap"
+		 * @return number of read tiles (0: not a directory of tiles)
+		 */
+		inline
+		int read_counting_map_tiles( tiled_cmap_t *m, const char *dir ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				struct stat st;
+				struct dirent *e;
+				DIR *d;
+				int cnt = 0;
+
+				if( ::stat(dir, &st) != 0 || !S_ISDIR(st.st_mode) ) return 0;
+				if( !(d = ::opendir(dir)) ) return -1;
+				while( (e = ::readdir(d)) != 0 ) {
+					gnd::lssmap::cmap_t ws;
+					tile_key_t key;
+					char fname[512];
+					int ret;
+
+					if( parse_tile_fname(e->d_name, &key) < 0 ) continue;
+					if( ::snprintf(fname, sizeof(fname), "%s/%s", dir, e->d_name) >= (int)sizeof(fname)
+					||  read_counting_map_binary(&ws, fname) < 0 ) {
+						::closedir(d);
+						return -1;
+					}
+					if( cnt == 0 ) m->cell_size = counting_map_cell_size(&ws);
+					ret = merge_counting_map(m, &ws);
+					gnd::lssmap::destroy_counting_map(&ws);
+					if( ret < 0 ) {
+						::closedir(d);
+						return -1;
+					}
+					cnt++;
+				}
+				::closedir(d);
+				return cnt;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief read counting map (binary file, directory of tile files or text file directory) into tiled counting map
+		 * @param [in,out] m    : tiled counting map (initialized)
+		 * @param [in]     path : binary file name, directory of tile files (see read_counting_map_tiles()) or text file directory
+		 */
+		inline
+		int read_counting_map_any( tiled_cmap_t *m, const char *path ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+			gnd_assert(!path, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				gnd::lssmap::cmap_t ws;
+				int ret;
+
+				if( (ret = read_counting_map_tiles(m, path)) != 0 ) return ret < 0 ? -1 : 0;
+				if( read_counting_map_any(&ws, path) < 0 ) return -1;
+				m->cell_size = counting_map_cell_size(&ws);
+				ret = merge_counting_map(m, &ws);
+				gnd::lssmap::destroy_counting_map(&ws);
+				return ret < 0 ? -1 : 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief release tiled counting map and its swap files
+		 */
+		inline
+		int destroy_counting_map( tiled_cmap_t *m ) {
+			gnd_assert(!m, -1, "invalid null pointer argument\n" );
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::iterator it;
+
+				for( it = m->tiles.begin(); it != m->tiles.end(); ++it ) {
+					release_tile_cmap(&it->second);
+					if( it->second.flg_evicted && m->swap_dir[0] ) {
+						char fname[512];
+						if( tile_swap_fname(m, it->first, fname, sizeof(fname)) == 0 ) ::unlink(fname);
+					}
+				}
+				m->tiles.clear();
+				m->nresident = 0;
+				m->last = 0;
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief reduce tiled counting map into the next coarser level of pyramid, tile by tile
+		 * @details each tile is reduced by reduce_counting_map() and added to the coarse map. the reduction is
+		 *          linear in the counts, so the result is the same as the reduction of the gathered counting map.
+		 *          the coarse map has the same tile size and number of tiles in memory, the others are packed in memory
+		 * @param [out] dest : coarse tiled counting map (initialized in this function)
+		 * @param [in]  src  : fine tiled counting map
+		 * @return number of reduced cells
+		 */
+		inline
+		int reduce_counting_map( tiled_cmap_t *dest, tiled_cmap_t *src ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!src, -1, "invalid null pointer argument\n" );
+
+			if( init_counting_map(dest, 2 * src->cell_size, src->tile_size, src->max_resident, "", src->max_resident > 0) < 0 ) return -1;
+
+			{ // ---> operation
+				std::map<tile_key_t, cmap_tile_t>::iterator it;
+				int cnt = 0;
+
+				for( it = src->tiles.begin(); it != src->tiles.end(); ++it ) {
+					gnd::lssmap::cmap_t ws, coarse;
+					gnd::lssmap::cmap_t *p;
+					int loaded, ret;
+
+					if( (loaded = tile_counting_map(src, it->first, &ws, &p)) < 0 ) {
+						destroy_counting_map(dest);
+						return -1;
+					}
+					if( !p ) continue;
+
+					if( (ret = reduce_counting_map(&coarse, p)) >= 0 ) {
+						cnt += ret;
+						ret = merge_counting_map(dest, &coarse);
+						gnd::lssmap::destroy_counting_map(&coarse);
+					}
+					if( loaded ) gnd::lssmap::destroy_counting_map(&ws);
+					if( ret < 0 ) {
+						destroy_counting_map(dest);
+						return -1;
+					}
+				}
+				return cnt;
+			} // <--- operation
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_TILED_CMAP_HPP_ */
@@ -0,0 +1,327 @@
+/*
+ * gnd_lssmap_maker_transform.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: batched 2D rigid TRANSFORM and range gate kernel for point-cloud (SSE2/AVX, scalar fallback)
+ */
+
+#ifndef GND_LSSMAP_MAKER_TRANSFORM_HPP_
+#define GND_LSSMAP_MAKER_TRANSFORM_HPP_
+
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+
+#include "gnd/gnd_lssmap_maker_grid_hash.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		struct scan_workspace;
+		typedef struct scan_workspace scan_workspace_t;
+
+		struct packed_points;
+		typedef struct packed_points packed_points_t;
+	}
+} // <--- type declaration
+
+
+
+// ---> const variables definition
+namespace gnd {
+	namespace lssmap_maker {
+		/// field data type of packed points (same value as sensor_msgs::PointField)
+		enum {
+			Packed_float32 = 7,		///< 32 bits float
+			Packed_float64 = 8,		///< 64 bits float
+		};
+	}
+} // <--- const variables definition
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief structure of arrays buffer of a scan
+		 * @note the buffers only grow, so a workspace reused for every scan does not allocate in steady state
+		 */
+		struct scan_workspace {
+			std::vector<double> x;			///< x on robot coordinate
+			std::vector<double> y;			///< y on robot coordinate
+			std::vector<double> gx;			///< x on global coordinate
+			std::vector<double> gy;			///< y on global coordinate
+			std::vector<uint8_t> mask;		///< range gate result (1: in range)
+			grid_hash_t grid;				///< grid cells counted in the scan (grid decimation)
+			double latency_transform;		///< latency of range gate and transform of the last scan (sec)
+			double latency_counting;		///< latency of culling and counting of the last scan (sec)
+			double latency_log;				///< latency of point log of the last scan (sec)
+		};
+
+		/**
+		 * @brief view of points packed in a byte buffer (e.g. point-cloud message), decoded on load without copy of the buffer
+		 * @note point i is at data + (i / width) * row_step + (i % width) * point_step, in host byte order
+		 */
+		struct packed_points {
+			const uint8_t *data;			///< buffer
+			size_t n;						///< number of points
+			size_t width;					///< number of points in a row
+			size_t row_step;				///< bytes of a row
+			size_t point_step;				///< bytes of a point
+			size_t offset[3];				///< offset of x, y and z in a point
+			uint8_t datatype[3];			///< data type of x, y and z (Packed_float32 or Packed_float64)
+		};
+	}
+} // <--- type definition
+
+
+
+// ---> function definition
+namespace gnd {
+	namespace lssmap_maker {
+
+		/**
+		 * @brief load points into workspace
+		 * @param [out] ws     : workspace
+		 * @param [in]  points : points (require member x, y)
+		 * @param [in]  n      : number of points
+		 */
+		template< typename point_t >
+		inline
+		int load_scan( scan_workspace_t *ws, const point_t *points, size_t n ) {
+			gnd_assert(!ws, -1, "invalid null pointer argument\n" );
+			gnd_assert(n > 0 && !points, -1, "invalid null pointer argument\n" );
+
+			if( ws->x.size() < n ) {
+				ws->x.resize(n);
+				ws->y.resize(n);
+				ws->gx.resize(n);
+				ws->gy.resize(n);
+				ws->mask.resize(n);
+			}
+			for( size_t i = 0; i < n; i++ ) {
+				ws->x[i] = points[i].x;
+				ws->y[i] = points[i].y;
+			}
+			return 0;
+		}
+
+
+		/**
+		 * @brief read a field of packed point
+		 */
+		inline
+		double packed_field( const uint8_t *p, uint8_t datatype ) {
+			if( datatype == Packed_float64 ) {
+				double v;
+				::memcpy(&v, p, sizeof(v));
+				return v;
+			}
+			else {
+				float v;
+				::memcpy(&v, p, sizeof(v));
+				return v;
+			}
+		}
+
+		/**
+		 * @brief load packed points into workspace
+		 * @note overload of load_scan(), counting_points() takes a packed_points and the number of points
+		 *       in place of an array, the fields are decoded straight from the buffer
+		 * @param [out] ws     : workspace
+		 * @param [in]  points : packed points (one view, not an array)
+		 * @param [in]  n      : number of points (<= points->n)
+		 */
+		inline
+		int load_scan( scan_workspace_t *ws, const packed_points_t *points, size_t n ) {
+			gnd_assert(!ws, -1, "invalid null pointer argument\n" );
+			gnd_assert(n > 0 && !points, -1, "invalid null pointer argument\n" );
+
+			if( ws->x.size() < n ) {
+				ws->x.resize(n);
+				ws->y.resize(n);
+				ws->gx.resize(n);
+				ws->gy.resize(n);
+				ws->mask.resize(n);
+			}
+			if( n == 0 ) return 0;
+			gnd_assert(points->width == 0, -1, "invalid argument\n" );
+
+			{ // ---> operation
+				const uint8_t *row = points->data;
+				const size_t ox = points->offset[0];
+				const size_t oy = points->offset[1];
+				size_t i = 0;
+
+				while( i < n ) {
+					const uint8_t *p = row;
+					size_t m = points->width < n - i ? points->width : n - i;
+
+					if( points->datatype[0] == Packed_float32 && points->datatype[1] == Packed_float32 ) {
+						for( size_t j = 0; j < m; j++, p += points->point_step ) {
+							float x, y;
+							::memcpy(&x, p + ox, sizeof(x));
+							::memcpy(&y, p + oy, sizeof(y));
+							ws->x[i + j] = x;
+							ws->y[i + j] = y;
+						}
+					}
+					else {
+						for( size_t j = 0; j < m; j++, p += points->point_step ) {
+							ws->x[i + j] = packed_field(p + ox, points->datatype[0]);
+							ws->y[i + j] = packed_field(p + oy, points->datatype[1]);
+						}
+					}
+					i += m;
+					row += points->row_step;
+				}
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief describe an array of points as packed points
+		 * @param [in]  points : points (require member x, y, z of float or double)
+		 * @param [in]  n      : number of points
+		 * @param [out] dest   : view of the array
+		 */
+		template< typename point_t >
+		inline
+		int pack_points( const point_t *points, size_t n, packed_points_t *dest ) {
+			gnd_assert(n > 0 && !points, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+
+			dest->data = (const uint8_t*) points;
+			dest->n = n;
+			dest->width = n;
+			dest->point_step = sizeof(point_t);
+			dest->row_step = n * sizeof(point_t);
+			dest->offset[0] = n > 0 ? (size_t)( (const uint8_t*) &points->x - dest->data ) : 0;
+			dest->offset[1] = n > 0 ? (size_t)( (const uint8_t*) &points->y - dest->data ) : 0;
+			dest->offset[2] = n > 0 ? (size_t)( (const uint8_t*) &points->z - dest->data ) : 0;
+			dest->datatype[0] = sizeof(points->x) == sizeof(double) ? Packed_float64 : Packed_float32;
+			dest->datatype[1] = sizeof(points->y) == sizeof(double) ? Packed_float64 : Packed_float32;
+			dest->datatype[2] = sizeof(points->z) == sizeof(double) ? Packed_float64 : Packed_float32;
+			return 0;
+		}
+
+		/**
+		 * @brief copy packed points into an array
+		 * @param [in]  points : packed points
+		 * @param [out] dest   : points (require member x, y, z)
+		 */
+		template< typename point_t >
+		inline
+		int unpack_points( const packed_points_t *points, std::vector<point_t> *dest ) {
+			gnd_assert(!points, -1, "invalid null pointer argument\n" );
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+
+			dest->resize(points->n);
+			for( size_t i = 0; i < points->n; i++ ) {
+				const uint8_t *p = points->data + (i / points->width) * points->row_step + (i % points->width) * points->point_step;
+				(*dest)[i].x = packed_field(p + points->offset[0], points->datatype[0]);
+				(*dest)[i].y = packed_field(p + points->offset[1], points->datatype[1]);
+				(*dest)[i].z = packed_field(p + points->offset[2], points->datatype[2]);
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief rigid transform and range gate of a scan
+		 * @details gx = cos * x - sin * y + px, gy = sin * x + cos * y + py,
+		 *          mask = (lower < 0 || |(x,y)|^2 >= lower^2) && (upper < 0 || |(x,y)|^2 <= upper^2)
+		 * @param [in]  x, y   : points on robot coordinate
+		 * @param [in]  n      : number of points
+		 * @param [in]  px, py : robot position
+		 * @param [in]  theta  : robot orientation
+		 * @param [in]  lower  : ignore range lower (<0: not ignore)
+		 * @param [in]  upper  : ignore range upper (<0: not ignore)
+		 * @param [out] gx, gy : points on global coordinate
+		 * @param [out] mask   : range gate result
+		 */
+		inline
+		void transform_scan( const double *x, const double *y, size_t n,
+				double px, double py, double theta, double lower, double upper,
+				double *gx, double *gy, uint8_t *mask ) {
+			const double c = ::cos(theta);
+			const double s = ::sin(theta);
+			const double sq_lower = lower >= 0 ? lower * lower : -1;
+			const double sq_upper = upper >= 0 ? upper * upper : DBL_MAX;
+			size_t i = 0;
+
+#if defined(__AVX__)
+			{ // ---> avx: 4 points
+				const __m256d vc = _mm256_set1_pd(c);
+				const __m256d vs = _mm256_set1_pd(s);
+				const __m256d vpx = _mm256_set1_pd(px);
+				const __m256d vpy = _mm256_set1_pd(py);
+				const __m256d vlower = _mm256_set1_pd(sq_lower);
+				const __m256d vupper = _mm256_set1_pd(sq_upper);
+
+				for( ; i + 4 <= n; i += 4 ) {
+					__m256d vx = _mm256_loadu_pd(x + i);
+					__m256d vy = _mm256_loadu_pd(y + i);
+					__m256d vsq = _mm256_add_pd( _mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy) );
+					int m;
+
+					_mm256_storeu_pd( gx + i, _mm256_add_pd( _mm256_sub_pd( _mm256_mul_pd(vc, vx), _mm256_mul_pd(vs, vy) ), vpx ) );
+					_mm256_storeu_pd( gy + i, _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd(vs, vx), _mm256_mul_pd(vc, vy) ), vpy ) );
+
+					m = _mm256_movemask_pd( _mm256_and_pd( _mm256_cmp_pd(vsq, vlower, _CMP_GE_OQ), _mm256_cmp_pd(vsq, vupper, _CMP_LE_OQ) ) );
+					mask[i]     = (uint8_t) (m & 1);
+					mask[i + 1] = (uint8_t) ((m >> 1) & 1);
+					mask[i + 2] = (uint8_t) ((m >> 2) & 1);
+					mask[i + 3] = (uint8_t) ((m >> 3) & 1);
+				}
+			} // <--- avx: 4 points
+#elif defined(__SSE2__)
+			{ // ---> sse2: 2 points
+				const __m128d vc = _mm_set1_pd(c);
+				const __m128d vs = _mm_set1_pd(s);
+				const __m128d vpx = _mm_set1_pd(px);
+				const __m128d vpy = _mm_set1_pd(py);
+				const __m128d vlower = _mm_set1_pd(sq_lower);
+				const __m128d vupper = _mm_set1_pd(sq_upper);
+
+				for( ; i + 2 <= n; i += 2 ) {
+					__m128d vx = _mm_loadu_pd(x + i);
+					__m128d vy = _mm_loadu_pd(y + i);
+					__m128d vsq = _mm_add_pd( _mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy) );
+					int m;
+
+					_mm_storeu_pd( gx + i, _mm_add_pd( _mm_sub_pd( _mm_mul_pd(vc, vx), _mm_mul_pd(vs, vy) ), vpx ) );
+					_mm_storeu_pd( gy + i, _mm_add_pd( _mm_add_pd( _mm_mul_pd(vs, vx), _mm_mul_pd(vc, vy) ), vpy ) );
+
+					m = _mm_movemask_pd( _mm_and_pd( _mm_cmpge_pd(vsq, vlower), _mm_cmple_pd(vsq, vupper) ) );
+					mask[i]     = (uint8_t) (m & 1);
+					mask[i + 1] = (uint8_t) ((m >> 1) & 1);
+				}
+			} // <--- sse2: 2 points
+#endif
+
+			// ---> scalar: remainder (or all points without simd)
+			for( ; i < n; i++ ) {
+				double sq = x[i] * x[i] + y[i] * y[i];
+				gx[i] = c * x[i] - s * y[i] + px;
+				gy[i] = s * x[i] + c * y[i] + py;
+				mask[i] = (uint8_t) ( sq >= sq_lower && sq <= sq_upper );
+			} // <--- scalar: remainder (or all points without simd)
+		}
+
+	}
+} // <--- function definition
+
+#endif /* GND_LSSMAP_MAKER_TRANSFORM_HPP_ */
@@ -0,0 +1,379 @@
+/*
+ * gnd_lssmap_maker_worker.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: tyamada
+ *       Brief: scan integration WORKER pool with per-thread counting map shards
+ */
+
+#ifndef GND_LSSMAP_MAKER_WORKER_HPP_
+#define GND_LSSMAP_MAKER_WORKER_HPP_
+
+#include <stdio.h>
+#include <vector>
+#include <deque>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "gnd/gnd-util.h"
+#include "gnd/gnd-lib-error.h"
+#include "gnd/gnd-lssmap-base.hpp"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+#include "gnd/gnd_lssmap_maker_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_tiled_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_point_log.hpp"
+#include "gnd/gnd_lssmap_maker_stats.hpp"
+
+
+// ---> type declaration
+namespace gnd {
+	namespace lssmap_maker {
+		template< typename point_t >
+		class integration_pool;
+	}
+} // <--- type declaration
+
+
+
+// ---> type definition
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief scan integration worker pool
+		 * @details each worker counts scans into its own counting map shard.
+		 *          scans are dealt to workers in round robin order and the shards are merged
+		 *          in worker order, so the merged map does not depend on thread scheduling.
+		 */
+		template< typename point_t >
+		class integration_pool {
+		public:
+			integration_pool();
+			~integration_pool();
+
+		public:
+			int start( int nthreads, const node_config *conf, double cell_size, point_logger *log = 0, node_stats *stats = 0 );
+			int push( const pose2d_t *pose, std::vector<point_t> *points, double age = 0, const node_config *conf = 0 );
+			int push_shared( const pose2d_t *pose, const boost::shared_ptr<const void> &hold, const packed_points_t *points, double age = 0, const node_config *conf = 0 );
+			template< typename map_t >
+			int merge( map_t *dest );
+			int stop();
+			int nthreads() const;
+			size_t backlog();
+
+		private:
+			/**
+			 * @brief scan to integrate
+			 * @note the points are either owned (points) or referred (ref) and kept alive by hold
+			 */
+			struct job {
+				pose2d_t pose;					///< pose associated with the point-cloud
+				const node_config *conf;		///< configuration of the point-cloud source (culling and range gate)
+				std::vector<point_t> points;	///< points on robot coordinate (owned)
+				boost::shared_ptr<const void> hold;	///< owner of referred points (e.g. received message)
+				packed_points_t ref;			///< view of referred points
+				bool flg_ref;					///< count referred points (false: owned points)
+				double age;						///< scan age at push (sec)
+				double time_push;				///< time of push (monotonic sec)
+			};
+
+			/**
+			 * @brief worker thread and its shard
+			 */
+			struct worker {
+				boost::thread thread;				///< thread
+				boost::mutex mutex;					///< mutex for queue and shard
+				boost::condition_variable cond;		///< queue and idle state notification
+				std::deque<job> queue;				///< scans to integrate
+				bool flg_busy;						///< integrating a scan
+				bool flg_quit;						///< quit request
+				gnd::lssmap::cmap_t shard;			///< counting map shard
+				scan_workspace_t workspace;			///< transform workspace
+			};
+
+		private:
+			void run( worker *w );
+
+		private:
+			std::vector<worker*> _workers;		///< workers
+			size_t _next;						///< next worker to deal a scan
+			size_t _depth;						///< maximum number of queued scans per worker
+			const node_config *_conf;			///< configuration
+			point_logger *_log;					///< point logger
+			node_stats *_stats;					///< statistics
+			boost::mutex _mutex_recycle;		///< recycled storage mutex
+			std::vector< std::vector<point_t> > _recycle;	///< integrated point storage to reuse
+		};
+
+		template< typename point_t >
+		inline
+		integration_pool<point_t>::integration_pool()
+		: _next(0), _depth(0), _conf(0), _log(0), _stats(0) {
+		}
+
+		template< typename point_t >
+		inline
+		integration_pool<point_t>::~integration_pool() {
+			stop();
+		}
+
+		/**
+		 * @brief start worker threads
+		 * @param [in] nthreads  : number of worker threads
+		 * @param [in] conf      : configuration
+		 * @param [in] cell_size : counting map cell size (m)
+		 * @param [in] log       : point logger (null: no log)
+		 * @param [in] stats     : statistics to record stage latencies (null: no record)
+		 */
+		template< typename point_t >
+		inline
+		int integration_pool<point_t>::start( int nthreads, const node_config *conf, double cell_size, point_logger *log, node_stats *stats ) {
+			gnd_assert(nthreads <= 0, -1, "invalid argument\n" );
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_workers.empty(), -1, "already started\n" );
+
+			_conf = conf;
+			_log = log;
+			_stats = stats;
+			_next = 0;
+			_depth = conf->worker_queue_depth.value > 0 ? (size_t)conf->worker_queue_depth.value : 1;
+			for( int i = 0; i < nthreads; i++ ) {
+				worker *w = new worker;
+				w->flg_busy = false;
+				w->flg_quit = false;
+				if( gnd::lssmap::init_counting_map(&w->shard, cell_size, cell_size) < 0 ) {
+					delete w;
+					stop();
+					return -1;
+				}
+				_workers.push_back(w);
+			}
+			for( size_t i = 0; i < _workers.size(); i++ ) {
+				_workers[i]->thread = boost::thread( boost::bind(&integration_pool<point_t>::run, this, _workers[i]) );
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief deal a scan to next worker
+		 * @note the points are swapped out of the argument, not copied, and a storage integrated
+		 *       before is swapped back for reuse. block while the worker queue is full ("worker-queue-depth")
+		 * @param [in]     pose   : pose associated with the point-cloud
+		 * @param [in,out] points : points on robot coordinate
+		 * @param [in]     age    : scan age at push (sec), the time in the queue is added at integration
+		 * @param [in]     conf   : configuration of the point-cloud source, alive until integrated (null: configuration of start())
+		 */
+		template< typename point_t >
+		inline
+		int integration_pool<point_t>::push( const pose2d_t *pose, std::vector<point_t> *points, double age, const node_config *conf ) {
+			gnd_assert(!pose, -1, "invalid null pointer argument\n" );
+			gnd_assert(!points, -1, "invalid null pointer argument\n" );
+			gnd_assert(_workers.empty(), -1, "not started\n" );
+
+			{ // ---> operation
+				worker *w = _workers[_next];
+				_next = (_next + 1) % _workers.size();
+
+				{
+					boost::mutex::scoped_lock lock(w->mutex);
+					while( w->queue.size() >= _depth ) {
+						w->cond.wait(lock);
+					}
+					w->queue.push_back(job());
+					w->queue.back().pose = *pose;
+					w->queue.back().conf = conf ? conf : _conf;
+					w->queue.back().points.swap(*points);
+					w->queue.back().flg_ref = false;
+					w->queue.back().age = age;
+					w->queue.back().time_push = clock_sec();
+				}
+				w->cond.notify_all();
+
+				{ // ---> recycle point storage
+					boost::mutex::scoped_lock lock(_mutex_recycle);
+					if( !_recycle.empty() ) {
+						points->swap(_recycle.back());
+						_recycle.pop_back();
+					}
+				} // <--- recycle point storage
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief deal a scan on referred points to next worker
+		 * @note the points are not copied, the worker counts them in place and releases hold after the counting.
+		 *       block while the worker queue is full ("worker-queue-depth")
+		 * @param [in] pose   : pose associated with the point-cloud
+		 * @param [in] hold   : owner of the points, e.g. the received message (ConstPtr)
+		 * @param [in] points : view of points on robot coordinate (copied), the buffer is valid while hold is alive
+		 * @param [in] age    : scan age at push (sec), the time in the queue is added at integration
+		 * @param [in] conf   : configuration of the point-cloud source, alive until integrated (null: configuration of start())
+		 */
+		template< typename point_t >
+		inline
+		int integration_pool<point_t>::push_shared( const pose2d_t *pose, const boost::shared_ptr<const void> &hold, const packed_points_t *points, double age, const node_config *conf ) {
+			gnd_assert(!pose, -1, "invalid null pointer argument\n" );
+			gnd_assert(!points, -1, "invalid null pointer argument\n" );
+			gnd_assert(_workers.empty(), -1, "not started\n" );
+
+			{ // ---> operation
+				worker *w = _workers[_next];
+				_next = (_next + 1) % _workers.size();
+
+				{
+					boost::mutex::scoped_lock lock(w->mutex);
+					while( w->queue.size() >= _depth ) {
+						w->cond.wait(lock);
+					}
+					w->queue.push_back(job());
+					w->queue.back().pose = *pose;
+					w->queue.back().conf = conf ? conf : _conf;
+					w->queue.back().hold = hold;
+					w->queue.back().ref = *points;
+					w->queue.back().flg_ref = true;
+					w->queue.back().age = age;
+					w->queue.back().time_push = clock_sec();
+				}
+				w->cond.notify_all();
+				return 0;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief wait for all queued scans and merge shards into a counting map
+		 * @note the shards are cleared after the merge
+		 * @param [out] dest : counting map (plain or tiled)
+		 */
+		template< typename point_t >
+		template< typename map_t >
+		inline
+		int integration_pool<point_t>::merge( map_t *dest ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+
+			for( size_t i = 0; i < _workers.size(); i++ ) {
+				worker *w = _workers[i];
+				boost::mutex::scoped_lock lock(w->mutex);
+
+				while( !w->queue.empty() || w->flg_busy ) {
+					w->cond.wait(lock);
+				}
+				if( gnd::lssmap_maker::merge_counting_map(dest, &w->shard) < 0 )	return -1;
+				if( clear_counting_map(&w->shard) < 0 )		return -1;
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief integrate all queued scans and stop worker threads
+		 * @note shards that are not merged are discarded, call merge() before
+		 */
+		template< typename point_t >
+		inline
+		int integration_pool<point_t>::stop() {
+			for( size_t i = 0; i < _workers.size(); i++ ) {
+				boost::mutex::scoped_lock lock(_workers[i]->mutex);
+				_workers[i]->flg_quit = true;
+				_workers[i]->cond.notify_all();
+			}
+			for( size_t i = 0; i < _workers.size(); i++ ) {
+				_workers[i]->thread.join();
+				gnd::lssmap::destroy_counting_map(&_workers[i]->shard);
+				delete _workers[i];
+			}
+			_workers.clear();
+			return 0;
+		}
+
+		/**
+		 * @brief number of worker threads
+		 */
+		template< typename point_t >
+		inline
+		int integration_pool<point_t>::nthreads() const {
+			return (int)_workers.size();
+		}
+
+		/**
+		 * @brief number of scans waiting in worker queues or being integrated
+		 */
+		template< typename point_t >
+		inline
+		size_t integration_pool<point_t>::backlog() {
+			size_t n = 0;
+			for( size_t i = 0; i < _workers.size(); i++ ) {
+				boost::mutex::scoped_lock lock(_workers[i]->mutex);
+				n += _workers[i]->queue.size() + (_workers[i]->flg_busy ? 1 : 0);
+			}
+			return n;
+		}
+
+		/**
+		 * @brief worker thread
+		 */
+		template< typename point_t >
+		inline
+		void integration_pool<point_t>::run( worker *w ) {
+			job ws;
+
+			while( true ) {
+				{ // ---> pop a scan
+					boost::mutex::scoped_lock lock(w->mutex);
+					while( w->queue.empty() && !w->flg_quit ) {
+						w->cond.wait(lock);
+					}
+					if( w->queue.empty() ) break;
+
+					ws.pose = w->queue.front().pose;
+					ws.conf = w->queue.front().conf;
+					ws.points.swap( w->queue.front().points );
+					ws.hold.swap( w->queue.front().hold );
+					ws.ref = w->queue.front().ref;
+					ws.flg_ref = w->queue.front().flg_ref;
+					ws.age = w->queue.front().age;
+					ws.time_push = w->queue.front().time_push;
+					w->queue.pop_front();
+					w->flg_busy = true;
+				} // <--- pop a scan
+				w->cond.notify_all();
+
+				{ // ---> coordinate transform and counting
+					// the shard is only touched by this thread while busy
+					double time_pop = clock_sec();
+					int cnt = ws.flg_ref ?
+							counting_points(&w->shard, ws.conf, &ws.pose, &ws.ref, ws.ref.n, _log, &w->workspace) :
+							counting_points(&w->shard, ws.conf, &ws.pose, ws.points.empty() ? (const point_t*) 0 : &ws.points[0], ws.points.size(), _log, &w->workspace);
+
+					if( _stats ) {
+						_stats->record(Stage_dispatch, time_pop - ws.time_push);
+						_stats->count_integrated(w->workspace.latency_transform, w->workspace.latency_counting, w->workspace.latency_log,
+								ws.age + (clock_sec() - ws.time_push), cnt > 0 ? cnt : 0);
+					}
+				} // <--- coordinate transform and counting
+
+				if( ws.flg_ref ) { // ---> release referred points
+					ws.hold.reset();
+					ws.flg_ref = false;
+				} // <--- release referred points
+				else { // ---> give back point storage
+					boost::mutex::scoped_lock lock(_mutex_recycle);
+					_recycle.push_back( std::vector<point_t>() );
+					_recycle.back().swap(ws.points);
+				} // <--- give back point storage
+
+				{ // ---> idle
+					boost::mutex::scoped_lock lock(w->mutex);
+					w->flg_busy = false;
+				} // <--- idle
+				w->cond.notify_all();
+			}
+		}
+
+	}
+} // <--- type definition
+
+#endif /* GND_LSSMAP_MAKER_WORKER_HPP_ */
@@ -0,0 +1,105 @@
+/**
+ * @file gnd_lssmap_maker/src/gnd_lssmap_cmap_convert.cpp
+ *
+ * @brief convert counting map between text files and binary format, and build map from counting map
+ **/
+
+#include "gnd/gnd-multi-platform.h"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_cmap_binary.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gnd/gnd-lssmap-base.hpp"
+
+typedef gnd::lssmap::cmap_t										cmap_t;
+
+static void show_usage( const char *name ) {
+	fprintf(stdout, " usage: %s text2bin <text file directory> <binary file>\n", name);
+	fprintf(stdout, "        %s bin2text <binary file> <text file directory>\n", name);
+	fprintf(stdout, "        %s compact <counting map (text file directory or binary file)> <binary file of compact layout>\n", name);
+	fprintf(stdout, "        %s build <counting map (text file directory or binary file)> <output directory> [config file]\n", name);
+	fprintf(stdout, "             (e.g. build a map at a level of \"counting-map-pyramid-levels\" from \"<directory>/level<l>\")\n");
+}
+
+int main(int argc, char **argv) {
+	cmap_t cmap;
+
+	if( argc < 4 ) {
+		show_usage(argv[0]);
+		return -1;
+	}
+
+	if( strcmp(argv[1], "text2bin") == 0 ) {
+		fprintf(stdout, "   => read counting map text files in \"%s\"\n", argv[2]);
+		if( gnd::lssmap::read_counting_map(&cmap, argv[2]) < 0 ) {
+			fprintf(stderr, "    ... error: fail to read\n");
+			return -1;
+		}
+		fprintf(stdout, "   => write counting map binary file \"%s\"\n", argv[3]);
+		if( gnd::lssmap_maker::write_counting_map_binary(&cmap, argv[3]) < 0 ) {
+			fprintf(stderr, "    ... error: fail to write\n");
+			gnd::lssmap::destroy_counting_map(&cmap);
+			return -1;
+		}
+	}
+	else if( strcmp(argv[1], "compact") == 0 ) {
+		fprintf(stdout, "   => read counting map \"%s\"\n", argv[2]);
+		if( gnd::lssmap_maker::read_counting_map_any(&cmap, argv[2]) < 0 ) {
+			fprintf(stderr, "    ... error: fail to read\n");
+			return -1;
+		}
+		fprintf(stdout, "   => write counting map binary file of compact layout \"%s\"\n", argv[3]);
+		if( gnd::lssmap_maker::write_counting_map_binary(&cmap, argv[3], true) < 0 ) {
+			fprintf(stderr, "    ... error: fail to write\n");
+			gnd::lssmap::destroy_counting_map(&cmap);
+			return -1;
+		}
+	}
+	else if( strcmp(argv[1], "bin2text") == 0 ) {
+		fprintf(stdout, "   => read counting map binary file \"%s\"\n", argv[2]);
+		if( gnd::lssmap_maker::read_counting_map_binary(&cmap, argv[2]) < 0 ) {
+			fprintf(stderr, "    ... error: fail to read\n");
+			return -1;
+		}
+		fprintf(stdout, "   => write counting map text files in \"%s\"\n", argv[3]);
+		if( gnd::lssmap::write_counting_map(&cmap, argv[3]) < 0 ) {
+			fprintf(stderr, "    ... error: fail to write\n");
+			gnd::lssmap::destroy_counting_map(&cmap);
+			return -1;
+		}
+	}
+	else if( strcmp(argv[1], "build") == 0 ) {
+		gnd::lssmap_maker::node_config node_config;
+
+		if( argc > 4 ) {
+			if( gnd::lssmap_maker::fread_node_config(argv[4], &node_config) < 0 ) {
+				fprintf(stderr, "    ... error: fail to read config file \"%s\"\n", argv[4]);
+				return -1;
+			}
+			fprintf(stdout, "   ... read config file \"%s\"\n", argv[4]);
+		}
+		fprintf(stdout, "   => read counting map \"%s\"\n", argv[2]);
+		if( gnd::lssmap_maker::read_counting_map_any(&cmap, argv[2]) < 0 ) {
+			fprintf(stderr, "    ... error: fail to read\n");
+			return -1;
+		}
+		fprintf(stdout, "   => build map (cell size %.03lf[m]) in \"%s\"\n", gnd::lssmap_maker::counting_map_cell_size(&cmap), argv[3]);
+		if( gnd::lssmap_maker::fwrite_map(&cmap, &node_config, argv[3]) < 0 ) {
+			fprintf(stderr, "    ... error: fail to write\n");
+			gnd::lssmap::destroy_counting_map(&cmap);
+			return -1;
+		}
+	}
+	else {
+		show_usage(argv[0]);
+		return -1;
+	}
+
+	gnd::lssmap::destroy_counting_map(&cmap);
+	fprintf(stdout, "    ... ok\n");
+	return 0;
+}
@@ -0,0 +1,375 @@
+/**
+ * @file gnd_lssmap_maker/src/gnd_lssmap_maker_batch.cpp
+ *
+ * @brief Laser Scan Statistics MAP maker (offline batch from recorded dataset)
+ **/
+
+#include "gnd/gnd-multi-platform.h"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_dataset.hpp"
+#include "gnd/gnd_lssmap_maker_pose_buffer.hpp"
+#include "gnd/gnd_lssmap_maker_integrator.hpp"
+#include "gnd/gnd_lssmap_maker_pointcloud_msg.hpp"
+
+#include "rosbag/bag.h"
+#include "rosbag/view.h"
+
+#include "sensor_msgs/PointCloud.h"
+#include "sensor_msgs/PointCloud2.h"
+#include "gnd_msgs/msg_pose2d_stamped.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+
+#include "gnd/gnd-lssmap-base.hpp"
+
+typedef gnd::lssmap_maker::node_config							node_config_t;
+
+typedef sensor_msgs::PointCloud									msg_pointcloud_t;
+typedef sensor_msgs::PointCloud2								msg_pointcloud2_t;
+typedef gnd_msgs::msg_pose2d_stamped							msg_pose_t;
+
+typedef gnd::lssmap_maker::map_integrator						map_integrator_t;
+typedef gnd::lssmap_maker::pose2d_t								pose_t;
+typedef gnd::lssmap_maker::point3d_t							point_t;
+typedef gnd::lssmap_maker::packed_points_t						packed_points_t;
+typedef gnd::lssmap_maker::scan_header_t						scan_header_t;
+
+
+/**
+ * @brief batch operating state
+ */
+struct batch_state {
+	const node_config_t *conf;			///< configuration
+	map_integrator_t *integrator;		///< scan integrator (counting map, integration threads and point log)
+	std::vector<pose_t> poses;			///< all poses sorted by time stamp
+	int cnt_scan;						///< number of read scans
+	int cnt_collect;					///< number of collected scans
+	int cnt_skip;						///< number of scans not meeting collect condition
+	int cnt_invalid;					///< number of point-cloud messages of unsupported layout
+};
+
+/**
+ * @brief point-cloud source of rosbag
+ */
+struct batch_source {
+	int index;							///< source index (see get_pointcloud_source())
+	std::string topic;					///< topic name
+	bool flg_pointcloud2;				///< message type (true: PointCloud2, false: PointCloud)
+};
+
+
+/**
+ * @brief associate a point-cloud with pose and check data collect condition
+ * @note only the time stamp is used, the points are not needed.
+ *       the node waits before association until the second point-cloud of the source is received
+ *       (nreceived() >= 2) and the pose after the point-cloud (or the extrapolation limit) arrives.
+ *       both only delay a point-cloud on-line, none is dropped by them, and every pose is read before here,
+ *       so the batch associates each point-cloud at once with the pose the node gets when the poses arrive in time.
+ *       a source of a single point-cloud differs, the node keeps it waiting and never counts it
+ * @param [in,out] s      : batch state
+ * @param [in]     stamp  : point-cloud time stamp
+ * @param [in]     source : point-cloud source index
+ * @param [out]    pose   : pose at the point-cloud time (interpolated)
+ * @return 0: collect the point-cloud, <0: not collect
+ */
+static int associate_scan( batch_state *s, double stamp, int source, pose_t *pose ) {
+
+	s->cnt_scan++;
+
+	// same as on-line association: interpolate between the poses before and after the point-cloud
+	if( gnd::lssmap_maker::interpolate_pose(s->poses, s->poses.size(), stamp,
+			s->conf->pose_interpolation_max_gap.value, s->conf->pose_extrapolation_limit.value, pose) < 0 ) return -1;
+
+	if( !s->integrator->is_collect(pose, source) ) {
+		s->cnt_skip++;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief count a point-cloud
+ * @param [in,out] s      : batch state
+ * @param [in]     pose   : associated pose
+ * @param [in,out] points : points (moved out when dealt to integration thread)
+ */
+static int integrate_scan( batch_state *s, const pose_t *pose, std::vector<point_t> *points ) {
+	if( s->integrator->integrate(pose, points) < 0 ) return -1;
+	s->cnt_collect++;
+	return 0;
+}
+
+/**
+ * @brief count a point-cloud message in place
+ * @param [in,out] s      : batch state
+ * @param [in]     pose   : associated pose
+ * @param [in]     hold   : message, held by integration threads until counted
+ * @param [in]     points : view of the points in the message
+ * @param [in]     source : point-cloud source index
+ */
+static int integrate_scan( batch_state *s, const pose_t *pose, const boost::shared_ptr<const void> &hold, const packed_points_t *points, int source ) {
+	if( s->integrator->integrate(pose, hold, points, 0, source) < 0 ) return -1;
+	s->cnt_collect++;
+	return 0;
+}
+
+
+/**
+ * @brief read and count rosbag
+ */
+static int batch_rosbag( batch_state *s, const char *fname ) {
+	rosbag::Bag bag;
+	std::vector<batch_source> sources;		// configured point-cloud sources
+	std::vector<std::string> topics_pointcloud;	// point-cloud topics of the sources
+
+	try {
+		bag.open(fname, rosbag::bagmode::Read);
+	}
+	catch( rosbag::BagException &e ) {
+		fprintf(stderr, "    ... error: fail to open rosbag \"%s\": %s\n", fname, e.what());
+		return -1;
+	}
+
+	{ // ---> read poses
+		std::vector<std::string> topics;
+		topics.push_back( s->conf->topic_name_pose.value );
+		rosbag::View view(bag, rosbag::TopicQuery(topics));
+
+		s->poses.clear();
+		for( rosbag::View::iterator it = view.begin(); it != view.end(); ++it ) {
+			msg_pose_t::ConstPtr msg = it->instantiate<msg_pose_t>();
+			pose_t ws;
+			if( !msg ) continue;
+
+			ws.seq = msg->header.seq;
+			ws.stamp = msg->header.stamp.toSec();
+			ws.x = msg->x;
+			ws.y = msg->y;
+			ws.theta = msg->theta;
+			s->poses.push_back(ws);
+		}
+		std::stable_sort(s->poses.begin(), s->poses.end(), gnd::lssmap_maker::pose_stamp_less);
+		fprintf(stdout, "    ... %d poses on \"%s\"\n", (int)s->poses.size(), s->conf->topic_name_pose.value);
+	} // <--- read poses
+
+	{ // ---> point-cloud sources
+		for( int i = 0; i < gnd::lssmap_maker::PointCloud_sources_max; i++ ) {
+			gnd::lssmap_maker::pointcloud_source_config conf;
+			batch_source ws;
+
+			if( gnd::lssmap_maker::get_pointcloud_source(s->conf, i, &conf) < 0 ) {
+				bag.close();
+				return -1;
+			}
+			if( !conf.topic_name_pointcloud.value[0] ) continue;
+
+			ws.index = i;
+			ws.topic = conf.topic_name_pointcloud.value;
+			if( strcmp(conf.topic_type_pointcloud.value, "PointCloud") == 0 )			ws.flg_pointcloud2 = false;
+			else if( strcmp(conf.topic_type_pointcloud.value, "PointCloud2") == 0 )	ws.flg_pointcloud2 = true;
+			else {
+				fprintf(stderr, "    ... error: unknown point-cloud message type \"%s\"\n", conf.topic_type_pointcloud.value);
+				fprintf(stderr, "        usage: fill \"%s\" item with \"PointCloud\" or \"PointCloud2\"\n", conf.topic_type_pointcloud.item);
+				bag.close();
+				return -1;
+			}
+			sources.push_back(ws);
+			topics_pointcloud.push_back(ws.topic);
+			fprintf(stdout, "    ... source %d: \"%s\", type %s\n", i, conf.topic_name_pointcloud.value, conf.topic_type_pointcloud.value);
+		}
+		if( sources.empty() ) {
+			fprintf(stderr, "    ... error: laser scan topic name is null\n");
+			bag.close();
+			return -1;
+		}
+	} // <--- point-cloud sources
+
+	{ // ---> read point-cloud and count
+		// the messages of all the sources in the order of the bag, counted in place without copy
+		rosbag::View view(bag, rosbag::TopicQuery(topics_pointcloud));
+
+		for( rosbag::View::iterator it = view.begin(); it != view.end(); ++it ) {
+			const batch_source *src = 0;
+			boost::shared_ptr<const void> msg;
+			scan_header_t header;
+			packed_points_t points;
+			pose_t pose;
+			int ret;
+
+			for( size_t i = 0; i < sources.size() && !src; i++ ) {
+				if( sources[i].topic == it->getTopic() ) src = &sources[i];
+			}
+			if( !src ) continue;
+
+			if( src->flg_pointcloud2 ) {
+				msg_pointcloud2_t::ConstPtr p = it->instantiate<msg_pointcloud2_t>();
+				if( !p ) continue;
+				ret = gnd::lssmap_maker::pointcloud_traits<msg_pointcloud2_t>::describe(*p, &header, &points);
+				msg = p;
+			}
+			else {
+				msg_pointcloud_t::ConstPtr p = it->instantiate<msg_pointcloud_t>();
+				if( !p ) continue;
+				ret = gnd::lssmap_maker::pointcloud_traits<msg_pointcloud_t>::describe(*p, &header, &points);
+				msg = p;
+			}
+			if( ret < 0 ) {
+				s->cnt_invalid++;
+				continue;
+			}
+
+			if( associate_scan(s, header.stamp, src->index, &pose) < 0 ) continue;
+			if( integrate_scan(s, &pose, msg, &points, src->index) < 0 ) {
+				fprintf(stderr, "    ... error: fail to count point-cloud %u of source %d\n", header.seq, src->index);
+				bag.close();
+				return -1;
+			}
+		}
+	} // <--- read point-cloud and count
+
+	bag.close();
+	return 0;
+}
+
+
+/**
+ * @brief read and count dataset text dump
+ * @note the dump has no source index, the point-clouds are counted as source 0
+ */
+static int batch_dump( batch_state *s, const char *fname ) {
+	gnd::lssmap_maker::dataset_reader reader;
+	gnd::lssmap_maker::scan_header_t header;
+	std::vector<point_t> points;
+	int ret;
+
+	if( reader.open(fname) < 0 ) {
+		fprintf(stderr, "    ... error: fail to open dataset \"%s\"\n", fname);
+		return -1;
+	}
+
+	// read poses
+	if( reader.read_poses(&s->poses) < 0 ) {
+		fprintf(stderr, "    ... error: invalid pose record in \"%s\"\n", fname);
+		return -1;
+	}
+	fprintf(stdout, "    ... %d poses\n", (int)s->poses.size());
+
+	// read point-cloud and count
+	reader.rewind();
+	while( (ret = reader.read_next_header(&header)) > 0 ) {
+		pose_t pose;
+		if( associate_scan(s, header.stamp, 0, &pose) < 0 ) {
+			if( (ret = reader.skip_points(&header)) < 0 ) break;
+		}
+		else {
+			if( (ret = reader.read_points(&header, &points)) < 0 ) break;
+			if( integrate_scan(s, &pose, &points) < 0 ) {
+				fprintf(stderr, "    ... error: fail to count point-cloud %u\n", header.seq);
+				return -1;
+			}
+		}
+	}
+	if( ret < 0 ) {
+		fprintf(stderr, "    ... error: invalid point-cloud record in \"%s\"\n", fname);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+
+int main(int argc, char **argv) {
+	node_config_t			node_config;
+	map_integrator_t		integrator;				// scan integrator, same as the node
+	batch_state				state;
+	const char				*fname_dataset;
+	const char				*dir_output = "./";
+
+	{ // ---> start up, read configuration file
+		if( argc < 3 ) {
+			fprintf(stdout, " usage: %s <config file> <dataset (*.bag or text dump)> [output directory]\n", argv[0]);
+			return -1;
+		}
+
+		if( gnd::lssmap_maker::fread_node_config( argv[1], &node_config ) < 0 ) {
+			char fname[1024];
+			fprintf(stdout, "   ... Error: fail to read config file \"%s\"\n", argv[1]);
+			sprintf(fname, "%s.tmp", argv[1]);
+			// file out configuration file
+			if( gnd::lssmap_maker::fwrite_node_config( fname, &node_config ) >= 0 ){
+				fprintf(stdout, "            : output sample configuration file \"%s\"\n", fname);
+			}
+			return -1;
+		}
+		fprintf(stdout, "   ... read config file \"%s\"\n", argv[1]);
+
+		fname_dataset = argv[2];
+		if( argc > 3 ) dir_output = argv[3];
+	} // <--- start up, read configuration file
+
+
+
+	{ // ---> initialize
+		state.conf = &node_config;
+		state.integrator = &integrator;
+		state.cnt_scan = 0;
+		state.cnt_collect = 0;
+		state.cnt_skip = 0;
+		state.cnt_invalid = 0;
+
+		fprintf(stdout, "---------- initialize ----------\n");
+		// counting map (initial counting map), point log and integration threads
+		// off-line: the point log waits for the disk rather than drop points
+		if( integrator.initialize(&node_config, 0, true) < 0 ) {
+			return -1;
+		}
+	} // <--- initialize
+
+
+
+	{ // ---> operate
+		size_t len = strlen(fname_dataset);
+		int ret;
+
+		fprintf(stdout, "---------- operate ----------\n");
+		fprintf(stdout, "   => read dataset \"%s\"\n", fname_dataset);
+		if( len > 4 && strcmp(fname_dataset + len - 4, ".bag") == 0 ) {
+			ret = batch_rosbag(&state, fname_dataset);
+		}
+		else {
+			ret = batch_dump(&state, fname_dataset);
+		}
+
+		// integrate queued scans and merge counting map shards
+		if( integrator.stop() < 0 ) ret = -1;
+
+		if( ret < 0 ) {
+			// the counting map and the point log are released by the integrator
+			return -1;
+		}
+		fprintf(stdout, "    ... %d scans, %d collected, %d skipped\n", state.cnt_scan, state.cnt_collect, state.cnt_skip);
+		if( state.cnt_invalid > 0 ) {
+			fprintf(stdout, "    ... %d point-clouds of unsupported layout (no float x, y or z field, or foreign byte order)\n", state.cnt_invalid);
+		}
+	} // <--- operate
+
+
+
+	{ // ---> finalize
+		int ret;
+
+		// counting map, map image, origin and pyramid file out, and write buffered points
+		ret = integrator.finalize(dir_output);
+
+		fprintf(stderr, " ... fin\n");
+		if( ret < 0 ) return -1;
+	} // <--- finalize
+
+	return 0;
+}
@@ -0,0 +1,874 @@
+/**
+ * @file gnd_lssmap_maker/src/gnd_lssmap_maker_bench.cpp
+ *
+ * @brief benchmark of Laser Scan Statistics MAP maker on synthetic trajectory and scans
+ **/
+
+#include "gnd/gnd-multi-platform.h"
+
+#include "gnd/gnd_lssmap_maker.hpp"
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_dataset.hpp"
+#include "gnd/gnd_lssmap_maker_pose_buffer.hpp"
+#include "gnd/gnd_lssmap_maker_integrator.hpp"
+#include "gnd/gnd_lssmap_maker_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_cmap_binary.hpp"
+#include "gnd/gnd_lssmap_maker_tiled_cmap.hpp"
+#include "gnd/gnd_lssmap_maker_stats.hpp"
+#include "gnd/gnd_lssmap_maker_tile_build.hpp"
+#include "gnd/gnd_lssmap_maker_live_map.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "gnd/gnd-lssmap-base.hpp"
+
+typedef gnd::lssmap_maker::node_config							node_config_t;
+
+typedef gnd::lssmap::cmap_t										cmap_t;
+typedef gnd::lssmap::lssmap_t									lssmap_t;
+typedef gnd::lssmap_maker::tiled_cmap_t							tiled_cmap_t;
+typedef gnd::lssmap_maker::pose2d_t								pose_t;
+typedef gnd::lssmap_maker::point3d_t							point_t;
+typedef gnd::lssmap_maker::latency_histogram_t					histogram_t;
+
+
+/**
+ * @brief benchmark condition
+ */
+struct bench_option {
+	const char *fname_config;			///< node configuration file (null: default)
+	const char *fname_output;			///< json output file (null: standard output)
+	const char *dir_work;				///< directory for counting map file out and read
+	int nscans;							///< number of scans
+	int npoints;						///< number of points per scan
+	double rate;						///< scan rate (Hz)
+	double speed;						///< robot speed (m/sec)
+	double extent;						///< environment extent (m), square room
+	double noise;						///< range noise (m)
+	int repeat;							///< repeat of map operations
+	int build_threads;					///< number of threads of parallel map build
+	double tile_size;					///< counting map tile size (m) (< 0: configuration)
+	unsigned int seed;					///< random seed
+	bool flg_keep;						///< keep the files in the work directory
+};
+
+/**
+ * @brief time of a repeated operation
+ */
+struct bench_timing {
+	double min;							///< minimum (sec)
+	double sum;							///< sum (sec)
+	int n;								///< number of runs
+	int nerror;							///< number of failed runs
+	int ret;							///< return code of the last failed run
+};
+
+
+static void show_usage( const char *name ) {
+	fprintf(stdout, " usage: %s [options]\n", name);
+	fprintf(stdout, "    -c <file> : node configuration file (default: default parameters)\n");
+	fprintf(stdout, "    -o <file> : json output file (default: standard output)\n");
+	fprintf(stdout, "    -d <dir>  : work directory for counting map files (default: /tmp)\n");
+	fprintf(stdout, "    -n <num>  : number of scans (default: 2000)\n");
+	fprintf(stdout, "    -p <num>  : number of points per scan (default: 1081)\n");
+	fprintf(stdout, "    -r <Hz>   : scan rate (default: 40)\n");
+	fprintf(stdout, "    -v <m/s>  : robot speed (default: 1.0)\n");
+	fprintf(stdout, "    -e <m>    : environment extent, side of square room (default: 50)\n");
+	fprintf(stdout, "    -z <m>    : range noise (default: 0.01)\n");
+	fprintf(stdout, "    -i <num>  : repeat of map operations (default: 3)\n");
+	fprintf(stdout, "    -j <num>  : number of threads of parallel map build (default: number of cpus)\n");
+	fprintf(stdout, "    -t <m>    : counting map tile size, 0: single tile (default: configuration)\n");
+	fprintf(stdout, "    -s <num>  : random seed (default: 1)\n");
+	fprintf(stdout, "    -k        : keep the counting map files in the work directory\n");
+	fprintf(stdout, " exit status is not zero on a failed map operation or a mismatch of the parallel build, the incremental build, the single tile build against the map counted untiled, binary files read back, tile eviction, the banded image or the pyramid reduction\n");
+}
+
+/**
+ * @brief uniform random number in [0, 1) (reproducible on every platform)
+ */
+static double bench_random( unsigned int *state ) {
+	*state = *state * 1103515245u + 12345u;
+	return ((*state >> 8) & 0xffffff) / (double)0x1000000;
+}
+
+/**
+ * @brief pose on synthetic trajectory
+ * @details the robot runs on a circle in the room and the heading follows the tangent
+ */
+static void synthetic_pose( const bench_option *opt, double t, pose_t *pose ) {
+	const double radius = opt->extent / 4;
+	const double omega = opt->speed / radius;
+
+	pose->stamp = t;
+	pose->x = radius * ::cos(omega * t);
+	pose->y = radius * ::sin(omega * t);
+	pose->theta = gnd_rad_normalize( omega * t + M_PI / 2 );
+}
+
+/**
+ * @brief synthetic scan of square room walls
+ * @details rays over 270 deg are cast from the robot to the walls of the room
+ * @param [in]     opt        : benchmark condition
+ * @param [in]     pose       : robot pose
+ * @param [in,out] rand_state : random state
+ * @param [out]    points     : points on robot coordinate
+ */
+static void synthetic_scan( const bench_option *opt, const pose_t *pose, unsigned int *rand_state, std::vector<point_t> *points ) {
+	const double half = opt->extent / 2;
+	const double fov = M_PI * 3 / 2;
+
+	points->resize(opt->npoints);
+	for( int i = 0; i < opt->npoints; i++ ) {
+		double a = opt->npoints > 1 ? -fov / 2 + fov * i / (opt->npoints - 1) : 0;
+		double c = ::cos(pose->theta + a);
+		double s = ::sin(pose->theta + a);
+		double r = DBL_MAX;
+
+		// distance to the nearest wall along the ray
+		if( c > 0 )			r = std::min(r, (half - pose->x) / c);
+		else if( c < 0 )	r = std::min(r, (-half - pose->x) / c);
+		if( s > 0 )			r = std::min(r, (half - pose->y) / s);
+		else if( s < 0 )	r = std::min(r, (-half - pose->y) / s);
+		r += opt->noise * (bench_random(rand_state) * 2 - 1);
+
+		(*points)[i].x = (float)(r * ::cos(a));
+		(*points)[i].y = (float)(r * ::sin(a));
+		(*points)[i].z = 0;
+	}
+}
+
+static void timing_init( bench_timing *t ) {
+	t->min = DBL_MAX;
+	t->sum = 0;
+	t->n = 0;
+	t->nerror = 0;
+	t->ret = 0;
+}
+
+static void timing_add( bench_timing *t, double sec ) {
+	if( sec < t->min ) t->min = sec;
+	t->sum += sec;
+	t->n++;
+}
+
+static void timing_error( bench_timing *t, int ret ) {
+	t->nerror++;
+	t->ret = ret;
+}
+
+static void fprint_timing_json( FILE *fp, const char *name, const bench_timing *t, bool last ) {
+	fprintf(fp, "    \"%s\": { \"runs\": %d, \"min\": %.9lf, \"mean\": %.9lf, \"errors\": %d, \"ret\": %d }%s\n", name, t->n,
+			t->n > 0 ? t->min : 0, t->n > 0 ? t->sum / t->n : 0, t->nerror, t->ret, last ? "" : ",");
+}
+
+/**
+ * @brief number of counted cells that differ between a counting map and the one read back from its file
+ * @param [in] a         : written counting map
+ * @param [in] b         : read counting map
+ * @param [in] tolerance : relative tolerance of moments (0: exact)
+ */
+static int roundtrip_mismatch( cmap_t *a, cmap_t *b, double tolerance ) {
+	int n0 = gnd::lssmap_maker::compare_counting_map(a, b, tolerance);
+	int n1 = gnd::lssmap_maker::compare_counting_map(b, a, tolerance);
+
+	return n0 < 0 || n1 < 0 ? 1 : n0 + n1;
+}
+
+/**
+ * @brief number of counted cells that drift over evict and reload cycles of tiles packed in memory
+ * @details the counting map is split into tiles with two tiles in memory and every tile is reloaded cycles times.
+ *          exact layout must restore the counting map, compact layout must not change after the first cycle
+ * @param [in] cmap    : counting map
+ * @param [in] tile    : tile size (m)
+ * @param [in] compact : compact layout
+ * @param [in] cycles  : number of reload cycles
+ * @return number of mismatch cells (<0: error)
+ */
+static int eviction_mismatch( cmap_t *cmap, double tile, bool compact, int cycles ) {
+	tiled_cmap_t m;
+	cmap_t first, last;
+	int ret = 0;
+
+	if( gnd::lssmap_maker::init_counting_map(&m, gnd::lssmap_maker::counting_map_cell_size(cmap), tile, 2, "", compact) < 0 ) return -1;
+	if( gnd::lssmap_maker::merge_counting_map(&m, cmap) < 0 ) {
+		gnd::lssmap_maker::destroy_counting_map(&m);
+		return -1;
+	}
+
+	for( int k = 0; k < cycles && ret >= 0; k++ ) {
+		std::map<gnd::lssmap_maker::tile_key_t, gnd::lssmap_maker::cmap_tile_t>::iterator it;
+
+		for( it = m.tiles.begin(); it != m.tiles.end(); ++it ) {
+			if( !gnd::lssmap_maker::tile_pointer(&m, it->first) ) {
+				ret = -1;
+				break;
+			}
+		}
+		if( ret < 0 ) break;
+		if( k == 0 ) {
+			// every tile has been evicted once
+			if( gnd::lssmap_maker::to_counting_map(&first, &m) < 0 ) ret = -1;
+		}
+	}
+
+	if( ret >= 0 ) {
+		if( gnd::lssmap_maker::to_counting_map(&last, &m) >= 0 ) {
+			// mean and M2 of compact cells are rounded to float once, not on every cycle
+			ret = compact ? roundtrip_mismatch(&first, &last, 0) + roundtrip_mismatch(cmap, &first, 1.0e-5)
+					: roundtrip_mismatch(cmap, &last, 0);
+			gnd::lssmap::destroy_counting_map(&last);
+		}
+		else ret = -1;
+		gnd::lssmap::destroy_counting_map(&first);
+	}
+	gnd::lssmap_maker::destroy_counting_map(&m);
+	return ret;
+}
+
+/**
+ * @brief number of pixels of the banded image export that differ from the whole image of build_bmp()
+ * @details the whole image is sampled at the pixel centers of the banded image, 8 bits pixels may differ by
+ *          one level and 32 bits pixels by 1e-6 of the full scale (rounding)
+ * @param [in] lssmap    : statistics map
+ * @param [in] conf      : node configuration
+ * @param [in] bmp       : whole image (8 bits) of lssmap
+ * @param [in] bmp32     : whole image (32 bits) of lssmap
+ * @param [in] band_rows : pixel rows of a band
+ * @return number of mismatch pixels (<0: error)
+ */
+static int banded_mismatch( lssmap_t *lssmap, const node_config_t *conf, gnd::bmp8_t *bmp, gnd::bmp32_t *bmp32, uint32_t band_rows ) {
+	const double ps = conf->image_map_pixel_size.value;
+	const double tolerance32 = 1.0e-6 * 0xffffffffU;
+	double x0 = 0, y0 = 0, max;
+	uint32_t width, height;
+	int cnt = 0;
+
+	if( gnd::lssmap_maker::image_extent(lssmap, ps, &x0, &y0, &width, &height) == 0 ) return 0;
+	if( gnd::lssmap_maker::image_likelihood_max(lssmap, ps, x0, y0, width, height, conf->map_build_threads.value, &max) < 0 ) return -1;
+
+	for( uint32_t row = 0; row < height; row += band_rows ) {
+		gnd::lssmap_maker::image_band_t band;
+
+		band.row = row;
+		band.nrows = std::min(band_rows, height - row);
+		gnd::lssmap_maker::rasterize_image_band(lssmap, ps, x0, y0, width, max, &band);
+		if( band.ret < 0 ) return -1;
+
+		for( uint32_t r = 0; r < band.nrows; r++ ) {
+			const double y = y0 + (row + r + 0.5) * ps;
+			for( uint32_t c = 0; c < width; c++ ) {
+				const double x = x0 + (c + 0.5) * ps;
+				const uint8_t *p = bmp->ppointer(x, y);
+				const uint32_t *p32 = bmp32->ppointer(x, y);
+				const int v = p ? *p : 0;
+				const double v32 = p32 ? *p32 : 0;
+
+				if( ::abs(v - (int)band.pixel8[(size_t)r * width + c]) > 1
+				|| ::fabs(v32 - band.pixel32[(size_t)r * width + c]) > tolerance32 ) cnt++;
+			}
+		}
+	}
+	return cnt;
+}
+
+/**
+ * @brief remove the files in the work directory and the directory
+ */
+static int remove_work_directory( const char *dir ) {
+	DIR *d;
+	struct dirent *e;
+	char fname[512];
+	int ret = 0;
+
+	if( !(d = ::opendir(dir)) ) return -1;
+	while( (e = ::readdir(d)) != 0 ) {
+		if( ::strcmp(e->d_name, ".") == 0 || ::strcmp(e->d_name, "..") == 0 ) continue;
+		::snprintf(fname, sizeof(fname), "%s/%s", dir, e->d_name);
+		if( ::unlink(fname) < 0 ) ret = -1;
+	}
+	::closedir(d);
+	return ::rmdir(dir) < 0 ? -1 : ret;
+}
+
+
+
+int main(int argc, char **argv) {
+	node_config_t			node_config;
+	bench_option			opt;
+	std::vector<pose_t>		poses;					// synthetic trajectory
+	gnd::lssmap_maker::map_integrator	integrator;	// integration path of the node
+	tiled_cmap_t			&lssmap_counting = *integrator.counting_map();	// counting map (released by the integrator)
+	gnd::lssmap_maker::live_map_t	live;			// live map, built at half of the scans and rebuilt incrementally
+	histogram_t				latency;				// latency of integration path per scan
+	double					time_integration = 0;	// total time of integration
+	int						cnt_collect = 0;
+	uint64_t				npoints_counted = 0;
+	int						nmismatch = 0;			// cells of parallel build that differ from serial build
+	int						nerror = 0;				// failed map operations
+	int						nroundtrip = 0;			// cells of binary files read back that differ from the written map
+	int						ntiled = 0;				// cells of binary files written tile by tile that differ from the gathered map
+	int						nlive = 0;				// cells of incrementally rebuilt live map that differ from full build
+	int						nuntiled = 0;			// cells of live map that differ from the build of the map counted untiled
+	int						npyramid = 0;			// cells of reduced counting map that differ from counting at twice the cell size
+	int						nevict = 0;				// cells that drift over evict and reload cycles of packed tiles
+	int						nbanded = 0;			// pixels of banded image export that differ from the whole image
+	std::vector<int>		collected;				// indexes of collected scans
+	std::vector<pose_t>		poses_collected;		// poses associated with the collected scans
+
+	bench_timing			tm_gather, tm_build_map, tm_build_map_parallel, tm_build_bmp8, tm_build_bmp32;
+	bench_timing			tm_write_text, tm_read_text, tm_write_binary, tm_read_binary;
+	bench_timing			tm_write_compact, tm_read_compact;
+	bench_timing			tm_write_tiled, tm_write_tiled_compact;
+	bench_timing			tm_live_update;
+	uint64_t				bytes_binary = 0, bytes_compact = 0;	// file size of binary and compact counting map
+	int						halo_cells = -1;		// build halo (counting cells)
+	double					halo_raster = 0;		// build halo of image (m)
+
+	{ // ---> start up, read options
+		int c;
+
+		opt.fname_config = 0;
+		opt.fname_output = 0;
+		opt.dir_work = "/tmp";
+		opt.nscans = 2000;
+		opt.npoints = 1081;
+		opt.rate = 40;
+		opt.speed = 1.0;
+		opt.extent = 50;
+		opt.noise = 0.01;
+		opt.repeat = 3;
+		opt.build_threads = (int) boost::thread::hardware_concurrency();
+		opt.tile_size = -1;
+		opt.seed = 1;
+		opt.flg_keep = false;
+
+		while( (c = ::getopt(argc, argv, "c:o:d:n:p:r:v:e:z:i:j:t:s:kh")) != -1 ) {
+			switch( c ) {
+			case 'c': opt.fname_config = optarg;					break;
+			case 'o': opt.fname_output = optarg;					break;
+			case 'd': opt.dir_work = optarg;						break;
+			case 'n': opt.nscans = ::atoi(optarg);					break;
+			case 'p': opt.npoints = ::atoi(optarg);					break;
+			case 'r': opt.rate = ::atof(optarg);					break;
+			case 'v': opt.speed = ::atof(optarg);					break;
+			case 'e': opt.extent = ::atof(optarg);					break;
+			case 'z': opt.noise = ::atof(optarg);					break;
+			case 'i': opt.repeat = ::atoi(optarg);					break;
+			case 'j': opt.build_threads = ::atoi(optarg);			break;
+			case 't': opt.tile_size = ::atof(optarg);				break;
+			case 's': opt.seed = (unsigned int) ::atoi(optarg);		break;
+			case 'k': opt.flg_keep = true;							break;
+			default:
+				show_usage(argv[0]);
+				return -1;
+			}
+		}
+		if( opt.nscans <= 0 || opt.npoints <= 0 || opt.rate <= 0 || opt.extent <= 0 || opt.repeat <= 0 ) {
+			show_usage(argv[0]);
+			return -1;
+		}
+
+		if( opt.fname_config ) {
+			if( gnd::lssmap_maker::fread_node_config( opt.fname_config, &node_config ) < 0 ) {
+				fprintf(stderr, "   ... Error: fail to read config file \"%s\"\n", opt.fname_config);
+				return -1;
+			}
+			fprintf(stderr, "   ... read config file \"%s\"\n", opt.fname_config);
+		}
+		if( opt.tile_size >= 0 ) node_config.counting_map_tile_size.value = opt.tile_size;
+	} // <--- start up, read options
+
+
+
+	{ // ---> initialize
+		fprintf(stderr, "---------- initialize ----------\n");
+
+		// synthetic trajectory: poses at twice the scan rate, shifted half a period to interpolate
+		poses.resize(opt.nscans * 2 + 2);
+		for( size_t i = 0; i < poses.size(); i++ ) {
+			synthetic_pose(&opt, (i - 0.5) / (opt.rate * 2), &poses[i]);
+			poses[i].seq = (uint32_t) i;
+		}
+
+		// no initial map, point log or checkpoint, the synthetic scans are on robot coordinate
+		node_config.initial_counting_map.value[0] = '\0';
+		node_config.checkpoint_resume.value = false;
+		node_config.checkpoint_cycle.value = 0;
+		node_config.text_log.value[0] = '\0';
+		node_config.sensor_pose.value[0] = 0;
+		node_config.sensor_pose.value[1] = 0;
+		node_config.sensor_pose.value[2] = 0;
+		{ // ---> initialize integrator
+			// the integrator reports on standard output, the json is written there
+			int fd = ::dup(STDOUT_FILENO);
+			int ret;
+
+			::fflush(stdout);
+			if( fd >= 0 ) ::dup2(STDERR_FILENO, STDOUT_FILENO);
+			ret = integrator.initialize(&node_config, 0, true);
+			::fflush(stdout);
+			if( fd >= 0 ) {
+				::dup2(fd, STDOUT_FILENO);
+				::close(fd);
+			}
+			if( ret < 0 ) {
+				fprintf(stderr, "    ... error: fail to initialize integrator\n");
+				return -1;
+			}
+		} // <--- initialize integrator
+		memset(&latency, 0, sizeof(latency));
+		// the halo of tile build for the configuration, the parallel and incremental builds rely on it
+		if( gnd::lssmap_maker::build_halo(gnd::lssmap_maker::counting_map_cell_size(&lssmap_counting), &node_config, &halo_cells, &halo_raster) < 0 ) {
+			fprintf(stderr, "    ... error: fail to measure build halo\n");
+			nerror++;
+		}
+		gnd::lssmap_maker::init_live_map(&live);
+		timing_init(&tm_live_update);
+		fprintf(stderr, "    ... %d scans x %d points, %.01lf [Hz], %.02lf [m/sec], %.01lf [m] room\n",
+				opt.nscans, opt.npoints, opt.rate, opt.speed, opt.extent);
+	} // <--- initialize
+
+
+
+	{ // ---> integration path
+		unsigned int rand_state = opt.seed;
+		gnd::lssmap_maker::stats_snapshot_t ws;
+
+		fprintf(stderr, "   => integration\n");
+
+		for( int i = 0; i < opt.nscans; i++ ) {
+			double stamp = (double) i / opt.rate;
+			// the scan is held as the node holds a received message, the integration threads keep it alive
+			boost::shared_ptr< std::vector<point_t> > scan(new std::vector<point_t>);
+			pose_t truth, pose;
+			double t0;
+
+			// the scan is generated outside of the timing
+			synthetic_pose(&opt, stamp, &truth);
+			synthetic_scan(&opt, &truth, &rand_state, scan.get());
+
+			if( i == opt.nscans / 2 ) {
+				// first live map build (full) outside of the timing, the rest of the scans are rebuilt incrementally
+				if( integrator.flush() < 0 ) {
+					fprintf(stderr, "    ... error: fail to merge counting map shards\n");
+					nerror++;
+				}
+				if( gnd::lssmap_maker::update_live_map(&live, &lssmap_counting, &node_config) < 0 ) {
+					fprintf(stderr, "    ... error: fail to build live map\n");
+					nerror++;
+				}
+			}
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			// ---> same path as the node: associate, check collect condition, transform and count
+			if( gnd::lssmap_maker::interpolate_pose(poses, poses.size(), stamp,
+					node_config.pose_interpolation_max_gap.value, node_config.pose_extrapolation_limit.value, &pose) == 0
+			&& integrator.is_collect(&pose) ) {
+				if( integrator.integrate(&pose, scan, &(*scan)[0], scan->size()) < 0 ) {
+					fprintf(stderr, "    ... error: fail to integrate scan\n");
+					nerror++;
+				}
+				cnt_collect++;
+				collected.push_back(i);
+				poses_collected.push_back(pose);
+			}
+			// <--- same path as the node: associate, check collect condition, transform and count
+			t0 = gnd::lssmap_maker::clock_sec() - t0;
+			gnd::lssmap_maker::histogram_record(&latency, t0);
+			time_integration += t0;
+		}
+
+		{ // ---> integrate queued scans and merge counting map shards
+			double t0 = gnd::lssmap_maker::clock_sec();
+			if( integrator.stop() < 0 ) {
+				fprintf(stderr, "    ... error: fail to stop integrator\n");
+				nerror++;
+			}
+			time_integration += gnd::lssmap_maker::clock_sec() - t0;
+		} // <--- integrate queued scans and merge counting map shards
+		integrator.stats()->snapshot(&ws);
+		npoints_counted = ws.points_counted;
+		fprintf(stderr, "    ... %d collected, %.03lf [sec]\n", cnt_collect, time_integration);
+	} // <--- integration path
+
+
+
+	{ // ---> incremental live map build
+		double t0;
+		int ret;
+
+		fprintf(stderr, "   => incremental live map build\n");
+		t0 = gnd::lssmap_maker::clock_sec();
+		if( (ret = gnd::lssmap_maker::update_live_map(&live, &lssmap_counting, &node_config)) >= 0 ) {
+			timing_add(&tm_live_update, gnd::lssmap_maker::clock_sec() - t0);
+		}
+		else timing_error(&tm_live_update, ret);
+
+		// compare with the build of the gathered counting map
+		if( ret >= 0 && live.flg_built ) {
+			cmap_t cmap;
+			lssmap_t lssmap;
+
+			if( gnd::lssmap_maker::to_counting_map(&cmap, &lssmap_counting) >= 0 ) {
+				gnd::lssmap::build_map(&lssmap, &cmap, node_config.sensor_range.value, node_config.additional_smoothing_parameter.value );
+				nlive = gnd::lssmap_maker::compare_map(&lssmap, &live.lssmap);
+				gnd::lssmap::destroy_map(&lssmap);
+				gnd::lssmap::destroy_counting_map(&cmap);
+			}
+			else timing_error(&tm_live_update, -1);
+		}
+		fprintf(stderr, "    ... %d tiles rebuilt, %d cells differ from full build\n", (int)live.ntiles, nlive);
+
+		// compare with the build of the collected scans counted untiled,
+		// identical only for a single tile counting map (the cells on a tile border hold partial sums)
+		if( ret >= 0 && live.flg_built ) {
+			tiled_cmap_t untiled;
+			std::vector<point_t> points;
+			unsigned int rand_state = opt.seed;
+			size_t k = 0;
+			lssmap_t lssmap;
+
+			if( gnd::lssmap_maker::init_counting_map(&untiled, node_config.counting_map_cell_size.value, 0, 0, "", false) >= 0 ) {
+				// the same scans are generated again from the seed
+				for( int i = 0; i < opt.nscans && k < collected.size(); i++ ) {
+					pose_t truth;
+
+					synthetic_pose(&opt, (double) i / opt.rate, &truth);
+					synthetic_scan(&opt, &truth, &rand_state, &points);
+					if( collected[k] != i ) continue;
+					gnd::lssmap_maker::counting_points(&untiled, &node_config, &poses_collected[k], &points[0], points.size());
+					k++;
+				}
+				if( gnd::lssmap_maker::build_map_serial(&lssmap, &untiled, &node_config) >= 0 ) {
+					nuntiled = gnd::lssmap_maker::compare_map(&lssmap, &live.lssmap);
+					gnd::lssmap::destroy_map(&lssmap);
+				}
+				else nerror++;
+				gnd::lssmap_maker::destroy_counting_map(&untiled);
+			}
+			else nerror++;
+		}
+		fprintf(stderr, "    ... %d cells differ from the map counted untiled%s\n", nuntiled,
+				node_config.counting_map_tile_size.value > 0 ? " (tile border cells, not checked)" : "");
+		gnd::lssmap_maker::destroy_live_map(&live);
+	} // <--- incremental live map build
+
+
+
+	{ // ---> pyramid reduction
+		tiled_cmap_t reduced;
+		tiled_cmap_t direct;					// the collected scans counted at twice the cell size
+		std::vector<point_t> points;
+		unsigned int rand_state = opt.seed;
+		size_t k = 0;
+		cmap_t cmap_reduced, cmap_direct;
+
+		fprintf(stderr, "   => pyramid reduction\n");
+		if( gnd::lssmap_maker::init_counting_map(&direct, 2 * node_config.counting_map_cell_size.value,
+				node_config.counting_map_tile_size.value, 0, "", false) < 0 ) {
+			fprintf(stderr, "    ... error: fail to create map\n");
+			nerror++;
+		}
+		else {
+			// the same scans are generated again from the seed
+			for( int i = 0; i < opt.nscans && k < collected.size(); i++ ) {
+				pose_t truth;
+
+				synthetic_pose(&opt, (double) i / opt.rate, &truth);
+				synthetic_scan(&opt, &truth, &rand_state, &points);
+				if( collected[k] != i ) continue;
+				gnd::lssmap_maker::counting_points(&direct, &node_config, &poses_collected[k], &points[0], points.size());
+				k++;
+			}
+
+			if( gnd::lssmap_maker::reduce_counting_map(&reduced, &lssmap_counting) < 0 ) {
+				fprintf(stderr, "    ... error: fail to reduce counting map\n");
+				nerror++;
+			}
+			else {
+				if( gnd::lssmap_maker::to_counting_map(&cmap_reduced, &reduced) >= 0 ) {
+					if( gnd::lssmap_maker::to_counting_map(&cmap_direct, &direct) >= 0 ) {
+						npyramid = roundtrip_mismatch(&cmap_reduced, &cmap_direct, 1.0e-9);
+						gnd::lssmap::destroy_counting_map(&cmap_direct);
+					}
+					else nerror++;
+					gnd::lssmap::destroy_counting_map(&cmap_reduced);
+				}
+				else nerror++;
+				gnd::lssmap_maker::destroy_counting_map(&reduced);
+			}
+			gnd::lssmap_maker::destroy_counting_map(&direct);
+		}
+		fprintf(stderr, "    ... %d cells differ from counting at %.03lf [m]\n", npyramid, 2 * node_config.counting_map_cell_size.value);
+	} // <--- pyramid reduction
+
+
+
+	{ // ---> map operations
+		char dir_text[512];
+		char fname_binary[512];
+		char fname_compact[512];
+		char fname_tiled[512];
+
+		timing_init(&tm_gather);
+		timing_init(&tm_build_map);
+		timing_init(&tm_build_map_parallel);
+		timing_init(&tm_build_bmp8);
+		timing_init(&tm_build_bmp32);
+		timing_init(&tm_write_text);
+		timing_init(&tm_read_text);
+		timing_init(&tm_write_binary);
+		timing_init(&tm_read_binary);
+		timing_init(&tm_write_compact);
+		timing_init(&tm_read_compact);
+		timing_init(&tm_write_tiled);
+		timing_init(&tm_write_tiled_compact);
+
+		::snprintf(dir_text, sizeof(dir_text), "%s/gnd_lssmap_maker_bench.%d", opt.dir_work, (int)::getpid());
+		::snprintf(fname_binary, sizeof(fname_binary), "%s/%s", dir_text, gnd::lssmap_maker::CMapBinary_default_fname);
+		::snprintf(fname_compact, sizeof(fname_compact), "%s/compact-%s", dir_text, gnd::lssmap_maker::CMapBinary_default_fname);
+		::snprintf(fname_tiled, sizeof(fname_tiled), "%s/tiled-%s", dir_text, gnd::lssmap_maker::CMapBinary_default_fname);
+		if( ::mkdir(dir_text, 0755) < 0 ) {
+			fprintf(stderr, "    ... error: fail to create work directory \"%s\"\n", dir_text);
+			return -1;
+		}
+
+		fprintf(stderr, "   => map operations (%d runs)\n", opt.repeat);
+		for( int k = 0; k < opt.repeat; k++ ) {
+			cmap_t cmap;
+			cmap_t cmap_read;
+			lssmap_t lssmap;
+			lssmap_t lssmap_parallel;
+			gnd::bmp8_t bmp;
+			gnd::bmp32_t bmp32;
+			double t0;
+			int ret;
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			if( (ret = gnd::lssmap_maker::to_counting_map(&cmap, &lssmap_counting)) < 0 ) {
+				timing_error(&tm_gather, ret);
+				continue;
+			}
+			timing_add(&tm_gather, gnd::lssmap_maker::clock_sec() - t0);
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			gnd::lssmap::build_map(&lssmap, &cmap, node_config.sensor_range.value, node_config.additional_smoothing_parameter.value );
+			timing_add(&tm_build_map, gnd::lssmap_maker::clock_sec() - t0);
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			if( (ret = gnd::lssmap_maker::build_map_parallel(&lssmap_parallel, &lssmap_counting, &node_config, opt.build_threads)) >= 0 ) {
+				timing_add(&tm_build_map_parallel, gnd::lssmap_maker::clock_sec() - t0);
+				nmismatch += gnd::lssmap_maker::compare_map(&lssmap, &lssmap_parallel);
+				gnd::lssmap::destroy_map(&lssmap_parallel);
+			}
+			else timing_error(&tm_build_map_parallel, ret);
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			gnd::lssmap::build_bmp(&bmp, &lssmap, node_config.image_map_pixel_size.value);
+			timing_add(&tm_build_bmp8, gnd::lssmap_maker::clock_sec() - t0);
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			gnd::lssmap::build_bmp(&bmp32, &lssmap, node_config.image_map_pixel_size.value);
+			timing_add(&tm_build_bmp32, gnd::lssmap_maker::clock_sec() - t0);
+
+			// banded image export is the same as the whole image
+			if( k == 0 ) {
+				int band_rows = node_config.image_map_band_rows.value > 0 ? node_config.image_map_band_rows.value : 16;
+				if( (nbanded = banded_mismatch(&lssmap, &node_config, &bmp, &bmp32, (uint32_t) band_rows)) < 0 ) {
+					nbanded = 0;
+					nerror++;
+				}
+			}
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			if( (ret = gnd::lssmap::write_counting_map(&cmap, dir_text)) >= 0 ) {
+				timing_add(&tm_write_text, gnd::lssmap_maker::clock_sec() - t0);
+
+				t0 = gnd::lssmap_maker::clock_sec();
+				if( (ret = gnd::lssmap::read_counting_map(&cmap_read, dir_text)) >= 0 ) {
+					timing_add(&tm_read_text, gnd::lssmap_maker::clock_sec() - t0);
+					gnd::lssmap::destroy_counting_map(&cmap_read);
+				}
+				else timing_error(&tm_read_text, ret);
+			}
+			else timing_error(&tm_write_text, ret);
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			if( (ret = gnd::lssmap_maker::write_counting_map_binary(&cmap, fname_binary)) >= 0 ) {
+				timing_add(&tm_write_binary, gnd::lssmap_maker::clock_sec() - t0);
+
+				t0 = gnd::lssmap_maker::clock_sec();
+				if( (ret = gnd::lssmap_maker::read_counting_map_binary(&cmap_read, fname_binary)) >= 0 ) {
+					timing_add(&tm_read_binary, gnd::lssmap_maker::clock_sec() - t0);
+					nroundtrip += roundtrip_mismatch(&cmap, &cmap_read, 0);
+					gnd::lssmap::destroy_counting_map(&cmap_read);
+				}
+				else timing_error(&tm_read_binary, ret);
+			}
+			else timing_error(&tm_write_binary, ret);
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			if( (ret = gnd::lssmap_maker::write_counting_map_binary(&cmap, fname_compact, true)) >= 0 ) {
+				timing_add(&tm_write_compact, gnd::lssmap_maker::clock_sec() - t0);
+
+				t0 = gnd::lssmap_maker::clock_sec();
+				if( (ret = gnd::lssmap_maker::read_counting_map_binary(&cmap_read, fname_compact)) >= 0 ) {
+					timing_add(&tm_read_compact, gnd::lssmap_maker::clock_sec() - t0);
+					// mean and M2 of compact cells are rounded to float
+					nroundtrip += roundtrip_mismatch(&cmap, &cmap_read, 1.0e-5);
+					gnd::lssmap::destroy_counting_map(&cmap_read);
+				}
+				else timing_error(&tm_read_compact, ret);
+			}
+			else timing_error(&tm_write_compact, ret);
+
+			// ---> write tiles without gathering, the file is read as the gathered counting map
+			t0 = gnd::lssmap_maker::clock_sec();
+			if( (ret = gnd::lssmap_maker::write_counting_map_binary(&lssmap_counting, fname_tiled)) >= 0 ) {
+				timing_add(&tm_write_tiled, gnd::lssmap_maker::clock_sec() - t0);
+				if( (ret = gnd::lssmap_maker::read_counting_map_binary(&cmap_read, fname_tiled)) >= 0 ) {
+					ntiled += roundtrip_mismatch(&cmap, &cmap_read, 0);
+					gnd::lssmap::destroy_counting_map(&cmap_read);
+				}
+				else timing_error(&tm_write_tiled, ret);
+			}
+			else timing_error(&tm_write_tiled, ret);
+
+			t0 = gnd::lssmap_maker::clock_sec();
+			if( (ret = gnd::lssmap_maker::write_counting_map_binary(&lssmap_counting, fname_tiled, true)) >= 0 ) {
+				timing_add(&tm_write_tiled_compact, gnd::lssmap_maker::clock_sec() - t0);
+				if( (ret = gnd::lssmap_maker::read_counting_map_binary(&cmap_read, fname_tiled)) >= 0 ) {
+					ntiled += roundtrip_mismatch(&cmap, &cmap_read, 1.0e-5);
+					gnd::lssmap::destroy_counting_map(&cmap_read);
+				}
+				else timing_error(&tm_write_tiled_compact, ret);
+			}
+			else timing_error(&tm_write_tiled_compact, ret);
+			// <--- write tiles without gathering
+
+			// ---> evict and reload cycles of tiles packed in memory, exact and compact layout
+			if( k == 0 ) {
+				double tile = node_config.counting_map_tile_size.value > 0 ? node_config.counting_map_tile_size.value : 10.0;
+				int n0 = eviction_mismatch(&cmap, tile, false, 4);
+				int n1 = eviction_mismatch(&cmap, tile, true, 4);
+
+				if( n0 < 0 || n1 < 0 ) nerror++;
+				else nevict = n0 + n1;
+			} // <--- evict and reload cycles of tiles packed in memory
+
+			{ // file size
+				struct stat st;
+				if( ::stat(fname_binary, &st) == 0 )	bytes_binary = st.st_size;
+				if( ::stat(fname_compact, &st) == 0 )	bytes_compact = st.st_size;
+			}
+
+			bmp.deallocate();
+			bmp32.deallocate();
+			gnd::lssmap::destroy_map(&lssmap);
+			gnd::lssmap::destroy_counting_map(&cmap);
+		}
+
+		nerror += tm_gather.nerror + tm_build_map_parallel.nerror + tm_write_text.nerror + tm_read_text.nerror
+				+ tm_write_binary.nerror + tm_read_binary.nerror + tm_write_compact.nerror + tm_read_compact.nerror
+				+ tm_write_tiled.nerror + tm_write_tiled_compact.nerror + tm_live_update.nerror;
+		if( nerror > 0 )	fprintf(stderr, "    ... error: %d map operations failed\n", nerror);
+		if( nmismatch > 0 )	fprintf(stderr, "    ... error: %d cells of parallel build differ from serial build\n", nmismatch);
+		if( nroundtrip > 0 )	fprintf(stderr, "    ... error: %d cells of binary files read back differ from the written map\n", nroundtrip);
+		if( ntiled > 0 )		fprintf(stderr, "    ... error: %d cells of binary files written tile by tile differ from the gathered map\n", ntiled);
+		if( nlive > 0 )			fprintf(stderr, "    ... error: %d cells of incremental live map build differ from full build\n", nlive);
+		if( nuntiled > 0 && node_config.counting_map_tile_size.value <= 0 )
+			fprintf(stderr, "    ... error: %d cells of single tile build differ from the map counted untiled\n", nuntiled);
+		if( nbanded > 0 )		fprintf(stderr, "    ... error: %d pixels of banded image export differ from the whole image\n", nbanded);
+		if( nevict > 0 )		fprintf(stderr, "    ... error: %d cells drift over evict and reload cycles of packed tiles\n", nevict);
+		if( npyramid > 0 )		fprintf(stderr, "    ... error: %d cells of reduced counting map differ from counting at twice the cell size\n", npyramid);
+
+		if( opt.flg_keep ) {
+			fprintf(stderr, "    ... files are left in \"%s\"\n", dir_text);
+		}
+		else if( remove_work_directory(dir_text) < 0 ) {
+			fprintf(stderr, "    ... warning: fail to remove work directory \"%s\"\n", dir_text);
+		}
+	} // <--- map operations
+
+
+
+	{ // ---> json file out
+		FILE *fp = stdout;
+
+		if( opt.fname_output && !(fp = ::fopen(opt.fname_output, "w")) ) {
+			fprintf(stderr, "    ... error: fail to open \"%s\"\n", opt.fname_output);
+			return -1;
+		}
+
+		fprintf(fp, "{\n");
+		fprintf(fp, "  \"condition\": {\n");
+		fprintf(fp, "    \"scans\": %d,\n", opt.nscans);
+		fprintf(fp, "    \"points_per_scan\": %d,\n", opt.npoints);
+		fprintf(fp, "    \"rate\": %.3lf,\n", opt.rate);
+		fprintf(fp, "    \"speed\": %.3lf,\n", opt.speed);
+		fprintf(fp, "    \"extent\": %.3lf,\n", opt.extent);
+		fprintf(fp, "    \"cell_size\": %.3lf,\n", node_config.counting_map_cell_size.value);
+		fprintf(fp, "    \"tile_size\": %.3lf,\n", node_config.counting_map_tile_size.value);
+		fprintf(fp, "    \"build_halo_cells\": %d,\n", halo_cells);
+		fprintf(fp, "    \"build_halo_raster\": %.3lf,\n", halo_raster);
+		fprintf(fp, "    \"integration_threads\": %d,\n", node_config.integration_threads.value);
+		fprintf(fp, "    \"repeat\": %d,\n", opt.repeat);
+		fprintf(fp, "    \"build_threads\": %d,\n", opt.build_threads);
+		fprintf(fp, "    \"seed\": %u\n", opt.seed);
+		fprintf(fp, "  },\n");
+		fprintf(fp, "  \"integration\": {\n");
+		fprintf(fp, "    \"scans_collected\": %d,\n", cnt_collect);
+		fprintf(fp, "    \"points_counted\": %llu,\n", (unsigned long long)npoints_counted);
+		fprintf(fp, "    \"total\": %.9lf,\n", time_integration);
+		fprintf(fp, "    \"scans_per_sec\": %.3lf,\n", time_integration > 0 ? opt.nscans / time_integration : 0);
+		fprintf(fp, "    \"input_points_per_sec\": %.3lf,\n", time_integration > 0 ? (double)opt.nscans * opt.npoints / time_integration : 0);
+		fprintf(fp, "    \"latency\": ");
+		gnd::lssmap_maker::fprint_histogram_json(fp, &latency);
+		fprintf(fp, "\n");
+		fprintf(fp, "  },\n");
+		fprintf(fp, "  \"map\": {\n");
+		fprint_timing_json(fp, "gather_tiles", &tm_gather, false);
+		fprint_timing_json(fp, "build_map", &tm_build_map, false);
+		fprint_timing_json(fp, "build_map_parallel", &tm_build_map_parallel, false);
+		fprintf(fp, "    \"build_map_parallel_mismatch_cells\": %d,\n", nmismatch);
+		fprint_timing_json(fp, "build_bmp8", &tm_build_bmp8, false);
+		fprint_timing_json(fp, "build_bmp32", &tm_build_bmp32, false);
+		fprintf(fp, "    \"banded_image_mismatch_pixels\": %d,\n", nbanded);
+		fprint_timing_json(fp, "write_counting_map", &tm_write_text, false);
+		fprint_timing_json(fp, "read_counting_map", &tm_read_text, false);
+		fprint_timing_json(fp, "write_counting_map_binary", &tm_write_binary, false);
+		fprint_timing_json(fp, "read_counting_map_binary", &tm_read_binary, false);
+		fprint_timing_json(fp, "write_counting_map_compact", &tm_write_compact, false);
+		fprint_timing_json(fp, "read_counting_map_compact", &tm_read_compact, false);
+		fprintf(fp, "    \"bytes_binary\": %llu,\n", (unsigned long long)bytes_binary);
+		fprintf(fp, "    \"bytes_compact\": %llu,\n", (unsigned long long)bytes_compact);
+		fprintf(fp, "    \"binary_roundtrip_mismatch_cells\": %d,\n", nroundtrip);
+		fprint_timing_json(fp, "write_counting_map_tiled", &tm_write_tiled, false);
+		fprint_timing_json(fp, "write_counting_map_tiled_compact", &tm_write_tiled_compact, false);
+		fprintf(fp, "    \"tiled_mismatch_cells\": %d,\n", ntiled);
+		fprintf(fp, "    \"eviction_mismatch_cells\": %d,\n", nevict);
+		fprint_timing_json(fp, "live_map_update", &tm_live_update, false);
+		fprintf(fp, "    \"live_map_mismatch_cells\": %d,\n", nlive);
+		fprintf(fp, "    \"untiled_mismatch_cells\": %d,\n", nuntiled);
+		fprintf(fp, "    \"pyramid_mismatch_cells\": %d\n", npyramid);
+		fprintf(fp, "  },\n");
+		fprintf(fp, "  \"errors\": %d\n", nerror);
+		fprintf(fp, "}\n");
+
+		if( fp != stdout ) ::fclose(fp);
+	} // <--- json file out
+
+	fprintf(stderr, " ... fin\n");
+	return nerror > 0 || nmismatch > 0 || nroundtrip > 0 || ntiled > 0 || nlive > 0
+			|| (nuntiled > 0 && node_config.counting_map_tile_size.value <= 0) || npyramid > 0 || nevict > 0 || nbanded > 0 ? 1 : 0;
+}
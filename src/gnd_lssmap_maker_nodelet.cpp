@@ -0,0 +1,80 @@
+/**
+ * @file gnd_lssmap_maker/src/gnd_lssmap_maker_nodelet.cpp
+ *
+ * @brief Laser Scan Statistics MAP maker (nodelet)
+ **/
+
+#include "gnd/gnd_lssmap_maker_config.hpp"
+#include "gnd/gnd_lssmap_maker_node.hpp"
+
+#include "nodelet/nodelet.h"
+#include "pluginlib/class_list_macros.h"
+
+#include <string>
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+namespace gnd {
+	namespace lssmap_maker {
+		/**
+		 * @brief laser scan statistics map maker nodelet
+		 * @details the point-cloud published by a nodelet in the same manager is delivered as a shared pointer,
+		 *          without serialization, and it is counted in place (see map_maker_node).
+		 *          the configuration file is given by private parameter "config".
+		 *          the main loop runs on its own thread, the callbacks on the manager threads.
+		 *          the map is written into the working directory of the manager when the nodelet is unloaded.
+		 */
+		class map_maker_nodelet : public nodelet::Nodelet {
+		public:
+			map_maker_nodelet();
+			virtual ~map_maker_nodelet();
+
+		private:
+			virtual void onInit();
+
+		private:
+			node_config _conf;				///< configuration
+			map_maker_node _node;			///< subscribers, association and scan integrator
+			boost::thread _thread;			///< main loop thread
+			bool _flg_running;				///< main loop is running
+		};
+
+		map_maker_nodelet::map_maker_nodelet()
+		: _flg_running(false) {
+		}
+
+		map_maker_nodelet::~map_maker_nodelet() {
+			if( _flg_running ) {
+				_node.quit();
+				_thread.join();
+			}
+			_node.finalize();
+		}
+
+		void map_maker_nodelet::onInit() {
+			std::string fname;
+
+			// ---> read configuration file
+			if( getPrivateNodeHandle().getParam("config", fname) && !fname.empty() ) {
+				if( fread_node_config( fname.c_str(), &_conf ) < 0 ) {
+					NODELET_ERROR("fail to read config file \"%s\"", fname.c_str());
+					return;
+				}
+				::fprintf(stdout, "   ... read config file \"%s\"\n", fname.c_str());
+			} // <--- read configuration file
+
+			// ---> initialize node
+			if( _node.initialize(&getMTNodeHandle(), &_conf) < 0 ) {
+				NODELET_ERROR("fail to initialize");
+				return;
+			} // <--- initialize node
+
+			_thread = boost::thread( boost::bind(&map_maker_node::run, &_node) );
+			_flg_running = true;
+		}
+
+	}
+}
+
+PLUGINLIB_EXPORT_CLASS(gnd::lssmap_maker::map_maker_nodelet, nodelet::Nodelet)
@@ -0,0 +1,483 @@
+/**
+ * @file gnd_lssmap_maker/src/lib/gnd_lssmap_maker.cpp
+ *
+ * @brief Laser Scan Statistics MAP maker library (scan integrator)
+ **/
+
+#include "gnd/gnd_lssmap_maker_integrator.hpp"
+
+#include <stdio.h>
+#include <math.h>
+#include <unistd.h>
+
+namespace gnd {
+	namespace lssmap_maker {
+
+		map_integrator::map_integrator()
+		: _time_start(0), _time_merge(0), _time_live(0), _time_checkpoint(0), _flg_init(false), _flg_stop(false) {
+			init_live_map(&_live);
+		}
+
+		map_integrator::~map_integrator() {
+			if( _flg_init ) {
+				stop();
+				destroy_live_map(&_live);
+				destroy_counting_map(&_cmap);
+				_log.close();
+			}
+		}
+
+		/**
+		 * @brief initialize counting map, point log, integration threads and checkpoint writer
+		 * @param [in] conf : configuration (copied)
+		 * @param [in] time    : current time of caller's clock (sec), the cycles of update() start from it
+		 * @param [in] offline : off-line (e.g. batch on dataset), the point log waits for the disk rather than drop points
+		 */
+		int map_integrator::initialize( const node_config *conf, double time, bool offline ) {
+			gnd_assert(!conf, -1, "invalid null pointer argument\n" );
+			gnd_assert(_flg_init, -1, "already initialized\n" );
+
+			_conf = *conf;
+
+			{ // ---> initialize counting map
+				const char *fname_initial = _conf.initial_counting_map.value;
+				::fprintf(stdout, "\n");
+				::fprintf(stdout, "   => initialize counting map\n" );
+
+				// resume from checkpoint
+				if( _conf.checkpoint_resume.value && _conf.checkpoint_file.value[0]
+				&& ::access(_conf.checkpoint_file.value, R_OK) == 0 ) {
+					::fprintf(stdout, "    ... resume from checkpoint \"%s\"\n", _conf.checkpoint_file.value );
+					fname_initial = _conf.checkpoint_file.value;
+				}
+
+				// initialize counting map
+				if( init_counting_map(&_cmap, _conf.counting_map_cell_size.value,
+						_conf.counting_map_tile_size.value,
+						_conf.counting_map_tile_cache.value > 0 ? _conf.counting_map_tile_cache.value : 0,
+						_conf.counting_map_tile_swap_directory.value,
+						_conf.counting_map_compact.value) < 0 ) {
+					::fprintf(stderr, "    ... error: fail to create map\n");
+					return -1;
+				}
+				_flg_init = true;
+
+				if( fname_initial[0] != '\0' ) {
+					// load counting map
+					if( read_counting_map_any(&_cmap, fname_initial) < 0 ){
+						::fprintf(stderr, "    ... error: fail to load counting map in \"%s\"\n", fname_initial);
+						return -1;
+					}
+					::fprintf(stderr, "    ... ok: load counting map in \"%s\"\n", fname_initial);
+				}
+				else {
+					::fprintf(stderr, "    ... ok\n");
+				}
+			} // <--- initialize counting map
+
+			// ---> text log file create
+			if( _conf.text_log.value[0] ) {
+				::fprintf(stdout, "\n");
+				::fprintf(stdout, "   => create log file \"%s\"\n", _conf.text_log.value);
+
+				if( _log.open(_conf.text_log.value, _conf.text_log_binary.value, offline) < 0 ) {
+					::fprintf(stderr, "   ... error: fail to open \"%s\"\n", _conf.text_log.value);
+					return -1;
+				}
+				::fprintf(stderr, "    ... ok\n");
+			} // <--- text log file create
+
+			// ---> start integration threads
+			if( _conf.integration_threads.value > 1 ) {
+				::fprintf(stdout, "\n");
+				::fprintf(stdout, "   => start %d integration threads\n", _conf.integration_threads.value);
+
+				if( _pool.start(_conf.integration_threads.value, &_conf,
+						counting_map_cell_size(&_cmap), _log.is_open() ? &_log : 0, &_stats) < 0 ) {
+					::fprintf(stderr, "   ... error: fail to start threads\n");
+					return -1;
+				}
+				::fprintf(stderr, "    ... ok\n");
+			} // <--- start integration threads
+
+			// ---> start checkpoint writer
+			if( _conf.checkpoint_cycle.value > 0 ) {
+				::fprintf(stdout, "\n");
+				::fprintf(stdout, "   => start checkpoint writer \"%s\"\n", _conf.checkpoint_file.value);
+
+				if( _checkpoint.start(_conf.checkpoint_file.value, _conf.counting_map_compact.value) < 0 ) {
+					::fprintf(stderr, "   ... error: fail to start checkpoint writer\n");
+					return -1;
+				}
+				::fprintf(stderr, "    ... ok\n");
+			} // <--- start checkpoint writer
+
+			{ // ---> initialize time
+				_time_start = time;
+				_time_merge = time + _conf.shard_merge_cycle.value;
+				_time_live = time + _conf.live_map_cycle.value;
+				_time_checkpoint = time + _conf.checkpoint_cycle.value;
+			} // <--- initialize time
+
+			{ // ---> point-cloud sources
+				for( int i = 0; i < PointCloud_sources_max; i++ ) {
+					pointcloud_source_config src;
+
+					get_pointcloud_source(&_conf, i, &src);
+					_source[i].conf = _conf;
+					_source[i].conf.collect_condition_ignore_range_lower.value = src.ignore_range_lower.value;
+					_source[i].conf.collect_condition_ignore_range_upper.value = src.ignore_range_upper.value;
+					_source[i].conf.collect_condition_culling_distance.value = src.culling_distance.value;
+					_source[i].mount.x = src.sensor_pose.value[0];
+					_source[i].mount.y = src.sensor_pose.value[1];
+					_source[i].mount.theta = src.sensor_pose.value[2];
+					init_prevcollect_pose(&_source[i].prevcollect, &_conf, time);
+				}
+			} // <--- point-cloud sources
+			return 0;
+		}
+
+		/**
+		 * @brief run cyclic tasks, shard merge, live map rebuild and checkpoint
+		 * @param [in] time : current time of caller's clock (sec)
+		 * @return 1: some task ran
+		 */
+		int map_integrator::update( double time ) {
+			gnd_assert(!_flg_init, -1, "not initialized\n" );
+			int ret = 0;
+
+			// ---> merge counting map shards
+			if( _pool.nthreads() > 0 && _conf.shard_merge_cycle.value > 0 && time > _time_merge ) {
+				_time_merge = gnd_loop_next(time, _time_start, _conf.shard_merge_cycle.value);
+				if( _pool.merge(&_cmap) < 0 ) {
+					::fprintf(stderr, "    ... error: fail to merge counting map shards\n");
+					return -1;
+				}
+				ret = 1;
+			} // <--- merge counting map shards
+
+			// ---> rebuild live map
+			if( _conf.live_map_cycle.value > 0 && time > _time_live ) {
+				_time_live = gnd_loop_next(time, _time_start, _conf.live_map_cycle.value);
+				if( flush() < 0 ) {
+					::fprintf(stderr, "    ... error: fail to merge counting map shards\n");
+					return -1;
+				}
+				if( update_live_map(&_live, &_cmap, &_conf) > 0 ) {
+					fwrite_live_map(&_live, &_conf, _conf.live_map_directory.value);
+				}
+				ret = 1;
+			} // <--- rebuild live map
+
+			// ---> checkpoint
+			if( _checkpoint.is_running() && time > _time_checkpoint ) {
+				_time_checkpoint = gnd_loop_next(time, _time_start, _conf.checkpoint_cycle.value);
+				// hand over the counted tiles (copy on write), the file out runs on the writer thread.
+				// the shards are not merged here, their counts are in the checkpoint after the next shard merge
+				_checkpoint.snapshot(&_cmap);
+				ret = 1;
+			} // <--- checkpoint
+
+			return ret;
+		}
+
+		/**
+		 * @brief integrate queued scans, stop integration threads and write the last checkpoint
+		 * @note integrate() is not available after stop
+		 */
+		int map_integrator::stop() {
+			gnd_assert(!_flg_init, -1, "not initialized\n" );
+			if( _flg_stop ) return 0;
+			int ret = 0;
+
+			// integrate queued scans and merge counting map shards
+			if( _pool.nthreads() > 0 ) {
+				if( _pool.merge(&_cmap) < 0 ) {
+					::fprintf(stderr, "    ... error: fail to merge counting map shards\n");
+					ret = -1;
+				}
+				_pool.stop();
+			}
+
+			// write the last checkpoint
+			if( _checkpoint.is_running() ) {
+				_checkpoint.snapshot(&_cmap);
+				_checkpoint.stop();
+			}
+			_flg_stop = true;
+			return ret;
+		}
+
+		/**
+		 * @brief stop, file out counting map, map image and its origin, and release the counting map
+		 * @param [in] dir : output directory
+		 */
+		int map_integrator::finalize( const char *dir ) {
+			gnd_assert(!dir, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_flg_init, -1, "not initialized\n" );
+			int ret = stop();
+
+			// counting map, map image and origin file out
+			if( _live.flg_built ) {
+				// only the tiles counted after the last live map build are rebuilt
+				if( update_live_map(&_live, &_cmap, &_conf) < 0 )	ret = -1;
+				if( fwrite_counting_map(&_cmap, &_conf, dir) < 0 )	ret = -1;
+				if( fwrite_map_image(&_live.lssmap, &_conf, dir) < 0 )	ret = -1;
+				fwrite_live_map(&_live, &_conf, _conf.live_map_directory.value);
+			}
+			else {
+				if( fwrite_map(&_cmap, &_conf, dir) < 0 )			ret = -1;
+			}
+			// coarser levels of counting map
+			if( fwrite_counting_pyramid(&_cmap, &_conf, dir) < 0 )	ret = -1;
+			destroy_live_map(&_live);
+			destroy_counting_map(&_cmap);
+
+			// write buffered points
+			_log.close();
+			_flg_init = false;
+			return ret < 0 ? -1 : 0;
+		}
+
+		/**
+		 * @brief check data collect condition against the pose at the previous collection of the source
+		 * @param [in] pose   : pose associated with the point-cloud
+		 * @param [in] source : point-cloud source index
+		 */
+		bool map_integrator::is_collect( const pose2d_t *pose, int source ) const {
+			gnd_assert(!pose, false, "invalid null pointer argument\n" );
+			gnd_assert(source < 0 || source >= PointCloud_sources_max, false, "out of range\n" );
+			return is_collect_condition(&_conf, pose, &_source[source].prevcollect);
+		}
+
+		/**
+		 * @brief count a scan
+		 * @note on integration threads the points are swapped out of the argument, not copied,
+		 *       and a storage integrated before is swapped back for reuse
+		 * @param [in]     pose   : pose associated with the point-cloud
+		 * @param [in,out] points : points on sensor coordinate
+		 * @param [in]     age    : scan age (sec)
+		 * @param [in]     source : point-cloud source index
+		 * @return number of counted points (0 on integration threads)
+		 */
+		int map_integrator::integrate( const pose2d_t *pose, std::vector<point3d_t> *points, double age, int source ) {
+			gnd_assert(!pose, -1, "invalid null pointer argument\n" );
+			gnd_assert(!points, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_flg_init || _flg_stop, -1, "not operating\n" );
+
+			{ // ---> operation
+				pose2d_t sensor;
+				const node_config *conf = sensor_pose(source, pose, &sensor);
+				double time = clock_sec();
+				int cnt;
+
+				if( !conf ) return -1;
+				if( _pool.nthreads() > 0 ) {
+					if( _pool.push(&sensor, points, age, conf) < 0 ) return -1;
+					_source[source].prevcollect = *pose;
+					return 0;
+				}
+
+				cnt = counting_points(&_cmap, conf, &sensor, points->empty() ? (const point3d_t*) 0 : &(*points)[0], points->size(),
+						_log.is_open() ? &_log : 0, &_workspace);
+				return count(pose, cnt, age + (clock_sec() - time), source);
+			} // <--- operation
+		}
+
+		/**
+		 * @brief count a scan on packed points owned by a shared object, without copy
+		 * @note integration threads keep hold alive until the points are counted
+		 * @param [in] pose   : pose associated with the point-cloud
+		 * @param [in] hold   : owner of the buffer, e.g. received message (ConstPtr)
+		 * @param [in] points : view of points on sensor coordinate
+		 * @param [in] age    : scan age (sec)
+		 * @param [in] source : point-cloud source index
+		 * @return number of counted points (0 on integration threads)
+		 */
+		int map_integrator::integrate( const pose2d_t *pose, const boost::shared_ptr<const void> &hold, const packed_points_t *points, double age, int source ) {
+			gnd_assert(!pose, -1, "invalid null pointer argument\n" );
+			gnd_assert(!points, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_flg_init || _flg_stop, -1, "not operating\n" );
+
+			{ // ---> operation
+				pose2d_t sensor;
+				const node_config *conf = sensor_pose(source, pose, &sensor);
+				double time = clock_sec();
+				int cnt;
+
+				if( !conf ) return -1;
+				if( _pool.nthreads() > 0 ) {
+					if( _pool.push_shared(&sensor, hold, points, age, conf) < 0 ) return -1;
+					_source[source].prevcollect = *pose;
+					return 0;
+				}
+
+				cnt = counting_points(&_cmap, conf, &sensor, points, points->n, _log.is_open() ? &_log : 0, &_workspace);
+				return count(pose, cnt, age + (clock_sec() - time), source);
+			} // <--- operation
+		}
+
+		/**
+		 * @brief record a scan counted on caller thread
+		 */
+		int map_integrator::count( const pose2d_t *pose, int cnt, double age, int source ) {
+			_stats.count_integrated(_workspace.latency_transform, _workspace.latency_counting, _workspace.latency_log,
+					age, cnt > 0 ? cnt : 0);
+			_source[source].prevcollect = *pose;
+			return cnt;
+		}
+
+		/**
+		 * @brief sensor pose of a point-cloud source on global coordinate
+		 * @param [in]  source : point-cloud source index
+		 * @param [in]  pose   : robot pose
+		 * @param [out] dest   : robot pose composed with the sensor mounting pose (seq and stamp are copied)
+		 * @return configuration with the culling and range gate of the source (null: invalid source)
+		 */
+		const node_config* map_integrator::sensor_pose( int source, const pose2d_t *pose, pose2d_t *dest ) const {
+			gnd_assert(source < 0 || source >= PointCloud_sources_max, 0, "out of range\n" );
+
+			{ // ---> operation
+				const pose2d_t *m = &_source[source].mount;
+				double cosv = ::cos(pose->theta);
+				double sinv = ::sin(pose->theta);
+
+				*dest = *pose;
+				dest->x = pose->x + cosv * m->x - sinv * m->y;
+				dest->y = pose->y + sinv * m->x + cosv * m->y;
+				dest->theta = pose->theta + m->theta;
+				return &_source[source].conf;
+			} // <--- operation
+		}
+
+		/**
+		 * @brief wait for queued scans and merge shards of integration threads into the counting map
+		 */
+		int map_integrator::flush() {
+			gnd_assert(!_flg_init, -1, "not initialized\n" );
+			return _pool.nthreads() > 0 ? _pool.merge(&_cmap) : 0;
+		}
+
+		/**
+		 * @brief build statistics map from the counting map
+		 * @param [out] dest  : statistics map (release with gnd::lssmap::destroy_map())
+		 * @param [in]  level : level of pyramid, the cell size is "counting-map-cell-size" x 2^level
+		 *                      (reduced from the counting map, not counted again)
+		 */
+		int map_integrator::build( gnd::lssmap::lssmap_t *dest, int level ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_flg_init, -1, "not initialized\n" );
+			gnd_assert(level < 0, -1, "invalid argument\n" );
+
+			if( flush() < 0 ) return -1;
+			if( level == 0 ) {
+				return build_map(dest, &_cmap, &_conf);
+			}
+			else {
+				// reduced and built tile by tile
+				tiled_cmap_t ws[2];
+				tiled_cmap_t *fine = &_cmap;
+				int i, ret;
+
+				for( i = 0; i < level; i++ ) {
+					// reduce to next level
+					if( reduce_counting_map(&ws[i % 2], fine) < 0 ) break;
+					if( fine != &_cmap ) destroy_counting_map(fine);
+					fine = &ws[i % 2];
+				}
+				if( i < level ) {
+					if( fine != &_cmap ) destroy_counting_map(fine);
+					return -1;
+				}
+				ret = build_map(dest, fine, &_conf);
+				destroy_counting_map(fine);
+				return ret;
+			}
+		}
+
+		/**
+		 * @brief take the live map cells changed since the previous call
+		 * @note the cells are copied, so they can be rasterized on another thread while the live map is rebuilt
+		 * @param [out] dest : changed cells (release with destroy_live_map_delta())
+		 * @return 0: no change, 1: changed
+		 */
+		int map_integrator::live_map_delta( live_map_delta_t *dest ) {
+			gnd_assert(!dest, -1, "invalid null pointer argument\n" );
+			gnd_assert(!_flg_init, -1, "not initialized\n" );
+
+			return take_live_map_delta(&_live, &_cmap, &_conf, dest);
+		}
+
+		/**
+		 * @brief configuration
+		 */
+		const node_config* map_integrator::config() const {
+			return &_conf;
+		}
+
+		/**
+		 * @brief counting map
+		 * @note integration threads write their shards into it at flush(), update() and stop()
+		 */
+		tiled_cmap_t* map_integrator::counting_map() {
+			return &_cmap;
+		}
+
+		/**
+		 * @brief statistics
+		 */
+		node_stats* map_integrator::stats() {
+			return &_stats;
+		}
+
+		/**
+		 * @brief point log
+		 */
+		point_logger* map_integrator::log() {
+			return &_log;
+		}
+
+		/**
+		 * @brief live map
+		 */
+		const live_map_t* map_integrator::live_map() const {
+			return &_live;
+		}
+
+		/**
+		 * @brief number of written checkpoints
+		 */
+		uint32_t map_integrator::ncheckpoint() {
+			return _checkpoint.nwritten();
+		}
+
+		/**
+		 * @brief checkpoint writer is running
+		 */
+		bool map_integrator::is_checkpoint() const {
+			return _checkpoint.is_running();
+		}
+
+		/**
+		 * @brief initialized and not finalized
+		 */
+		bool map_integrator::is_initialized() const {
+			return _flg_init;
+		}
+
+		/**
+		 * @brief number of integration threads (0: integrate on caller thread)
+		 */
+		int map_integrator::nthreads() const {
+			return _pool.nthreads();
+		}
+
+		/**
+		 * @brief number of scans waiting for integration threads
+		 */
+		size_t map_integrator::backlog() {
+			return _pool.nthreads() > 0 ? _pool.backlog() : 0;
+		}
+
+	}
+}
@@ -0,0 +1,307 @@
+/**
+ * @file gnd_lssmap_maker/test/test_gnd_lssmap_maker.cpp
+ *
+ * @brief unit tests of Laser Scan Statistics MAP maker kernels
+ **/
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "gnd/gnd-matrix-base.hpp"
+#include "gnd/gnd-vector-base.hpp"
+#include "gnd/gnd-matrix-coordinate.hpp"
+
+#include "gnd/gnd_lssmap_maker_transform.hpp"
+#include "gnd/gnd_lssmap_maker_pose_buffer.hpp"
+
+typedef gnd::lssmap_maker::pose2d_t								pose_t;
+
+
+/**
+ * @brief pose message for pose_buffer (the members pose_buffer reads of gnd_msgs::msg_pose2d_stamped)
+ */
+struct test_pose_msg {
+	struct stamp_t {
+		double sec;
+		double toSec() const { return sec; }
+	};
+	struct header_t {
+		uint32_t seq;
+		stamp_t stamp;
+	};
+	typedef boost::shared_ptr<const test_pose_msg> ConstPtr;
+
+	header_t header;
+	double x, y, theta;
+};
+
+
+/**
+ * @brief uniform random number in [lower, upper) (reproducible on every platform)
+ */
+static double test_random( unsigned int *state, double lower, double upper ) {
+	*state = *state * 1103515245u + 12345u;
+	return lower + (upper - lower) * (((*state >> 8) & 0xffffff) / (double)0x1000000);
+}
+
+/**
+ * @brief make a pose
+ */
+static pose_t test_pose( uint32_t seq, double stamp, double x, double y, double theta ) {
+	pose_t p;
+	p.seq = seq;
+	p.stamp = stamp;
+	p.x = x;
+	p.y = y;
+	p.theta = theta;
+	return p;
+}
+
+/**
+ * @brief make a pose message
+ */
+static test_pose_msg::ConstPtr test_msg( const pose_t &p ) {
+	test_pose_msg *msg = new test_pose_msg;
+	msg->header.seq = p.seq;
+	msg->header.stamp.sec = p.stamp;
+	msg->x = p.x;
+	msg->y = p.y;
+	msg->theta = p.theta;
+	return test_pose_msg::ConstPtr(msg);
+}
+
+
+// ---> transform kernel
+/*
+ * the simd kernel (sse2 or avx, see ENABLE_AVX) and its scalar remainder are compared with
+ * the 4x4 homogeneous transform of gndlib the node used per point before the kernel
+ */
+TEST(transform_scan, matches_matrix_prod) {
+	// positions and orientations of robot (x, y, theta)
+	const double poses[][3] = {
+			{ 0, 0, 0 },
+			{ 1.5, -2.25, 0.7 },
+			{ -30.0, 12.5, -2.9 },
+			{ 1.0e3, -1.0e3, M_PI } };
+	// not a multiple of the simd width, the last points are transformed by the scalar remainder
+	const size_t n = 67;
+	std::vector<double> x(n), y(n), gx(n), gy(n);
+	std::vector<uint8_t> mask(n);
+	unsigned int state = 1;
+
+	for( size_t i = 0; i < n; i++ ) {
+		x[i] = test_random(&state, -40.0, 40.0);
+		y[i] = test_random(&state, -40.0, 40.0);
+	}
+
+	for( size_t k = 0; k < sizeof(poses) / sizeof(poses[0]); k++ ) {
+		gnd::matrix::fixed<4,4> mat_coordtf;
+
+		gnd::lssmap_maker::transform_scan(&x[0], &y[0], n, poses[k][0], poses[k][1], poses[k][2], -1, -1,
+				&gx[0], &gy[0], &mask[0]);
+		gnd::matrix::coordinate_converter(&mat_coordtf,
+				poses[k][0], poses[k][1], 0,
+				::cos(poses[k][2]), ::sin(poses[k][2]), 0,
+				0, 0, 1.0);
+
+		for( size_t i = 0; i < n; i++ ) {
+			gnd::vector::fixed_column<4> point_src, point_dest;
+
+			point_src[0] = x[i];
+			point_src[1] = y[i];
+			point_src[2] = 0;
+			point_src[3] = 1;
+			gnd::matrix::prod( &mat_coordtf, &point_src, &point_dest );
+
+			// the sums may be evaluated in another order, allow rounding of the magnitude
+			EXPECT_NEAR(point_dest[0], gx[i], 1.0e-12 * (1.0 + ::fabs(point_dest[0]))) << "pose " << k << ", point " << i;
+			EXPECT_NEAR(point_dest[1], gy[i], 1.0e-12 * (1.0 + ::fabs(point_dest[1]))) << "pose " << k << ", point " << i;
+			EXPECT_EQ(1, mask[i]) << "pose " << k << ", point " << i;
+		}
+	}
+}
+
+/*
+ * the range gate is the same as the ignore range of the node before the kernel,
+ * a point is ignored if it is nearer than lower or farther than upper (the bounds are kept)
+ */
+TEST(transform_scan, range_gate) {
+	const double lower = 1.0, upper = 5.0;
+	// on and around the bounds, in every lane of the simd body and in the remainder
+	const double range[] = { 0, 0.5, 1.0, 1.0 + 1.0e-9, 3.0, 5.0, 5.0 + 1.0e-9, 7.0, 1.0 - 1.0e-9, 4.0, 6.0 };
+	const size_t n = sizeof(range) / sizeof(range[0]);
+	std::vector<double> x(n), y(n), gx(n), gy(n);
+	std::vector<uint8_t> mask(n);
+
+	for( size_t i = 0; i < n; i++ ) {
+		x[i] = range[i];
+		y[i] = 0;
+	}
+
+	gnd::lssmap_maker::transform_scan(&x[0], &y[0], n, 0, 0, 0, lower, upper, &gx[0], &gy[0], &mask[0]);
+	for( size_t i = 0; i < n; i++ ) {
+		double sq = x[i] * x[i] + y[i] * y[i];
+		bool ignore = sq < lower * lower || sq > upper * upper;
+
+		EXPECT_EQ(ignore ? 0 : 1, mask[i]) << "range " << range[i];
+	}
+
+	// a negative bound is not gated
+	gnd::lssmap_maker::transform_scan(&x[0], &y[0], n, 0, 0, 0, -1, upper, &gx[0], &gy[0], &mask[0]);
+	for( size_t i = 0; i < n; i++ ) {
+		EXPECT_EQ(x[i] * x[i] > upper * upper ? 0 : 1, mask[i]) << "range " << range[i];
+	}
+	gnd::lssmap_maker::transform_scan(&x[0], &y[0], n, 0, 0, 0, lower, -1, &gx[0], &gy[0], &mask[0]);
+	for( size_t i = 0; i < n; i++ ) {
+		EXPECT_EQ(x[i] * x[i] < lower * lower ? 0 : 1, mask[i]) << "range " << range[i];
+	}
+}
+// <--- transform kernel
+
+
+
+// ---> pose interpolation
+/*
+ * a point-cloud between two poses gets the pose interpolated linearly, on the shorter way for the orientation
+ */
+TEST(interpolate_pose, bracketing) {
+	std::vector<pose_t> poses;
+	pose_t out;
+
+	poses.push_back( test_pose(10, 1.0, 0.0, 0.0, 3.0) );
+	poses.push_back( test_pose(11, 2.0, 1.0, -2.0, -3.0) );
+	poses.push_back( test_pose(12, 3.0, 3.0, -2.0, -3.0) );
+
+	// exact
+	ASSERT_EQ(0, gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 2.0, 1.5, 0, &out));
+	EXPECT_EQ(11u, out.seq);
+	EXPECT_DOUBLE_EQ(1.0, out.x);
+	EXPECT_DOUBLE_EQ(-2.0, out.y);
+
+	// between the first and the second, the orientation passes through PI
+	ASSERT_EQ(0, gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 1.25, 1.5, 0, &out));
+	EXPECT_EQ(10u, out.seq);
+	EXPECT_DOUBLE_EQ(1.25, out.stamp);
+	EXPECT_DOUBLE_EQ(0.25, out.x);
+	EXPECT_DOUBLE_EQ(-0.5, out.y);
+	EXPECT_NEAR(3.0 + 0.25 * (2 * M_PI - 6.0), out.theta, 1.0e-12);
+
+	// the nearer pose gives the sequence id
+	ASSERT_EQ(0, gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 2.75, 1.5, 0, &out));
+	EXPECT_EQ(12u, out.seq);
+	EXPECT_DOUBLE_EQ(2.5, out.x);
+
+	// before the oldest pose
+	EXPECT_LT(gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 0.5, 1.5, 0, &out), 0);
+	// too large gap between the bracketing poses
+	EXPECT_LT(gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 1.5, 0.5, 0, &out), 0);
+	// no pose
+	EXPECT_LT(gnd::lssmap_maker::interpolate_pose(poses, 0, 1.5, 1.5, 0, &out), 0);
+}
+
+/*
+ * a point-cloud after the latest pose gets the pose extrapolated with the velocity of the latest two poses,
+ * only up to the extrapolation limit
+ */
+TEST(interpolate_pose, extrapolation_limit) {
+	std::vector<pose_t> poses;
+	pose_t out;
+
+	poses.push_back( test_pose(1, 1.0, 0.0, 0.0, 0.0) );
+	poses.push_back( test_pose(2, 2.0, 1.0, 0.5, 0.1) );
+
+	ASSERT_EQ(0, gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 2.2, 1.5, 0.25, &out));
+	EXPECT_DOUBLE_EQ(2.2, out.stamp);
+	EXPECT_NEAR(1.2, out.x, 1.0e-12);
+	EXPECT_NEAR(0.6, out.y, 1.0e-12);
+	EXPECT_NEAR(0.12, out.theta, 1.0e-12);
+
+	// beyond the limit
+	EXPECT_LT(gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 2.3, 1.5, 0.25, &out), 0);
+	// no extrapolation
+	EXPECT_LT(gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 2.1, 1.5, 0, &out), 0);
+
+	// the latest two poses are too far apart to take the velocity, the latest pose is held
+	ASSERT_EQ(0, gnd::lssmap_maker::interpolate_pose(poses, poses.size(), 2.2, 0.5, 0.25, &out));
+	EXPECT_DOUBLE_EQ(2.2, out.stamp);
+	EXPECT_DOUBLE_EQ(1.0, out.x);
+	EXPECT_DOUBLE_EQ(0.5, out.y);
+	// a single pose is held
+	ASSERT_EQ(0, gnd::lssmap_maker::interpolate_pose(poses, 1, 1.1, 1.5, 0.25, &out));
+	EXPECT_EQ(1u, out.seq);
+	EXPECT_DOUBLE_EQ(0.0, out.x);
+}
+
+/*
+ * a pose not after the latest one is dropped, so the ring stays sorted by time stamp,
+ * and the oldest pose is overwritten on a full ring
+ */
+TEST(pose_buffer, out_of_order_drops) {
+	gnd::lssmap_maker::pose_buffer<test_pose_msg> buffer;
+	pose_t out;
+
+	ASSERT_EQ(0, buffer.allocate(3));
+	buffer.rosmsg_read( test_msg( test_pose(1, 1.0, 0.0, 0.0, 0.0) ) );
+	buffer.rosmsg_read( test_msg( test_pose(2, 2.0, 1.0, 0.0, 0.0) ) );
+	// older and the same time stamp
+	buffer.rosmsg_read( test_msg( test_pose(3, 1.5, 9.0, 9.0, 0.0) ) );
+	buffer.rosmsg_read( test_msg( test_pose(4, 2.0, 9.0, 9.0, 0.0) ) );
+	EXPECT_EQ(2u, buffer.size());
+	EXPECT_EQ(2u, buffer.ndropped());
+
+	ASSERT_EQ(0, buffer.at_time(1.5, 1.5, 0, &out));
+	EXPECT_DOUBLE_EQ(0.5, out.x);
+	EXPECT_DOUBLE_EQ(0.0, out.y);
+	ASSERT_EQ(0, buffer.latest(&out));
+	EXPECT_EQ(2u, out.seq);
+
+	// overwrite the oldest
+	buffer.rosmsg_read( test_msg( test_pose(5, 3.0, 2.0, 0.0, 0.0) ) );
+	buffer.rosmsg_read( test_msg( test_pose(6, 4.0, 3.0, 0.0, 0.0) ) );
+	EXPECT_EQ(3u, buffer.size());
+	EXPECT_LT(buffer.at_time(1.5, 1.5, 0, &out), 0);
+	ASSERT_EQ(0, buffer.at_time(3.5, 1.5, 0, &out));
+	EXPECT_DOUBLE_EQ(2.5, out.x);
+}
+
+/*
+ * the batch associates a point-cloud on all the poses, the node on the poses received when the pose after
+ * the point-cloud arrives (see associate_scan() of gnd_lssmap_maker_batch.cpp), both get the same pose
+ */
+TEST(pose_buffer, matches_batch_association) {
+	gnd::lssmap_maker::pose_buffer<test_pose_msg> buffer;
+	std::vector<pose_t> poses;
+	unsigned int state = 3;
+
+	for( uint32_t i = 0; i < 50; i++ ) {
+		poses.push_back( test_pose(i, i * 0.1 + test_random(&state, 0, 0.05),
+				test_random(&state, -1, 1), test_random(&state, -1, 1), test_random(&state, -M_PI, M_PI)) );
+	}
+
+	ASSERT_EQ(0, buffer.allocate(poses.size()));
+	buffer.rosmsg_read( test_msg(poses[0]) );
+	for( size_t i = 1; i < poses.size(); i++ ) {
+		double stamp = test_random(&state, poses[i - 1].stamp, poses[i].stamp);
+		pose_t online, batch;
+
+		// the pose after the point-cloud arrives
+		buffer.rosmsg_read( test_msg(poses[i]) );
+		ASSERT_EQ(0, buffer.at_time(stamp, 0.5, 0, &online));
+		ASSERT_EQ(0, gnd::lssmap_maker::interpolate_pose(poses, poses.size(), stamp, 0.5, 0, &batch));
+		EXPECT_EQ(batch.seq, online.seq);
+		EXPECT_EQ(batch.x, online.x);
+		EXPECT_EQ(batch.y, online.y);
+		EXPECT_EQ(batch.theta, online.theta);
+	}
+}
+// <--- pose interpolation
+
+
+int main( int argc, char **argv ) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}